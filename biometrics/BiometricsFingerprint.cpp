@@ -40,7 +40,9 @@ using RequestStatus =
 
 BiometricsFingerprint *BiometricsFingerprint::sInstance = nullptr;
 
-BiometricsFingerprint::BiometricsFingerprint() : mClientCallback(nullptr), mDevice(nullptr) {
+BiometricsFingerprint::BiometricsFingerprint()
+    : mClientCallback(nullptr), mDevice(nullptr),
+      mDispatcher([this](const fingerprint_msg_t& msg) { deliver(msg); }) {
     sInstance = this; // keep track of the most recent instance
     mDevice = openHal();
     if (!mDevice) {
@@ -197,15 +199,14 @@ Return<RequestStatus> BiometricsFingerprint::enumerate()  {
     enumerate_2_0 enumerate = (enumerate_2_0) mDevice->enumerate;
     int ret = enumerate(mDevice, results, &n);
 
-    if (ret == 0 && mClientCallback != nullptr) {
+    if (ret == 0) {
         ALOGD("Got %d enumerated templates", n);
         for (uint32_t i = 0; i < n; i++) {
-            const uint64_t devId = reinterpret_cast<uint64_t>(mDevice);
-            const auto& fp = results[i];
-            ALOGD("onEnumerate(fid=%d, gid=%d)", fp.fid, fp.gid);
-            if (!mClientCallback->onEnumerate(devId, fp.fid, fp.gid, n - i - 1).isOk()) {
-                ALOGE("failed to invoke fingerprint onEnumerate callback");
-            }
+            fingerprint_msg_t msg;
+            msg.type = FINGERPRINT_TEMPLATE_ENUMERATING;
+            msg.data.enumerated.finger = results[i];
+            msg.data.enumerated.remaining_templates = n - i - 1;
+            mDispatcher.post(&msg);
         }
     }
 
@@ -235,6 +236,16 @@ Return<RequestStatus> BiometricsFingerprint::authenticate(uint64_t operationId,
     return ErrorFilter(mDevice->authenticate(mDevice, operationId, gid));
 }
 
+Return<void> BiometricsFingerprint::debug(const hidl_handle& handle,
+        const hidl_vec<hidl_string>& /* options */) {
+    if (handle == nullptr || handle->numFds < 1) {
+        return Void();
+    }
+
+    mDispatcher.dump(handle->data[0]);
+    return Void();
+}
+
 IBiometricsFingerprint* BiometricsFingerprint::getInstance() {
     if (!sInstance) {
       sInstance = new BiometricsFingerprint();
@@ -291,18 +302,31 @@ fingerprint_device_t* BiometricsFingerprint::openHal() {
 void BiometricsFingerprint::notify(const fingerprint_msg_t *msg) {
     BiometricsFingerprint* thisPtr = static_cast<BiometricsFingerprint*>(
             BiometricsFingerprint::getInstance());
-    std::lock_guard<std::mutex> lock(thisPtr->mClientCallbackMutex);
-    if (thisPtr == nullptr || thisPtr->mClientCallback == nullptr) {
+    if (thisPtr == nullptr) {
+        ALOGE("Receiving callbacks before the HAL is initialized.");
+        return;
+    }
+    thisPtr->mDispatcher.post(msg);
+}
+
+void BiometricsFingerprint::deliver(const fingerprint_msg_t& message) {
+    const fingerprint_msg_t *msg = &message;
+    sp<IBiometricsFingerprintClientCallback> clientCallback;
+    {
+        std::lock_guard<std::mutex> lock(mClientCallbackMutex);
+        clientCallback = mClientCallback;
+    }
+    if (clientCallback == nullptr) {
         ALOGE("Receiving callbacks before the client callback is registered.");
         return;
     }
-    const uint64_t devId = reinterpret_cast<uint64_t>(thisPtr->mDevice);
+    const uint64_t devId = reinterpret_cast<uint64_t>(mDevice);
     switch (msg->type) {
         case FINGERPRINT_ERROR: {
                 int32_t vendorCode = 0;
                 FingerprintError result = VendorErrorFilter(msg->data.error, &vendorCode);
                 ALOGD("onError(%d)", result);
-                if (!thisPtr->mClientCallback->onError(devId, result, vendorCode).isOk()) {
+                if (!clientCallback->onError(devId, result, vendorCode).isOk()) {
                     ALOGE("failed to invoke fingerprint onError callback");
                 }
             }
@@ -312,7 +336,7 @@ void BiometricsFingerprint::notify(const fingerprint_msg_t *msg) {
                 FingerprintAcquiredInfo result =
                     VendorAcquiredFilter(msg->data.acquired.acquired_info, &vendorCode);
                 ALOGD("onAcquired(%d)", result);
-                if (!thisPtr->mClientCallback->onAcquired(devId, result, vendorCode).isOk()) {
+                if (!clientCallback->onAcquired(devId, result, vendorCode).isOk()) {
                     ALOGE("failed to invoke fingerprint onAcquired callback");
                 }
             }
@@ -322,7 +346,7 @@ void BiometricsFingerprint::notify(const fingerprint_msg_t *msg) {
                 msg->data.enroll.finger.fid,
                 msg->data.enroll.finger.gid,
                 msg->data.enroll.samples_remaining);
-            if (!thisPtr->mClientCallback->onEnrollResult(devId,
+            if (!clientCallback->onEnrollResult(devId,
                     msg->data.enroll.finger.fid,
                     msg->data.enroll.finger.gid,
                     msg->data.enroll.samples_remaining).isOk()) {
@@ -334,7 +358,7 @@ void BiometricsFingerprint::notify(const fingerprint_msg_t *msg) {
                 msg->data.removed.finger.fid,
                 msg->data.removed.finger.gid,
                 msg->data.removed.remaining_templates);
-            if (!thisPtr->mClientCallback->onRemoved(devId,
+            if (!clientCallback->onRemoved(devId,
                     msg->data.removed.finger.fid,
                     msg->data.removed.finger.gid,
                     msg->data.removed.remaining_templates).isOk()) {
@@ -350,7 +374,7 @@ void BiometricsFingerprint::notify(const fingerprint_msg_t *msg) {
                     reinterpret_cast<const uint8_t *>(&msg->data.authenticated.hat);
                 const hidl_vec<uint8_t> token(
                     std::vector<uint8_t>(hat, hat + sizeof(msg->data.authenticated.hat)));
-                if (!thisPtr->mClientCallback->onAuthenticated(devId,
+                if (!clientCallback->onAuthenticated(devId,
                         msg->data.authenticated.finger.fid,
                         msg->data.authenticated.finger.gid,
                         token).isOk()) {
@@ -358,7 +382,7 @@ void BiometricsFingerprint::notify(const fingerprint_msg_t *msg) {
                 }
             } else {
                 // Not a recognized fingerprint
-                if (!thisPtr->mClientCallback->onAuthenticated(devId,
+                if (!clientCallback->onAuthenticated(devId,
                         msg->data.authenticated.finger.fid,
                         msg->data.authenticated.finger.gid,
                         hidl_vec<uint8_t>()).isOk()) {
@@ -367,7 +391,17 @@ void BiometricsFingerprint::notify(const fingerprint_msg_t *msg) {
             }
             break;
         case FINGERPRINT_TEMPLATE_ENUMERATING:
-            // ignored, won't happen for 2.0 HALs
+            // Not sent by 2.0 HALs; posted by enumerate() to keep ordering
+            ALOGD("onEnumerate(fid=%d, gid=%d, rem=%d)",
+                msg->data.enumerated.finger.fid,
+                msg->data.enumerated.finger.gid,
+                msg->data.enumerated.remaining_templates);
+            if (!clientCallback->onEnumerate(devId,
+                    msg->data.enumerated.finger.fid,
+                    msg->data.enumerated.finger.gid,
+                    msg->data.enumerated.remaining_templates).isOk()) {
+                ALOGE("failed to invoke fingerprint onEnumerate callback");
+            }
             break;
     }
 }
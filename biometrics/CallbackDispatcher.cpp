@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2018 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "android.hardware.biometrics.fingerprint@2.0-service.nx531j"
+
+#include <log/log.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "CallbackDispatcher.h"
+
+namespace android {
+namespace hardware {
+namespace biometrics {
+namespace fingerprint {
+namespace V2_1 {
+namespace implementation {
+
+void LatencyHistogram::add(nsecs_t latency) {
+    nsecs_t ms = ns2ms(latency);
+    int bucket = 0;
+
+    while (bucket < LATENCY_BUCKETS - 1 && ms >= (1 << bucket)) {
+        bucket++;
+    }
+
+    buckets[bucket]++;
+    count++;
+    if (latency > max) {
+        max = latency;
+    }
+}
+
+void LatencyHistogram::dump(int fd, const char* name) const {
+    dprintf(fd, "%s: %u samples, max %" PRId64 "ms\n", name, count, ns2ms(max));
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        if (i < LATENCY_BUCKETS - 1) {
+            dprintf(fd, "  <%4dms: %u\n", 1 << i, buckets[i]);
+        } else {
+            dprintf(fd, " >=%4dms: %u\n", 1 << (i - 1), buckets[i]);
+        }
+    }
+}
+
+CallbackDispatcher::CallbackDispatcher(Handler handler)
+    : mHandler(handler), mExit(false), mFingerDown(0), mDropped(0) {
+    mThread = std::thread(&CallbackDispatcher::run, this);
+}
+
+CallbackDispatcher::~CallbackDispatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mExit = true;
+    }
+    mCond.notify_one();
+    mThread.join();
+}
+
+void CallbackDispatcher::post(const fingerprint_msg_t* msg) {
+    Event event = { *msg, 0, systemTime(SYSTEM_TIME_MONOTONIC) };
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+
+        /* The first acquired message of an attempt marks the finger going down. */
+        switch (msg->type) {
+            case FINGERPRINT_ACQUIRED:
+                if (mFingerDown == 0) {
+                    mFingerDown = event.posted;
+                }
+                break;
+            case FINGERPRINT_AUTHENTICATED:
+                event.fingerDown = mFingerDown;
+                mFingerDown = 0;
+                break;
+            case FINGERPRINT_ERROR:
+                mFingerDown = 0;
+                break;
+            default:
+                break;
+        }
+
+        if (mQueue.size() >= kMaxPending) {
+            auto acquired = mQueue.end();
+
+            if (msg->type != FINGERPRINT_ACQUIRED) {
+                for (auto it = mQueue.begin(); it != mQueue.end(); ++it) {
+                    if (it->msg.type == FINGERPRINT_ACQUIRED) {
+                        acquired = it;
+                        break;
+                    }
+                }
+            }
+
+            mDropped++;
+            if (acquired == mQueue.end()) {
+                ALOGE("Callback queue full, dropping message %d", msg->type);
+                return;
+            }
+            ALOGW("Callback queue full, dropping a pending acquired message");
+            mQueue.erase(acquired);
+        }
+
+        mQueue.push_back(event);
+    }
+    mCond.notify_one();
+}
+
+void CallbackDispatcher::run() {
+    std::unique_lock<std::mutex> lock(mLock);
+
+    for (;;) {
+        mCond.wait(lock, [this] { return mExit || !mQueue.empty(); });
+        if (mExit) {
+            break;
+        }
+
+        Event event = mQueue.front();
+        mQueue.pop_front();
+        nsecs_t dequeued = systemTime(SYSTEM_TIME_MONOTONIC);
+
+        lock.unlock();
+        mHandler(event.msg);
+        nsecs_t delivered = systemTime(SYSTEM_TIME_MONOTONIC);
+        lock.lock();
+
+        record(event, dequeued, delivered);
+    }
+}
+
+void CallbackDispatcher::record(const Event& event, nsecs_t dequeued, nsecs_t delivered) {
+    mQueueLatency.add(dequeued - event.posted);
+
+    ALOGV("message %d: queued %" PRId64 "us, delivered %" PRId64 "us", event.msg.type,
+          ns2us(dequeued - event.posted), ns2us(delivered - dequeued));
+
+    if (event.msg.type != FINGERPRINT_AUTHENTICATED ||
+            event.msg.data.authenticated.finger.fid == 0) {
+        return;
+    }
+
+    mDeliveryLatency.add(delivered - event.posted);
+    if (event.fingerDown != 0) {
+        mMatchLatency.add(event.posted - event.fingerDown);
+        mUnlockLatency.add(delivered - event.fingerDown);
+    }
+}
+
+void CallbackDispatcher::dump(int fd) {
+    std::lock_guard<std::mutex> lock(mLock);
+
+    dprintf(fd, "pending: %zu, dropped: %u\n", mQueue.size(), mDropped);
+    mQueueLatency.dump(fd, "queue wait (all messages)");
+    mMatchLatency.dump(fd, "finger down -> authenticated");
+    mDeliveryLatency.dump(fd, "authenticated -> callback delivered");
+    mUnlockLatency.dump(fd, "finger down -> callback delivered");
+}
+
+}  // namespace implementation
+}  // namespace V2_1
+}  // namespace fingerprint
+}  // namespace biometrics
+}  // namespace hardware
+}  // namespace android
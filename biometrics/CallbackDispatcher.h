@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2018 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HARDWARE_BIOMETRICS_FINGERPRINT_V2_1_CALLBACKDISPATCHER_H
+#define ANDROID_HARDWARE_BIOMETRICS_FINGERPRINT_V2_1_CALLBACKDISPATCHER_H
+
+#include <hardware/fingerprint.h>
+#include <utils/Timers.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace android {
+namespace hardware {
+namespace biometrics {
+namespace fingerprint {
+namespace V2_1 {
+namespace implementation {
+
+// Log2 buckets in ms: <1, <2, <4, ... <512, >=512
+#define LATENCY_BUCKETS 11
+
+struct LatencyHistogram {
+    uint32_t buckets[LATENCY_BUCKETS] = {};
+    uint32_t count = 0;
+    nsecs_t max = 0;
+
+    void add(nsecs_t latency);
+    void dump(int fd, const char* name) const;
+};
+
+/*
+ * Forwards legacy HAL messages to the client callback from a thread of its
+ * own, so a slow binder transaction never stalls the vendor HAL thread.
+ * Messages are delivered strictly in the order they were posted. The queue
+ * is bounded; when it is full, pending acquired messages are dropped first
+ * since they are only advisory.
+ */
+class CallbackDispatcher {
+  public:
+    using Handler = std::function<void(const fingerprint_msg_t&)>;
+
+    explicit CallbackDispatcher(Handler handler);
+    ~CallbackDispatcher();
+
+    void post(const fingerprint_msg_t* msg);
+    void dump(int fd);
+
+  private:
+    static constexpr size_t kMaxPending = 32;
+
+    struct Event {
+        fingerprint_msg_t msg;
+        nsecs_t fingerDown;
+        nsecs_t posted;
+    };
+
+    void run();
+    void record(const Event& event, nsecs_t dequeued, nsecs_t delivered);
+
+    Handler mHandler;
+    std::mutex mLock;
+    std::condition_variable mCond;
+    std::deque<Event> mQueue;
+    bool mExit;
+    std::thread mThread;
+
+    // Guarded by mLock.
+    nsecs_t mFingerDown;
+    uint32_t mDropped;
+    LatencyHistogram mQueueLatency;
+    LatencyHistogram mMatchLatency;
+    LatencyHistogram mDeliveryLatency;
+    LatencyHistogram mUnlockLatency;
+};
+
+}  // namespace implementation
+}  // namespace V2_1
+}  // namespace fingerprint
+}  // namespace biometrics
+}  // namespace hardware
+}  // namespace android
+
+#endif  // ANDROID_HARDWARE_BIOMETRICS_FINGERPRINT_V2_1_CALLBACKDISPATCHER_H
@@ -6,8 +6,12 @@ include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES := \
         util/QCameraBufferMaps.cpp \
+        util/QCameraCapsCache.cpp \
         util/QCameraCmdThread.cpp \
+        util/QCameraDebugConfig.cpp \
+        util/QCameraDumpWriter.cpp \
         util/QCameraFlash.cpp \
+        util/QCameraKpiRing.cpp \
         util/QCameraPerf.cpp \
         util/QCameraQueue.cpp \
         QCamera2Hal.cpp \
@@ -44,6 +44,9 @@
 #include "android/QCamera2External.h"
 #include "QCamera2HWI.h"
 #include "QCameraBufferMaps.h"
+#include "QCameraCapsCache.h"
+#include "QCameraDebugConfig.h"
+#include "QCameraDumpWriter.h"
 #include "QCameraFlash.h"
 #include "QCameraTrace.h"
 
@@ -81,6 +84,39 @@ volatile uint32_t gCamHalLogLevel = 1;
 extern uint8_t gNumCameraSessions;
 uint32_t QCamera2HardwareInterface::sNextJobId = 1;
 
+#ifdef ENABLE_MODEL_INFO_EXIF
+typedef struct {
+    char make[PROPERTY_VALUE_MAX];
+    char model[PROPERTY_VALUE_MAX];
+    char software[PROPERTY_VALUE_MAX];
+} exif_model_info_t;
+
+/*===========================================================================
+ * FUNCTION   : loadExifModelInfo
+ *
+ * DESCRIPTION: read the make, model and software exif strings. They don't
+ *              change at runtime, so this runs once per process.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : make, model and software strings
+ *==========================================================================*/
+static exif_model_info_t loadExifModelInfo()
+{
+    exif_model_info_t info;
+
+    if (property_get("persist.sys.exif.make", info.make, "") <= 0) {
+        property_get("ro.product.manufacturer", info.make, "QCOM-AA");
+    }
+    if (property_get("persist.sys.exif.model", info.model, "") <= 0) {
+        property_get("ro.product.model", info.model, "QCAM-AA");
+    }
+    property_get("ro.build.description", info.software, "QCAM-AA");
+
+    return info;
+}
+#endif
+
 camera_device_ops_t QCamera2HardwareInterface::mCameraOps = {
     .set_preview_window =        QCamera2HardwareInterface::set_preview_window,
     .set_callbacks =             QCamera2HardwareInterface::set_CallBacks,
@@ -1206,6 +1242,8 @@ QCamera2HardwareInterface::QCamera2HardwareInterface(uint32_t cameraId)
       mJpegCb(NULL),
       mCallbackCookie(NULL),
       mJpegCallbackCookie(NULL),
+      mPreviewSyncCb(NULL),
+      mPreviewSyncCookie(NULL),
       m_bMpoEnabled(TRUE),
       m_stateMachine(this),
       m_smThreadActive(true),
@@ -1293,8 +1331,28 @@ QCamera2HardwareInterface::QCamera2HardwareInterface(uint32_t cameraId)
     memset(&mJpegHandle, 0, sizeof(mJpegHandle));
     memset(&mJpegMpoHandle, 0, sizeof(mJpegMpoHandle));
 
-    mDeferredWorkThread.launch(deferredWorkRoutine, this);
-    mDeferredWorkThread.sendCmd(CAMERA_CMD_TYPE_START_DATA_PROC, FALSE, FALSE);
+    memset(mDefJobTiming, 0, sizeof(mDefJobTiming));
+    mDefJobTimingCnt = 0;
+    mDefPhase = NULL;
+    mDefPhaseStart = 0;
+    mNextDefWorker = 0;
+
+    // Deferred jobs run on a small pool of workers, dependencies between
+    // jobs are declared when they are queued
+    char defWorkers[PROPERTY_VALUE_MAX];
+    property_get("persist.camera.defwork.threads", defWorkers, "2");
+    mNumDefWorkers = (uint32_t)atoi(defWorkers);
+    if (mNumDefWorkers < 1) {
+        mNumDefWorkers = 1;
+    } else if (mNumDefWorkers > MAX_DEFERRED_WORKERS) {
+        mNumDefWorkers = MAX_DEFERRED_WORKERS;
+    }
+    for (uint32_t i = 0; i < mNumDefWorkers; i++) {
+        mDefWorkers[i].parent = this;
+        mDefWorkers[i].cmdThread.launch(deferredWorkRoutine, &mDefWorkers[i]);
+        mDefWorkers[i].cmdThread.sendCmd(CAMERA_CMD_TYPE_START_DATA_PROC,
+                FALSE, FALSE);
+    }
     m_perfLock.lock_init();
 
     pthread_mutex_init(&mGrallocLock, NULL);
@@ -1328,8 +1386,11 @@ QCamera2HardwareInterface::~QCamera2HardwareInterface()
 {
     LOGH("E");
 
-    mDeferredWorkThread.sendCmd(CAMERA_CMD_TYPE_STOP_DATA_PROC, TRUE, TRUE);
-    mDeferredWorkThread.exit();
+    for (uint32_t i = 0; i < mNumDefWorkers; i++) {
+        mDefWorkers[i].cmdThread.sendCmd(CAMERA_CMD_TYPE_STOP_DATA_PROC,
+                TRUE, TRUE);
+        mDefWorkers[i].cmdThread.exit();
+    }
 
     if (mMetadataMem != NULL) {
         delete mMetadataMem;
@@ -1377,8 +1438,9 @@ uint32_t QCamera2HardwareInterface::deferPPInit()
     pprocInitArgs.user_data = this;
     args.pprocInitArgs = pprocInitArgs;
 
+    // postproc init needs the calibration data read by param init
     return queueDeferredWork(CMD_DEF_PPROC_INIT,
-            args);
+            args, mParamInitJob);
 }
 
 /*===========================================================================
@@ -1442,6 +1504,8 @@ int QCamera2HardwareInterface::openCamera()
         return ALREADY_EXISTS;
     }
 
+    markDeferredWorkPhase("camera open");
+
     rc = QCameraFlash::getInstance().reserveFlashForCamera(mCameraId);
     if (rc < 0) {
         LOGE("Failed to reserve flash for camera id: %d",
@@ -1473,7 +1537,8 @@ int QCamera2HardwareInterface::openCamera()
         metadataAllocArgs.bufferCnt = CAMERA_MIN_METADATA_BUFFERS;
         args.metadataAllocArgs = metadataAllocArgs;
 
-        mMetadataAllocJob = queueDeferredWork(CMD_DEF_METADATA_ALLOC, args);
+        mMetadataAllocJob = queueDeferredWork(CMD_DEF_METADATA_ALLOC, args,
+                mParamAllocJob);
         if (mMetadataAllocJob == 0) {
             LOGE("Failed to allocate metadata buffer");
             rc = -ENOMEM;
@@ -1513,19 +1578,23 @@ int QCamera2HardwareInterface::openCamera()
 
     // Init params in the background
     // 1. It's safe to queue init job, even if alloc job is not yet complete.
-    // It will be queued to the same thread, so the alloc is guaranteed to
-    // finish first.
+    // It depends on the alloc job, so the alloc is guaranteed to finish
+    // first.
     // 2. However, it is not safe to begin param init until after camera is
     // open. That is why we wait until after camera open completes to schedule
     // this task.
     memset(&args, 0, sizeof(args));
-    mParamInitJob = queueDeferredWork(CMD_DEF_PARAM_INIT, args);
+    mParamInitJob = queueDeferredWork(CMD_DEF_PARAM_INIT, args,
+            mParamAllocJob);
     if (mParamInitJob == 0) {
         LOGE("Failed queuing PARAM_INIT job");
         rc = -ENOMEM;
         goto error_exit3;
     }
 
+    // debug properties read by the frame callbacks
+    QCameraDebugConfig::getInstance().init();
+
     mCameraOpened = true;
 
     //Notify display HAL that a camera session is active.
@@ -1752,6 +1821,9 @@ int QCamera2HardwareInterface::closeCamera()
 
     // exit notifier
     m_cbNotifier.exit();
+    m_previewCbPool.clear();
+
+    QCameraDebugConfig::getInstance().deinit();
 
     // stop and deinit postprocessor
     waitDeferredWork(mReprocJob);
@@ -1836,6 +1908,12 @@ int QCamera2HardwareInterface::initCapabilities(uint32_t cameraId,
     int rc = NO_ERROR;
     QCameraHeapMemory *capabilityHeap = NULL;
 
+    gCamCapability[cameraId] =
+            QCameraCapsCache::getInstance().loadCapability(cameraId);
+    if (gCamCapability[cameraId] != NULL) {
+        return NO_ERROR;
+    }
+
     /* Allocate memory for capability buffer */
     capabilityHeap = new QCameraHeapMemory(QCAMERA_ION_USE_CACHE);
     rc = capabilityHeap->allocate(1, sizeof(cam_capability_t), NON_SECURE);
@@ -1881,6 +1959,8 @@ int QCamera2HardwareInterface::initCapabilities(uint32_t cameraId,
                                         sizeof(cam_capability_t));
     gCamCapability[cameraId]->analysis_padding_info.offset_info.offset_x = 0;
     gCamCapability[cameraId]->analysis_padding_info.offset_info.offset_y = 0;
+    QCameraCapsCache::getInstance().storeCapability(cameraId,
+            gCamCapability[cameraId]);
 
     rc = NO_ERROR;
 
@@ -2820,6 +2900,7 @@ int QCamera2HardwareInterface::setCallBacks(camera_notify_callback notify_cb,
     mGetMemory       = get_memory;
     mCallbackCookie  = user;
     m_cbNotifier.setCallbacks(notify_cb, data_cb, data_cb_timestamp, user);
+    m_previewCbPool.setCallbacks(get_memory, user);
     return NO_ERROR;
 }
 
@@ -2845,6 +2926,46 @@ void QCamera2HardwareInterface::setJpegCallBacks(jpeg_data_callback jpegCb,
     m_cbNotifier.setJpegCallBacks(mJpegCb, mJpegCallbackCookie);
 }
 
+/*===========================================================================
+ * FUNCTION   : setPreviewSyncCallBack
+ *
+ * DESCRIPTION: set callback reporting preview frames of a related camera
+ *              session, used to pair them with the other sessions
+ *
+ * PARAMETERS :
+ *   @syncCb  : preview sync callback method
+ *   @callbackCookie    : callback cookie
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCamera2HardwareInterface::setPreviewSyncCallBack(preview_sync_callback syncCb,
+                                            void *callbackCookie)
+{
+    LOGH("camera id %d", getCameraId());
+    mPreviewSyncCb      = syncCb;
+    mPreviewSyncCookie  = callbackCookie;
+}
+
+/*===========================================================================
+ * FUNCTION   : syncPreviewFrame
+ *
+ * DESCRIPTION: reports a preview frame to the preview sync callback
+ *
+ * PARAMETERS :
+ *   @frame   : preview frame
+ *
+ * RETURN     : true if the preview data callback of the frame is to be sent
+ *==========================================================================*/
+bool QCamera2HardwareInterface::syncPreviewFrame(mm_camera_buf_def_t *frame)
+{
+    if (mPreviewSyncCb == NULL) {
+        return true;
+    }
+    return mPreviewSyncCb(
+            nsecs_t(frame->ts.tv_sec) * 1000000000LL + frame->ts.tv_nsec,
+            frame->frame_idx, mPreviewSyncCookie);
+}
+
 /*===========================================================================
  * FUNCTION   : enableMsgType
  *
@@ -2967,6 +3088,7 @@ int QCamera2HardwareInterface::startPreview()
     LOGI("E ZSL = %d Recording Hint = %d", mParameters.isZSLMode(),
             mParameters.getRecordingHintValue());
 
+    markDeferredWorkPhase("preview start");
     m_perfLock.lock_acq();
 
     updateThermalLevel((void *)&mThermalLevel);
@@ -3024,6 +3146,7 @@ int QCamera2HardwareInterface::startPreview()
     if (rc == NO_ERROR) {
         // Set power Hint for preview
         m_perfLock.powerHint(POWER_HINT_VIDEO_ENCODE, true);
+        m_perfLock.governorStart();
     }
 
     LOGI("X rc = %d", rc);
@@ -3057,6 +3180,7 @@ int QCamera2HardwareInterface::stopPreview()
 
     // Disable power Hint for preview
     m_perfLock.powerHint(POWER_HINT_VIDEO_ENCODE, false);
+    m_perfLock.governorStop();
 
     m_perfLock.lock_acq();
 
@@ -3878,10 +4002,9 @@ int QCamera2HardwareInterface::takePicture()
             args.pprocArgs = pZSLChannel;
 
             // No need to wait for mInitPProcJob here, because it was
-            // queued in startPreview, and will definitely be processed before
-            // mReprocJob can begin.
+            // queued in startPreview, and mReprocJob depends on it.
             mReprocJob = queueDeferredWork(CMD_DEF_PPROC_START,
-                    args);
+                    args, mInitPProcJob);
             if (mReprocJob == 0) {
                 LOGE("Failure: Unable to start pproc");
                 return -ENOMEM;
@@ -3925,7 +4048,7 @@ int QCamera2HardwareInterface::takePicture()
 
             // Create JPEG session
             mJpegJob = queueDeferredWork(CMD_DEF_CREATE_JPEG_SESSION,
-                    args);
+                    args, mReprocJob);
             if (mJpegJob == 0) {
                 LOGE("Failure: Unable to create jpeg session");
                 return -ENOMEM;
@@ -4031,10 +4154,9 @@ int QCamera2HardwareInterface::takePicture()
                 args.pprocArgs = m_channels[QCAMERA_CH_TYPE_CAPTURE];
 
                 // No need to wait for mInitPProcJob here, because it was
-                // queued in startPreview, and will definitely be processed before
-                // mReprocJob can begin.
+                // queued in startPreview, and mReprocJob depends on it.
                 mReprocJob = queueDeferredWork(CMD_DEF_PPROC_START,
-                        args);
+                        args, mInitPProcJob);
                 if (mReprocJob == 0) {
                     LOGE("Failure: Unable to start pproc");
                     return -ENOMEM;
@@ -4042,7 +4164,7 @@ int QCamera2HardwareInterface::takePicture()
 
                 // Create JPEG session
                 mJpegJob = queueDeferredWork(CMD_DEF_CREATE_JPEG_SESSION,
-                        args);
+                        args, mReprocJob);
                 if (mJpegJob == 0) {
                     LOGE("Failed to queue CREATE_JPEG_SESSION");
                     return -ENOMEM;
@@ -5109,6 +5231,8 @@ int QCamera2HardwareInterface::dump(int fd)
     dprintf(fd, "StoreMetaDataInFrame: %d \n", mStoreMetaDataInFrame);
     dprintf(fd, "\n Configuration: %s", mParameters.dump().string());
     dprintf(fd, "\n State Information: %s", m_stateMachine.dump().string());
+    QCameraDumpWriter::getInstance().dump(fd);
+    m_kpiRing.dump(fd);
     dprintf(fd, "\n Camera HAL information End \n");
 
     /* send UPDATE_DEBUG_LEVEL to the backend so that they can read the
@@ -7322,6 +7446,9 @@ int32_t QCamera2HardwareInterface::preparePreview()
  *==========================================================================*/
 void QCamera2HardwareInterface::unpreparePreview()
 {
+    // Drop the app wrappers before the stream buffers they map go away
+    m_previewCbPool.clear();
+
     delChannel(QCAMERA_CH_TYPE_ZSL);
     delChannel(QCAMERA_CH_TYPE_PREVIEW);
     delChannel(QCAMERA_CH_TYPE_VIDEO);
@@ -7632,6 +7759,29 @@ void QCamera2HardwareInterface::releaseCameraMemory(void *data,
     }
 }
 
+/*===========================================================================
+ * FUNCTION   : returnPreviewCbMemory
+ *
+ * DESCRIPTION: returns preview callback memory back to its pool
+ *
+ * PARAMETERS :
+ *   @data    : buffer to be returned
+ *   @cookie  : context data
+ *   @cbStatus: callback status
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCamera2HardwareInterface::returnPreviewCbMemory(void *data,
+                                                      void *cookie,
+                                                      int32_t /*cbStatus*/)
+{
+    QCamera2HardwareInterface *pme = (QCamera2HardwareInterface *)cookie;
+    camera_memory_t *mem = ( camera_memory_t * ) data;
+    if (NULL != pme) {
+        pme->m_previewCbPool.putMemory(mem);
+    }
+}
+
 /*===========================================================================
  * FUNCTION   : returnStreamBuffer
  *
@@ -8325,29 +8475,14 @@ QCameraExif *QCamera2HardwareInterface::getExifData()
 
 #ifdef ENABLE_MODEL_INFO_EXIF
 
-    char value[PROPERTY_VALUE_MAX];
-    if (property_get("persist.sys.exif.make", value, "") > 0 ||
-            property_get("ro.product.manufacturer", value, "QCOM-AA") > 0) {
-        exif->addEntry(EXIFTAGID_MAKE,
-                EXIF_ASCII, strlen(value) + 1, (void *)value);
-    } else {
-        LOGW("getExifMaker failed");
-    }
-
-    if (property_get("persist.sys.exif.model", value, "") > 0 ||
-            property_get("ro.product.model", value, "QCAM-AA") > 0) {
-        exif->addEntry(EXIFTAGID_MODEL,
-                EXIF_ASCII, strlen(value) + 1, (void *)value);
-    } else {
-        LOGW("getExifModel failed");
-    }
-
-    if (property_get("ro.build.description", value, "QCAM-AA") > 0) {
-        exif->addEntry(EXIFTAGID_SOFTWARE, EXIF_ASCII,
-                (uint32_t)(strlen(value) + 1), (void *)value);
-    } else {
-        LOGW("getExifSoftware failed");
-    }
+    // Read once, then copied into the arena of every capture
+    static const exif_model_info_t modelInfo = loadExifModelInfo();
+    exif->addEntry(EXIFTAGID_MAKE, EXIF_ASCII,
+            (uint32_t)(strlen(modelInfo.make) + 1), (void *)modelInfo.make);
+    exif->addEntry(EXIFTAGID_MODEL, EXIF_ASCII,
+            (uint32_t)(strlen(modelInfo.model) + 1), (void *)modelInfo.model);
+    exif->addEntry(EXIFTAGID_SOFTWARE, EXIF_ASCII,
+            (uint32_t)(strlen(modelInfo.software) + 1), (void *)modelInfo.software);
 
 #endif
 
@@ -8504,10 +8639,13 @@ bool QCamera2HardwareInterface::needFDMetadata(qcamera_ch_type_enum_t channel_ty
 /*===========================================================================
  * FUNCTION   : deferredWorkRoutine
  *
- * DESCRIPTION: data process routine that executes deferred tasks
+ * DESCRIPTION: data process routine of a deferred work worker. Runs
+ *              queued tasks whose dependencies are complete until none
+ *              is left, so tasks unblocked by a finished task are picked
+ *              up by the worker that finished it.
  *
  * PARAMETERS :
- *   @data    : user data ptr (QCamera2HardwareInterface)
+ *   @data    : user data ptr (DefWorker)
  *
  * RETURN     : None
  *==========================================================================*/
@@ -8518,8 +8656,9 @@ void *QCamera2HardwareInterface::deferredWorkRoutine(void *obj)
     uint8_t is_active = FALSE;
     int32_t job_status = 0;
 
-    QCamera2HardwareInterface *pme = (QCamera2HardwareInterface *)obj;
-    QCameraCmdThread *cmdThread = &pme->mDeferredWorkThread;
+    DefWorker *worker = (DefWorker *)obj;
+    QCamera2HardwareInterface *pme = worker->parent;
+    QCameraCmdThread *cmdThread = &worker->cmdThread;
     cmdThread->setName("CAM_defrdWrk");
 
     do {
@@ -8547,15 +8686,15 @@ void *QCamera2HardwareInterface::deferredWorkRoutine(void *obj)
             cam_sem_post(&cmdThread->sync_sem);
             break;
         case CAMERA_CMD_TYPE_DO_NEXT_JOB:
-            {
-                DefWork *dw =
-                    reinterpret_cast<DefWork *>(pme->mCmdQueue.dequeue());
+            while (1) {
+                DefWork *dw = pme->getReadyDeferredWork();
 
                 if ( NULL == dw ) {
-                    LOGE("Invalid deferred work");
+                    LOGD("No deferred work ready");
                     break;
                 }
 
+                job_status = 0;
                 switch( dw->cmd ) {
                 case CMD_DEF_ALLOCATE_BUFF:
                     {
@@ -8857,17 +8996,21 @@ void *QCamera2HardwareInterface::deferredWorkRoutine(void *obj)
  * PARAMETERS :
  *   @cmd     : deferred task
  *   @args    : deferred task arguments
+ *   @dep0    : job which has to complete before this task runs, 0 if none
+ *   @dep1    : job which has to complete before this task runs, 0 if none
  *
  * RETURN     : job id of deferred job
  *            : 0 in case of error
  *==========================================================================*/
 uint32_t QCamera2HardwareInterface::queueDeferredWork(DeferredWorkCmd cmd,
-                                                      DeferWorkArgs args)
+                                                      DeferWorkArgs args,
+                                                      uint32_t dep0,
+                                                      uint32_t dep1)
 {
     Mutex::Autolock l(mDefLock);
     for (int32_t i = 0; i < MAX_ONGOING_JOBS; ++i) {
         if (mDefOngoingJobs[i].mDefJobId == 0) {
-            DefWork *dw = new DefWork(cmd, sNextJobId, args);
+            DefWork *dw = new DefWork(cmd, sNextJobId, args, dep0, dep1);
             if (!dw) {
                 LOGE("out of memory.");
                 return 0;
@@ -8878,9 +9021,13 @@ uint32_t QCamera2HardwareInterface::queueDeferredWork(DeferredWorkCmd cmd,
                 if (sNextJobId == 0) { // handle overflow
                     sNextJobId = 1;
                 }
-                mDeferredWorkThread.sendCmd(CAMERA_CMD_TYPE_DO_NEXT_JOB,
+                // Any idle worker can take the task, hand the wake up
+                // round robin so independent tasks start in parallel
+                mDefWorkers[mNextDefWorker].cmdThread.sendCmd(
+                        CAMERA_CMD_TYPE_DO_NEXT_JOB,
                         FALSE,
                         FALSE);
+                mNextDefWorker = (mNextDefWorker + 1) % mNumDefWorkers;
                 return mDefOngoingJobs[i].mDefJobId;
             } else {
                 LOGD("Command queue not active! cmd = %d", cmd);
@@ -8892,6 +9039,140 @@ uint32_t QCamera2HardwareInterface::queueDeferredWork(DeferredWorkCmd cmd,
     return 0;
 }
 
+/*===========================================================================
+ * FUNCTION   : matchReadyDeferredWork
+ *
+ * DESCRIPTION: queue match function selecting deferred tasks whose
+ *              dependencies are complete
+ *
+ * PARAMETERS :
+ *   @data       : deferred work
+ *   @user_data  : not used
+ *   @match_data : QCamera2HardwareInterface
+ *
+ * RETURN     : true if the task can run
+ *
+ * PRECONDITION : mDefLock is held by current thread
+ *==========================================================================*/
+bool QCamera2HardwareInterface::matchReadyDeferredWork(void *data,
+        __unused void *user_data, void *match_data)
+{
+    DefWork *dw = reinterpret_cast<DefWork *>(data);
+    QCamera2HardwareInterface *pme =
+            reinterpret_cast<QCamera2HardwareInterface *>(match_data);
+
+    for (uint32_t i = 0; i < MAX_DEF_JOB_DEPS; i++) {
+        // a failed dependency is complete too, the task checks its status
+        if ((dw->deps[i] != 0) && pme->checkDeferredWork(dw->deps[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*===========================================================================
+ * FUNCTION   : getReadyDeferredWork
+ *
+ * DESCRIPTION: takes the oldest queued deferred task that can run
+ *
+ * PARAMETERS : none
+ *
+ * RETURN     : deferred work, NULL if no task can run now
+ *==========================================================================*/
+QCamera2HardwareInterface::DefWork *
+        QCamera2HardwareInterface::getReadyDeferredWork()
+{
+    Mutex::Autolock l(mDefLock);
+    DefWork *dw = reinterpret_cast<DefWork *>(
+            mCmdQueue.dequeue(matchReadyDeferredWork, this));
+    if (dw != NULL) {
+        dw->startTime = systemTime();
+    }
+    return dw;
+}
+
+/*===========================================================================
+ * FUNCTION   : markDeferredWorkPhase
+ *
+ * DESCRIPTION: starts timing the deferred tasks of a phase, e.g. camera
+ *              open. The critical path of the phase is reported once all
+ *              deferred tasks have completed.
+ *
+ * PARAMETERS :
+ *   @phase   : phase name
+ *
+ * RETURN     : none
+ *==========================================================================*/
+void QCamera2HardwareInterface::markDeferredWorkPhase(const char *phase)
+{
+    Mutex::Autolock l(mDefLock);
+    mDefPhase = phase;
+    mDefPhaseStart = systemTime();
+}
+
+/*===========================================================================
+ * FUNCTION   : reportDeferredWorkTiming
+ *
+ * DESCRIPTION: logs the deferred tasks of the current phase and the
+ *              chain of dependencies which finished last
+ *
+ * PARAMETERS :
+ *   @now     : completion time of the last task
+ *
+ * RETURN     : none
+ *
+ * PRECONDITION : mDefLock is held by current thread
+ *==========================================================================*/
+void QCamera2HardwareInterface::reportDeferredWorkTiming(nsecs_t now)
+{
+    uint32_t cnt = (mDefJobTimingCnt < DEF_JOB_TIMING_SIZE) ?
+            mDefJobTimingCnt : DEF_JOB_TIMING_SIZE;
+    DefJobTiming *last = NULL;
+
+    LOGI("[KPI Perf] %s: deferred work done %lld ms after start, %d workers",
+            mDefPhase, (long long)ns2ms(now - mDefPhaseStart), mNumDefWorkers);
+
+    for (uint32_t i = 0; i < cnt; i++) {
+        DefJobTiming *t = &mDefJobTiming[i];
+        if (t->queuedTime < mDefPhaseStart) {
+            continue;
+        }
+        LOGH("[KPI Perf] %s: job %d cmd %d waited %lld us ran %lld us",
+                mDefPhase, t->id, t->cmd,
+                (long long)ns2us(t->startTime - t->queuedTime),
+                (long long)ns2us(t->endTime - t->startTime));
+        if ((last == NULL) || (t->endTime > last->endTime)) {
+            last = t;
+        }
+    }
+
+    // Walk back from the last task through the dependency that
+    // finished last
+    char path[256];
+    size_t len = 0;
+    path[0] = '\0';
+    while ((last != NULL) && (len < sizeof(path))) {
+        len += (size_t)snprintf(path + len, sizeof(path) - len,
+                "%s%d(%lld ms)", (len != 0) ? " <- " : "", last->cmd,
+                (long long)ns2ms(last->endTime - last->startTime));
+        DefJobTiming *dep = NULL;
+        for (uint32_t d = 0; d < MAX_DEF_JOB_DEPS; d++) {
+            if (last->deps[d] == 0) {
+                continue;
+            }
+            for (uint32_t i = 0; i < cnt; i++) {
+                if ((mDefJobTiming[i].id == last->deps[d]) &&
+                        ((dep == NULL) ||
+                        (mDefJobTiming[i].endTime > dep->endTime))) {
+                    dep = &mDefJobTiming[i];
+                }
+            }
+        }
+        last = dep;
+    }
+    LOGI("[KPI Perf] %s: critical path %s", mDefPhase, path);
+}
+
 /*===========================================================================
  * FUNCTION   : initJpegHandle
  *
@@ -9047,6 +9328,15 @@ int32_t QCamera2HardwareInterface::getJpegHandleInfo(mm_jpeg_ops_t *ops,
 uint32_t QCamera2HardwareInterface::dequeueDeferredWork(DefWork* dw, int32_t jobStatus)
 {
     Mutex::Autolock l(mDefLock);
+    nsecs_t now = systemTime();
+    DefJobTiming *t = &mDefJobTiming[mDefJobTimingCnt++ % DEF_JOB_TIMING_SIZE];
+    t->id = dw->id;
+    t->cmd = dw->cmd;
+    memcpy(t->deps, dw->deps, sizeof(t->deps));
+    t->queuedTime = dw->queuedTime;
+    t->startTime = dw->startTime;
+    t->endTime = now;
+
     for (uint32_t i = 0; i < MAX_ONGOING_JOBS; i++) {
         if (mDefOngoingJobs[i].mDefJobId == dw->id) {
             if (jobStatus != NO_ERROR) {
@@ -9059,6 +9349,21 @@ uint32_t QCamera2HardwareInterface::dequeueDeferredWork(DefWork* dw, int32_t job
             }
             delete dw;
             mDefCond.broadcast();
+
+            if (mDefPhase != NULL) {
+                bool pending = false;
+                for (uint32_t j = 0; j < MAX_ONGOING_JOBS; j++) {
+                    if ((mDefOngoingJobs[j].mDefJobId != 0) &&
+                            checkDeferredWork(mDefOngoingJobs[j].mDefJobId)) {
+                        pending = true;
+                        break;
+                    }
+                }
+                if (!pending) {
+                    reportDeferredWorkTiming(now);
+                    mDefPhase = NULL;
+                }
+            }
             return NO_ERROR;
         }
     }
@@ -9160,7 +9465,7 @@ uint32_t QCamera2HardwareInterface::scheduleBackgroundTask(BackgroundTask* bgTas
     memset(&args, 0, sizeof(DeferWorkArgs));
     args.genericArgs = bgTask;
 
-    return queueDeferredWork(CMD_DEF_GENERIC, args);
+    return queueDeferredWork(CMD_DEF_GENERIC, args, bgTask->dependsOn);
 }
 
 /*===========================================================================
@@ -40,6 +40,7 @@
 #include "QCameraChannel.h"
 #include "QCameraCmdThread.h"
 #include "QCameraDisplay.h"
+#include "QCameraKpiRing.h"
 #include "QCameraMem.h"
 #include "QCameraParameters.h"
 #include "QCameraParametersIntf.h"
@@ -102,6 +103,9 @@ typedef struct {
 #define QCAMERA_ION_USE_CACHE   true
 #define QCAMERA_ION_USE_NOCACHE false
 #define MAX_ONGOING_JOBS 25
+#define MAX_DEFERRED_WORKERS 3
+#define MAX_DEF_JOB_DEPS 2
+#define DEF_JOB_TIMING_SIZE 32
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
@@ -122,6 +126,10 @@ typedef void (*jpeg_data_callback)(int32_t msg_type,
         camera_frame_metadata_t *metadata, void *user,
         uint32_t frame_idx, camera_release_callback release_cb,
         void *release_cookie, void *release_data);
+// Reports the SOF time stamp of a preview frame, returns whether the
+// preview data callback of the frame is to be sent
+typedef bool (*preview_sync_callback)(nsecs_t timestamp, uint32_t frame_idx,
+        void *user);
 
 typedef struct {
     qcamera_callback_type_m  cb_type;    // event type
@@ -277,6 +285,9 @@ public:
 
     void setJpegCallBacks(jpeg_data_callback jpegCb,
             void *callbackCookie);
+    void setPreviewSyncCallBack(preview_sync_callback syncCb,
+            void *callbackCookie);
+    bool syncPreviewFrame(mm_camera_buf_def_t *frame);
     int32_t initJpegHandle();
     int32_t deinitJpegHandle();
     int32_t setJpegHandleInfo(mm_jpeg_ops_t *ops,
@@ -525,6 +536,9 @@ private:
     static void returnStreamBuffer(void *data,
                                    void *cookie,
                                    int32_t cbStatus);
+    static void returnPreviewCbMemory(void *data,
+                                      void *cookie,
+                                      int32_t cbStatus);
     static void getLogLevel();
 
 private:
@@ -548,6 +562,8 @@ private:
     jpeg_data_callback             mJpegCb;
     void                          *mCallbackCookie;
     void                          *mJpegCallbackCookie;
+    preview_sync_callback          mPreviewSyncCb;
+    void                          *mPreviewSyncCookie;
     bool                           m_bMpoEnabled;
 
     QCameraStateMachine m_stateMachine;   // state machine
@@ -560,6 +576,7 @@ private:
     pthread_cond_t m_cond;
     api_result_list *m_apiResultList;
     QCameraMemoryPool m_memoryPool;
+    QCameraPreviewCbPool m_previewCbPool;
 
     pthread_mutex_t m_evtLock;
     pthread_cond_t m_evtCond;
@@ -664,29 +681,70 @@ private:
     {
         DefWork(DeferredWorkCmd cmd_,
                  uint32_t id_,
-                 DeferWorkArgs args_)
+                 DeferWorkArgs args_,
+                 uint32_t dep0_,
+                 uint32_t dep1_)
             : cmd(cmd_),
               id(id_),
-              args(args_){};
+              args(args_),
+              queuedTime(systemTime()),
+              startTime(0)
+        {
+            deps[0] = dep0_;
+            deps[1] = dep1_;
+        };
 
         DeferredWorkCmd cmd;
         uint32_t id;
         DeferWorkArgs args;
+        // jobs which have to complete before this one may run
+        uint32_t deps[MAX_DEF_JOB_DEPS];
+        nsecs_t queuedTime;
+        nsecs_t startTime;
     };
 
-    QCameraCmdThread      mDeferredWorkThread;
+    // Completed deferred job, for the critical path report
+    typedef struct {
+        uint32_t id;
+        DeferredWorkCmd cmd;
+        uint32_t deps[MAX_DEF_JOB_DEPS];
+        nsecs_t queuedTime;
+        nsecs_t startTime;
+        nsecs_t endTime;
+    } DefJobTiming;
+
+    typedef struct {
+        QCameraCmdThread cmdThread;
+        QCamera2HardwareInterface *parent;
+    } DefWorker;
+
+    DefWorker             mDefWorkers[MAX_DEFERRED_WORKERS];
+    uint32_t              mNumDefWorkers;
+    uint32_t              mNextDefWorker;
     QCameraQueue          mCmdQueue;
 
     Mutex                 mDefLock;
     Condition             mDefCond;
 
+    DefJobTiming          mDefJobTiming[DEF_JOB_TIMING_SIZE];
+    uint32_t              mDefJobTimingCnt;
+    const char           *mDefPhase;
+    nsecs_t               mDefPhaseStart;
+
     uint32_t queueDeferredWork(DeferredWorkCmd cmd,
-                               DeferWorkArgs args);
+                               DeferWorkArgs args,
+                               uint32_t dep0 = 0,
+                               uint32_t dep1 = 0);
     uint32_t dequeueDeferredWork(DefWork* dw, int32_t jobStatus);
+    DefWork *getReadyDeferredWork();
+    static bool matchReadyDeferredWork(void *data, void *user_data,
+            void *match_data);
     int32_t waitDeferredWork(uint32_t &job_id);
     static void *deferredWorkRoutine(void *obj);
     bool checkDeferredWork(uint32_t &job_id);
     int32_t getDefJobStatus(uint32_t &job_id);
+    void markDeferredWorkPhase(const char *phase);
+    void reportDeferredWorkTiming(nsecs_t now);
 
     uint32_t mReprocJob;
     uint32_t mJpegJob;
@@ -732,6 +790,9 @@ private:
     //QCamera Display Object
     //QCameraDisplay mCameraDisplay;
 
+    // Per frame event time stamps of this session
+    QCameraKpiRing m_kpiRing;
+
     Mutex mMapLock;
     Condition mMapCond;
 
@@ -39,6 +39,8 @@
 
 // Camera dependencies
 #include "QCamera2HWI.h"
+#include "QCameraDebugConfig.h"
+#include "QCameraDumpWriter.h"
 #include "QCameraTrace.h"
 
 extern "C" {
@@ -68,7 +70,8 @@ void QCamera2HardwareInterface::zsl_channel_cb(mm_camera_super_buf_t *recvd_fram
 {
     ATRACE_CALL();
     LOGH("[KPI Perf]: E");
-    char value[PROPERTY_VALUE_MAX];
+    const qcamera_debug_config_t debugConfig =
+            QCameraDebugConfig::getInstance().get();
     bool dump_raw = false;
     bool dump_yuv = false;
     bool log_matching = false;
@@ -156,8 +159,7 @@ void QCamera2HardwareInterface::zsl_channel_cb(mm_camera_super_buf_t *recvd_fram
     }
 
     // DUMP RAW if available
-    property_get("persist.camera.zsl_raw", value, "0");
-    dump_raw = atoi(value) > 0 ? true : false;
+    dump_raw = debugConfig.zsl_raw;
     if (dump_raw) {
         for (uint32_t i = 0; i < recvd_frame->num_bufs; i++) {
             if (recvd_frame->bufs[i]->stream_type == CAM_STREAM_TYPE_RAW) {
@@ -172,8 +174,7 @@ void QCamera2HardwareInterface::zsl_channel_cb(mm_camera_super_buf_t *recvd_fram
     }
 
     // DUMP YUV before reprocess if needed
-    property_get("persist.camera.zsl_yuv", value, "0");
-    dump_yuv = atoi(value) > 0 ? true : false;
+    dump_yuv = debugConfig.zsl_yuv;
     if (dump_yuv) {
         for (uint32_t i = 0; i < recvd_frame->num_bufs; i++) {
             if (recvd_frame->bufs[i]->stream_type == CAM_STREAM_TYPE_SNAPSHOT) {
@@ -239,8 +240,7 @@ void QCamera2HardwareInterface::zsl_channel_cb(mm_camera_super_buf_t *recvd_fram
         }
     }
 
-    property_get("persist.camera.dumpmetadata", value, "0");
-    int32_t enabled = atoi(value);
+    int32_t enabled = (int32_t) debugConfig.dump_metadata;
     if (enabled) {
         mm_camera_buf_def_t *pMetaFrame = NULL;
         QCameraStream *pStream = NULL;
@@ -259,8 +259,7 @@ void QCamera2HardwareInterface::zsl_channel_cb(mm_camera_super_buf_t *recvd_fram
         }
     }
 
-    property_get("persist.camera.zsl_matching", value, "0");
-    log_matching = atoi(value) > 0 ? true : false;
+    log_matching = debugConfig.zsl_matching;
     if (log_matching) {
         LOGH("ZSL super buffer contains:");
         QCameraStream *pStream = NULL;
@@ -393,7 +392,8 @@ void QCamera2HardwareInterface::capture_channel_cb_routine(mm_camera_super_buf_t
                                                            void *userdata)
 {
     KPI_ATRACE_CALL();
-    char value[PROPERTY_VALUE_MAX];
+    const qcamera_debug_config_t debugConfig =
+            QCameraDebugConfig::getInstance().get();
     LOGH("[KPI Perf]: E PROFILE_YUV_CB_TO_HAL");
     bool dump_yuv = false;
     QCamera2HardwareInterface *pme = (QCamera2HardwareInterface *)userdata;
@@ -422,8 +422,7 @@ void QCamera2HardwareInterface::capture_channel_cb_routine(mm_camera_super_buf_t
     *frame = *recvd_frame;
 
     // DUMP YUV before reprocess if needed
-    property_get("persist.camera.nonzsl.yuv", value, "0");
-    dump_yuv = atoi(value) > 0 ? true : false;
+    dump_yuv = debugConfig.nonzsl_yuv;
     if ( dump_yuv ) {
         for ( uint32_t i= 0 ; i < recvd_frame->num_bufs ; i++ ) {
             if ( recvd_frame->bufs[i]->stream_type == CAM_STREAM_TYPE_SNAPSHOT ) {
@@ -437,8 +436,7 @@ void QCamera2HardwareInterface::capture_channel_cb_routine(mm_camera_super_buf_t
         }
     }
 
-    property_get("persist.camera.dumpmetadata", value, "0");
-    int32_t enabled = atoi(value);
+    int32_t enabled = (int32_t) debugConfig.dump_metadata;
     if (enabled) {
         mm_camera_buf_def_t *pMetaFrame = NULL;
         QCameraStream *pStream = NULL;
@@ -720,6 +718,9 @@ void QCamera2HardwareInterface::synchronous_stream_cb_routine(
         LOGE("This is only for PREVIEW stream for now");
         return;
     }
+    pme->m_kpiRing.record(QCAMERA_KPI_SOF, frame->frame_idx, 0,
+            nsecs_t(frame->ts.tv_sec) * 1000000000LL + frame->ts.tv_nsec);
+    pme->m_kpiRing.record(QCAMERA_KPI_BUF_DONE, frame->frame_idx);
 
     if (!pme->needProcessPreviewFrame()) {
         LOGE("preview is not running, no need to process");
@@ -747,6 +748,7 @@ void QCamera2HardwareInterface::synchronous_stream_cb_routine(
     err = memory->enqueueBuffer(idx, mPreviewTimestamp);
 
     if (err == NO_ERROR) {
+        pme->m_kpiRing.mapBuffer(idx, frame->frame_idx);
         pthread_mutex_lock(&pme->mGrallocLock);
         pme->mEnqueuedBuffers++;
         pthread_mutex_unlock(&pme->mGrallocLock);
@@ -783,6 +785,7 @@ void QCamera2HardwareInterface::preview_stream_cb_routine(mm_camera_super_buf_t
 {
     KPI_ATRACE_CALL();
     LOGH("[KPI Perf] : BEGIN");
+    nsecs_t cbStart = systemTime();
     int err = NO_ERROR;
     QCamera2HardwareInterface *pme = (QCamera2HardwareInterface *)userdata;
     QCameraGrallocMemory *memory = (QCameraGrallocMemory *)super_frame->bufs[0]->mem_info;
@@ -805,6 +808,7 @@ void QCamera2HardwareInterface::preview_stream_cb_routine(mm_camera_super_buf_t
         free(super_frame);
         return;
     }
+    pme->m_kpiRing.record(QCAMERA_KPI_HAL_CB, frame->frame_idx, frame->buf_idx);
 #ifdef TARGET_TS_MAKEUP
     pme->TsMakeupProcess_Preview(frame,stream);
 #endif
@@ -819,6 +823,7 @@ void QCamera2HardwareInterface::preview_stream_cb_routine(mm_camera_super_buf_t
         pme->debugShowPreviewFPS();
     }
 
+    bool sendPreviewCb = pme->syncPreviewFrame(frame);
     uint32_t idx = frame->buf_idx;
 
     pme->dumpFrameToFile(stream, frame, QCAMERA_DUMP_FRM_PREVIEW);
@@ -843,6 +848,7 @@ void QCamera2HardwareInterface::preview_stream_cb_routine(mm_camera_super_buf_t
                    dequeuedIdx);
             break;
         } else {
+            pme->m_kpiRing.recordBuffer(QCAMERA_KPI_FW_RETURN, (uint32_t)dequeuedIdx);
             pthread_mutex_lock(&pme->mGrallocLock);
             pme->mEnqueuedBuffers--;
             pthread_mutex_unlock(&pme->mGrallocLock);
@@ -873,7 +879,7 @@ void QCamera2HardwareInterface::preview_stream_cb_routine(mm_camera_super_buf_t
     }
 
     // Handle preview data callback
-    if (pme->m_channels[QCAMERA_CH_TYPE_CALLBACK] == NULL) {
+    if (sendPreviewCb && pme->m_channels[QCAMERA_CH_TYPE_CALLBACK] == NULL) {
         if (pme->mDataCb != NULL &&
                 (pme->msgTypeEnabledWithLock(CAMERA_MSG_PREVIEW_FRAME) > 0) &&
                 (!pme->mParameters.isSceneSelectionEnabled())) {
@@ -884,6 +890,10 @@ void QCamera2HardwareInterface::preview_stream_cb_routine(mm_camera_super_buf_t
         }
     }
 
+    pme->m_perfLock.governorReport(
+            nsecs_t(frame->ts.tv_sec) * 1000000000LL + frame->ts.tv_nsec,
+            systemTime() - cbStart);
+
     free(super_frame);
     LOGH("[KPI Perf] : END");
     return;
@@ -926,11 +936,7 @@ int32_t QCamera2HardwareInterface::sendPreviewCallback(QCameraStream *stream,
     int32_t uvStrideToApp = 0;
     int32_t yScanlineToApp = 0;
     int32_t uvScanlineToApp = 0;
-    int32_t srcOffset = 0;
-    int32_t dstOffset = 0;
-    int32_t srcBaseOffset = 0;
-    int32_t dstBaseOffset = 0;
-    int i;
+    size_t bytesCopied = 0;
 
     if ((NULL == stream) || (NULL == memory)) {
         LOGE("Invalid preview callback input");
@@ -986,9 +992,9 @@ int32_t QCamera2HardwareInterface::sendPreviewCallback(QCameraStream *stream,
                     ((yStride * yScanline) + (uvStride * uvScanline));
         }
         if(previewBufSize == previewBufSizeFromCallback) {
-            previewMem = mGetMemory(memory->getFd(idx),
-                       previewBufSize, 1, mCallbackCookie);
-            if (!previewMem || !previewMem->data) {
+            previewMem = m_previewCbPool.getStreamMemory(memory, idx,
+                    previewBufSize);
+            if (!previewMem) {
                 LOGE("mGetMemory failed.\n");
                 return NO_MEMORY;
             } else {
@@ -996,32 +1002,26 @@ int32_t QCamera2HardwareInterface::sendPreviewCallback(QCameraStream *stream,
             }
         } else {
             data = memory->getMemory(idx, false);
-            dataToApp = mGetMemory(-1, previewBufSize, 1, mCallbackCookie);
-            if (!dataToApp || !dataToApp->data) {
+            if (!data || !data->data) {
+                LOGE("Invalid preview buffer %d", idx);
+                return BAD_VALUE;
+            }
+            dataToApp = m_previewCbPool.getRepackMemory(previewBufSize);
+            if (!dataToApp) {
                 LOGE("mGetMemory failed.\n");
                 return NO_MEMORY;
             }
 
-            for (i = 0; i < preview_dim.height; i++) {
-                srcOffset = i * yStride;
-                dstOffset = i * yStrideToApp;
-
-                memcpy((unsigned char *) dataToApp->data + dstOffset,
-                        (unsigned char *) data->data + srcOffset,
-                        (size_t)yStrideToApp);
-            }
-
-            srcBaseOffset = yStride * yScanline;
-            dstBaseOffset = yStrideToApp * yScanlineToApp;
-
-            for (i = 0; i < preview_dim.height/2; i++) {
-                srcOffset = i * uvStride + srcBaseOffset;
-                dstOffset = i * uvStrideToApp + dstBaseOffset;
+            uint8_t *src = (uint8_t *)data->data;
+            uint8_t *dst = (uint8_t *)dataToApp->data;
 
-                memcpy((unsigned char *) dataToApp->data + dstOffset,
-                        (unsigned char *) data->data + srcOffset,
-                        (size_t)yStrideToApp);
-            }
+            bytesCopied += QCameraPreviewCbPool::repackPlane(dst,
+                    (size_t)yStrideToApp, src, (size_t)yStride,
+                    (size_t)yStrideToApp, (size_t)preview_dim.height);
+            bytesCopied += QCameraPreviewCbPool::repackPlane(
+                    dst + yStrideToApp * yScanlineToApp, (size_t)uvStrideToApp,
+                    src + yStride * yScanline, (size_t)uvStride,
+                    (size_t)yStrideToApp, (size_t)(preview_dim.height / 2));
         }
     } else {
         /*Invalid Buffer content. But can be used as a first preview frame trigger in
@@ -1032,12 +1032,14 @@ int32_t QCamera2HardwareInterface::sendPreviewCallback(QCameraStream *stream,
         previewBufSizeFromCallback = 0;
         LOGW("Invalid preview format. Buffer content cannot be processed size = %d",
                 previewBufSize);
-        dataToApp = mGetMemory(-1, previewBufSize, 1, mCallbackCookie);
-        if (!dataToApp || !dataToApp->data) {
+        dataToApp = m_previewCbPool.getRepackMemory(previewBufSize);
+        if (!dataToApp) {
             LOGE("mGetMemory failed.\n");
             return NO_MEMORY;
         }
     }
+    m_previewCbPool.addBytes(bytesCopied, previewMem ? previewBufSize : 0);
+
     qcamera_callback_argm_t cbArg;
     memset(&cbArg, 0, sizeof(qcamera_callback_argm_t));
     cbArg.cb_type = QCAMERA_DATA_CALLBACK;
@@ -1050,19 +1052,19 @@ int32_t QCamera2HardwareInterface::sendPreviewCallback(QCameraStream *stream,
     }
     if ( previewMem ) {
         cbArg.user_data = previewMem;
-        cbArg.release_cb = releaseCameraMemory;
+        cbArg.release_cb = returnPreviewCbMemory;
     } else if (dataToApp) {
         cbArg.user_data = dataToApp;
-        cbArg.release_cb = releaseCameraMemory;
+        cbArg.release_cb = returnPreviewCbMemory;
     }
     cbArg.cookie = this;
     rc = m_cbNotifier.notifyCallback(cbArg);
     if (rc != NO_ERROR) {
         LOGW("fail sending notification");
         if (previewMem) {
-            previewMem->release(previewMem);
+            m_previewCbPool.putMemory(previewMem);
         } else if (dataToApp) {
-            dataToApp->release(dataToApp);
+            m_previewCbPool.putMemory(dataToApp);
         }
     }
 
@@ -1119,6 +1121,7 @@ void QCamera2HardwareInterface::nodisplay_preview_stream_cb_routine(
         pme->debugShowPreviewFPS();
     }
 
+    bool sendPreviewCb = pme->syncPreviewFrame(frame);
     QCameraMemory *previewMemObj = (QCameraMemory *)frame->mem_info;
     camera_memory_t *preview_mem = NULL;
     if (previewMemObj != NULL) {
@@ -1127,7 +1130,7 @@ void QCamera2HardwareInterface::nodisplay_preview_stream_cb_routine(
     if (NULL != previewMemObj && NULL != preview_mem) {
         pme->dumpFrameToFile(stream, frame, QCAMERA_DUMP_FRM_PREVIEW);
 
-        if ((pme->needProcessPreviewFrame()) &&
+        if (sendPreviewCb && (pme->needProcessPreviewFrame()) &&
                 (pme->mDataCb != NULL) &&
                 (pme->msgTypeEnabledWithLock(
                 CAMERA_MSG_PREVIEW_FRAME) > 0)) {
@@ -1563,7 +1566,8 @@ void QCamera2HardwareInterface::snapshot_channel_cb_routine(mm_camera_super_buf_
        void *userdata)
 {
     ATRACE_CALL();
-    char value[PROPERTY_VALUE_MAX];
+    const qcamera_debug_config_t debugConfig =
+            QCameraDebugConfig::getInstance().get();
 
     LOGH("[KPI Perf]: E");
     QCamera2HardwareInterface *pme = (QCamera2HardwareInterface *)userdata;
@@ -1582,8 +1586,7 @@ void QCamera2HardwareInterface::snapshot_channel_cb_routine(mm_camera_super_buf_
         return;
     }
 
-    property_get("persist.camera.dumpmetadata", value, "0");
-    int32_t enabled = atoi(value);
+    int32_t enabled = (int32_t) debugConfig.dump_metadata;
     if (enabled) {
         if (pChannel == NULL ||
             pChannel->getMyHandle() != super_frame->ch_id) {
@@ -1690,7 +1693,8 @@ void QCamera2HardwareInterface::preview_raw_stream_cb_routine(mm_camera_super_bu
 {
     ATRACE_CALL();
     LOGH("[KPI Perf] : BEGIN");
-    char value[PROPERTY_VALUE_MAX];
+    const qcamera_debug_config_t debugConfig =
+            QCameraDebugConfig::getInstance().get();
     bool dump_preview_raw = false, dump_video_raw = false;
 
     QCamera2HardwareInterface *pme = (QCamera2HardwareInterface *)userdata;
@@ -1706,10 +1710,8 @@ void QCamera2HardwareInterface::preview_raw_stream_cb_routine(mm_camera_super_bu
     mm_camera_buf_def_t *raw_frame = super_frame->bufs[0];
 
     if (raw_frame != NULL) {
-        property_get("persist.camera.preview_raw", value, "0");
-        dump_preview_raw = atoi(value) > 0 ? true : false;
-        property_get("persist.camera.video_raw", value, "0");
-        dump_video_raw = atoi(value) > 0 ? true : false;
+        dump_preview_raw = debugConfig.preview_raw;
+        dump_video_raw = debugConfig.video_raw;
         if (dump_preview_raw || (pme->mParameters.getRecordingHintValue()
                 && dump_video_raw)) {
             pme->dumpFrameToFile(stream, raw_frame, QCAMERA_DUMP_FRM_RAW);
@@ -1742,7 +1744,8 @@ void QCamera2HardwareInterface::snapshot_raw_stream_cb_routine(mm_camera_super_b
 {
     ATRACE_CALL();
     LOGH("[KPI Perf] : BEGIN");
-    char value[PROPERTY_VALUE_MAX];
+    const qcamera_debug_config_t debugConfig =
+            QCameraDebugConfig::getInstance().get();
     bool dump_raw = false;
 
     QCamera2HardwareInterface *pme = (QCamera2HardwareInterface *)userdata;
@@ -1755,8 +1758,7 @@ void QCamera2HardwareInterface::snapshot_raw_stream_cb_routine(mm_camera_super_b
         return;
     }
 
-    property_get("persist.camera.snapshot_raw", value, "0");
-    dump_raw = atoi(value) > 0 ? true : false;
+    dump_raw = debugConfig.snapshot_raw;
 
     for (uint32_t i = 0; i < super_frame->num_bufs; i++) {
         if (super_frame->bufs[i]->stream_type == CAM_STREAM_TYPE_RAW) {
@@ -2369,9 +2371,7 @@ void QCamera2HardwareInterface::callback_stream_cb_routine(mm_camera_super_buf_t
 void QCamera2HardwareInterface::dumpJpegToFile(const void *data,
         size_t size, uint32_t index)
 {
-    char value[PROPERTY_VALUE_MAX];
-    property_get("persist.camera.dumpimg", value, "0");
-    uint32_t enabled = (uint32_t) atoi(value);
+    uint32_t enabled = QCameraDebugConfig::getInstance().get().dump_img;
     uint32_t frm_num = 0;
     uint32_t skip_mode = 0;
 
@@ -2405,17 +2405,22 @@ void QCamera2HardwareInterface::dumpJpegToFile(const void *data,
                 if (true == m_bIntJpegEvtPending) {
                     strlcpy(m_BackendFileName, buf, QCAMERA_MAX_FILEPATH_LENGTH);
                     mBackendFileSize = size;
-                }
 
-                int file_fd = open(buf, O_RDWR | O_CREAT, 0777);
-                if (file_fd >= 0) {
-                    ssize_t written_len = write(file_fd, data, size);
-                    fchmod(file_fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-                    LOGH("written number of bytes %zd\n",
-                             written_len);
-                    close(file_fd);
+                    // The backend reads the file once the event is sent,
+                    // so this one is written synchronously.
+                    int file_fd = open(buf, O_RDWR | O_CREAT, 0777);
+                    if (file_fd >= 0) {
+                        ssize_t written_len = write(file_fd, data, size);
+                        fchmod(file_fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                        LOGH("written number of bytes %zd\n",
+                                 written_len);
+                        close(file_fd);
+                    } else {
+                        LOGE("fail to open file for image dumping");
+                    }
                 } else {
-                    LOGE("fail to open file for image dumping");
+                    struct iovec iov = { (void *)data, size };
+                    QCameraDumpWriter::getInstance().dumpData(buf, &iov, 1);
                 }
                 if (false == m_bIntJpegEvtPending) {
                     mDumpFrmCnt++;
@@ -2430,11 +2435,9 @@ void QCamera2HardwareInterface::dumpJpegToFile(const void *data,
 void QCamera2HardwareInterface::dumpMetadataToFile(QCameraStream *stream,
                                                    mm_camera_buf_def_t *frame,char *type)
 {
-    char value[PROPERTY_VALUE_MAX];
     uint32_t frm_num = 0;
     metadata_buffer_t *metadata = (metadata_buffer_t *)frame->buffer;
-    property_get("persist.camera.dumpmetadata", value, "0");
-    uint32_t enabled = (uint32_t) atoi(value);
+    uint32_t enabled = QCameraDebugConfig::getInstance().get().dump_metadata;
     if (stream == NULL) {
         LOGH("No op");
         return;
@@ -2455,58 +2458,33 @@ void QCamera2HardwareInterface::dumpMetadataToFile(QCameraStream *stream,
         }
         LOGH("dumpFrmCnt= %u, frm_num = %u", dumpFrmCnt, frm_num);
         if (dumpFrmCnt < frm_num) {
-            char timeBuf[128];
+            char filePath[QCAMERA_DUMP_PATH_MAX];
             char buf[32];
             memset(buf, 0, sizeof(buf));
-            memset(timeBuf, 0, sizeof(timeBuf));
-            time_t current_time;
-            struct tm * timeinfo;
-            time (&current_time);
-            timeinfo = localtime (&current_time);
-            if (NULL != timeinfo) {
-                strftime(timeBuf, sizeof(timeBuf),
-                        QCAMERA_DUMP_FRM_LOCATION "%Y%m%d%H%M%S", timeinfo);
-            }
-            String8 filePath(timeBuf);
             snprintf(buf, sizeof(buf), "%um_%s_%d.bin", dumpFrmCnt, type, frame->frame_idx);
-            filePath.append(buf);
-            int file_fd = open(filePath.string(), O_RDWR | O_CREAT, 0777);
-            if (file_fd >= 0) {
-                ssize_t written_len = 0;
-                metadata->tuning_params.tuning_data_version = TUNING_DATA_VERSION;
-                void *data = (void *)((uint8_t *)&metadata->tuning_params.tuning_data_version);
-                written_len += write(file_fd, data, sizeof(uint32_t));
-                data = (void *)((uint8_t *)&metadata->tuning_params.tuning_sensor_data_size);
-                LOGH("tuning_sensor_data_size %d",(int)(*(int *)data));
-                written_len += write(file_fd, data, sizeof(uint32_t));
-                data = (void *)((uint8_t *)&metadata->tuning_params.tuning_vfe_data_size);
-                LOGH("tuning_vfe_data_size %d",(int)(*(int *)data));
-                written_len += write(file_fd, data, sizeof(uint32_t));
-                data = (void *)((uint8_t *)&metadata->tuning_params.tuning_cpp_data_size);
-                LOGH("tuning_cpp_data_size %d",(int)(*(int *)data));
-                written_len += write(file_fd, data, sizeof(uint32_t));
-                data = (void *)((uint8_t *)&metadata->tuning_params.tuning_cac_data_size);
-                LOGH("tuning_cac_data_size %d",(int)(*(int *)data));
-                written_len += write(file_fd, data, sizeof(uint32_t));
-                data = (void *)((uint8_t *)&metadata->tuning_params.tuning_cac_data_size2);
-                LOGH("< skrajago >tuning_cac_data_size %d",(int)(*(int *)data));
-                written_len += write(file_fd, data, sizeof(uint32_t));
-                size_t total_size = metadata->tuning_params.tuning_sensor_data_size;
-                data = (void *)((uint8_t *)&metadata->tuning_params.data);
-                written_len += write(file_fd, data, total_size);
-                total_size = metadata->tuning_params.tuning_vfe_data_size;
-                data = (void *)((uint8_t *)&metadata->tuning_params.data[TUNING_VFE_DATA_OFFSET]);
-                written_len += write(file_fd, data, total_size);
-                total_size = metadata->tuning_params.tuning_cpp_data_size;
-                data = (void *)((uint8_t *)&metadata->tuning_params.data[TUNING_CPP_DATA_OFFSET]);
-                written_len += write(file_fd, data, total_size);
-                total_size = metadata->tuning_params.tuning_cac_data_size;
-                data = (void *)((uint8_t *)&metadata->tuning_params.data[TUNING_CAC_DATA_OFFSET]);
-                written_len += write(file_fd, data, total_size);
-                close(file_fd);
-            }else {
-                LOGE("fail t open file for image dumping");
-            }
+            QCameraDumpWriter::getInstance().makePath(filePath, sizeof(filePath), buf);
+
+            tuning_params_t *tuning = &metadata->tuning_params;
+            tuning->tuning_data_version = TUNING_DATA_VERSION;
+            LOGH("tuning_sensor_data_size %d", (int)tuning->tuning_sensor_data_size);
+            LOGH("tuning_vfe_data_size %d", (int)tuning->tuning_vfe_data_size);
+            LOGH("tuning_cpp_data_size %d", (int)tuning->tuning_cpp_data_size);
+            LOGH("tuning_cac_data_size %d", (int)tuning->tuning_cac_data_size);
+            LOGH("< skrajago >tuning_cac_data_size %d", (int)tuning->tuning_cac_data_size2);
+            struct iovec iov[] = {
+                { &tuning->tuning_data_version, sizeof(uint32_t) },
+                { &tuning->tuning_sensor_data_size, sizeof(uint32_t) },
+                { &tuning->tuning_vfe_data_size, sizeof(uint32_t) },
+                { &tuning->tuning_cpp_data_size, sizeof(uint32_t) },
+                { &tuning->tuning_cac_data_size, sizeof(uint32_t) },
+                { &tuning->tuning_cac_data_size2, sizeof(uint32_t) },
+                { &tuning->data[0], tuning->tuning_sensor_data_size },
+                { &tuning->data[TUNING_VFE_DATA_OFFSET], tuning->tuning_vfe_data_size },
+                { &tuning->data[TUNING_CPP_DATA_OFFSET], tuning->tuning_cpp_data_size },
+                { &tuning->data[TUNING_CAC_DATA_OFFSET], tuning->tuning_cac_data_size },
+            };
+            QCameraDumpWriter::getInstance().dumpData(filePath, iov,
+                    (int)(sizeof(iov) / sizeof(iov[0])));
             dumpFrmCnt++;
         }
     }
@@ -2530,9 +2508,7 @@ void QCamera2HardwareInterface::dumpMetadataToFile(QCameraStream *stream,
 void QCamera2HardwareInterface::dumpFrameToFile(QCameraStream *stream,
         mm_camera_buf_def_t *frame, uint32_t dump_type)
 {
-    char value[PROPERTY_VALUE_MAX];
-    property_get("persist.camera.dumpimg", value, "0");
-    uint32_t enabled = (uint32_t) atoi(value);
+    uint32_t enabled = QCameraDebugConfig::getInstance().get().dump_img;
     uint32_t frm_num = 0;
     uint32_t skip_mode = 0;
 
@@ -2570,14 +2546,7 @@ void QCamera2HardwareInterface::dumpFrameToFile(QCameraStream *stream,
                 }
                 if (dumpFrmCnt <= frm_num) {
                     char buf[32];
-                    char timeBuf[128];
-                    time_t current_time;
-                    struct tm * timeinfo;
-
-                    memset(timeBuf, 0, sizeof(timeBuf));
-
-                    time (&current_time);
-                    timeinfo = localtime (&current_time);
+                    char filePath[QCAMERA_DUMP_PATH_MAX];
                     memset(buf, 0, sizeof(buf));
 
                     cam_dimension_t dim;
@@ -2588,11 +2557,6 @@ void QCamera2HardwareInterface::dumpFrameToFile(QCameraStream *stream,
                     memset(&offset, 0, sizeof(cam_frame_len_offset_t));
                     stream->getFrameOffset(offset);
 
-                    if (NULL != timeinfo) {
-                        strftime(timeBuf, sizeof(timeBuf),
-                                QCAMERA_DUMP_FRM_LOCATION "%Y%m%d%H%M%S", timeinfo);
-                    }
-                    String8 filePath(timeBuf);
                     switch (dump_type) {
                     case QCAMERA_DUMP_FRM_PREVIEW:
                         {
@@ -2643,34 +2607,42 @@ void QCamera2HardwareInterface::dumpFrameToFile(QCameraStream *stream,
                         return;
                     }
 
-                    filePath.append(buf);
-                    int file_fd = open(filePath.string(), O_RDWR | O_CREAT, 0777);
+                    QCameraDumpWriter::getInstance().makePath(filePath,
+                            sizeof(filePath), buf);
                     ssize_t written_len = 0;
-                    if (file_fd >= 0) {
-                        void *data = NULL;
-
-                        fchmod(file_fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-                        for (uint32_t i = 0; i < offset.num_planes; i++) {
-                            uint32_t index = offset.mp[i].offset;
-                            if (i > 0) {
-                                index += offset.mp[i-1].len;
-                            }
-                            for (int j = 0; j < offset.mp[i].height; j++) {
-                                data = (void *)((uint8_t *)frame->buffer + index);
-                                written_len += write(file_fd, data,
-                                        (size_t)offset.mp[i].width);
-                                index += (uint32_t)offset.mp[i].stride;
+                    if (true == m_bIntRawEvtPending) {
+                        // The backend reads the file once the event is sent,
+                        // so this one is written synchronously.
+                        int file_fd = open(filePath, O_RDWR | O_CREAT, 0777);
+                        if (file_fd >= 0) {
+                            void *data = NULL;
+
+                            fchmod(file_fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                            for (uint32_t i = 0; i < offset.num_planes; i++) {
+                                uint32_t index = offset.mp[i].offset;
+                                if (i > 0) {
+                                    index += offset.mp[i-1].len;
+                                }
+                                for (int j = 0; j < offset.mp[i].height; j++) {
+                                    data = (void *)((uint8_t *)frame->buffer + index);
+                                    written_len += write(file_fd, data,
+                                            (size_t)offset.mp[i].width);
+                                    index += (uint32_t)offset.mp[i].stride;
+                                }
                             }
-                        }
 
-                        LOGH("written number of bytes %ld\n",
-                             written_len);
-                        close(file_fd);
+                            LOGH("written number of bytes %ld\n",
+                                 written_len);
+                            close(file_fd);
+                        } else {
+                            LOGE("fail to open file for image dumping");
+                        }
                     } else {
-                        LOGE("fail to open file for image dumping");
+                        QCameraDumpWriter::getInstance().dumpFrame(filePath,
+                                (uint8_t *)frame->buffer, offset);
                     }
                     if (true == m_bIntRawEvtPending) {
-                        strlcpy(m_BackendFileName, filePath.string(), QCAMERA_MAX_FILEPATH_LENGTH);
+                        strlcpy(m_BackendFileName, filePath, QCAMERA_MAX_FILEPATH_LENGTH);
                         mBackendFileSize = (size_t)written_len;
                     } else {
                         dumpFrmCnt++;
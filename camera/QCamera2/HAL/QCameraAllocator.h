@@ -42,6 +42,8 @@ class QCameraHeapMemory;
 typedef struct {
     int32_t (*bgFunction) (void *);
     void* bgArgs;
+    // task which has to complete before this one runs, 0 if none
+    uint32_t dependsOn;
 } BackgroundTask;
 
 class QCameraAllocator {
@@ -728,6 +728,359 @@ int QCameraMemoryPool::allocateBuffer(
     return rc;
 }
 
+/*===========================================================================
+ * FUNCTION   : QCameraPreviewCbPool
+ *
+ * DESCRIPTION: constructor of QCameraPreviewCbPool
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+QCameraPreviewCbPool::QCameraPreviewCbPool()
+    : mGetMemory(NULL),
+      mCallbackCookie(NULL),
+      mBytesCopied(0),
+      mBytesPassed(0)
+{
+    memset(mStreamMem, 0, sizeof(mStreamMem));
+    pthread_mutex_init(&mLock, NULL);
+}
+
+/*===========================================================================
+ * FUNCTION   : ~QCameraPreviewCbPool
+ *
+ * DESCRIPTION: deconstructor of QCameraPreviewCbPool
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+QCameraPreviewCbPool::~QCameraPreviewCbPool()
+{
+    clear();
+
+    // No callback can be pending anymore, drop what is left
+    List<QCameraPreviewCbMem>::iterator it = mRetiredMem.begin();
+    for (; it != mRetiredMem.end(); it++) {
+        (*it).mem->release((*it).mem);
+    }
+    mRetiredMem.clear();
+
+    pthread_mutex_destroy(&mLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : setCallbacks
+ *
+ * DESCRIPTION: set the app memory allocator used for new pool entries.
+ *              Entries created with a previous allocator are dropped.
+ *
+ * PARAMETERS :
+ *   @getMemory : app memory allocator
+ *   @cbCookie  : app callback cookie
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraPreviewCbPool::setCallbacks(camera_request_memory getMemory,
+        void *cbCookie)
+{
+    clear();
+
+    pthread_mutex_lock(&mLock);
+    mGetMemory = getMemory;
+    mCallbackCookie = cbCookie;
+    pthread_mutex_unlock(&mLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : retireLocked
+ *
+ * DESCRIPTION: drop one entry from the pool. Entries still referenced by
+ *              a pending callback are released once it returns them.
+ *
+ * PARAMETERS :
+ *   @entry   : pool entry
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraPreviewCbPool::retireLocked(QCameraPreviewCbMem &entry)
+{
+    if (NULL == entry.mem) {
+        return;
+    }
+
+    if (0 == entry.refs) {
+        entry.mem->release(entry.mem);
+    } else {
+        mRetiredMem.push_back(entry);
+    }
+    memset(&entry, 0, sizeof(entry));
+}
+
+/*===========================================================================
+ * FUNCTION   : getStreamMemory
+ *
+ * DESCRIPTION: get the app memory wrapping one stream buffer. The wrapper
+ *              is created on first use and kept until the stream buffer
+ *              changes or the pool is cleared.
+ *
+ * PARAMETERS :
+ *   @memory  : stream memory
+ *   @index   : buffer index
+ *   @size    : size to be passed to the app
+ *
+ * RETURN     : app memory, to be returned with putMemory
+ *              NULL on failure
+ *==========================================================================*/
+camera_memory_t *QCameraPreviewCbPool::getStreamMemory(
+        const QCameraMemory *memory, uint32_t index, size_t size)
+{
+    camera_memory_t *mem = NULL;
+
+    if ((NULL == memory) || (index >= MM_CAMERA_MAX_NUM_FRAMES)) {
+        LOGE("Invalid stream buffer %d", index);
+        return NULL;
+    }
+
+    int fd = memory->getFd(index);
+
+    pthread_mutex_lock(&mLock);
+
+    QCameraPreviewCbMem &entry = mStreamMem[index];
+    if ((NULL != entry.mem) &&
+            ((entry.owner != memory) || (entry.fd != fd) || (entry.size != size))) {
+        retireLocked(entry);
+    }
+
+    if ((NULL == entry.mem) && (NULL != mGetMemory)) {
+        mem = mGetMemory(fd, size, 1, mCallbackCookie);
+        if ((NULL != mem) && (NULL == mem->data)) {
+            mem->release(mem);
+            mem = NULL;
+        }
+        if (NULL != mem) {
+            entry.mem = mem;
+            entry.owner = memory;
+            entry.fd = fd;
+            entry.size = size;
+            entry.refs = 0;
+        }
+    }
+
+    if (NULL != entry.mem) {
+        entry.refs++;
+        mem = entry.mem;
+    }
+
+    pthread_mutex_unlock(&mLock);
+
+    return mem;
+}
+
+/*===========================================================================
+ * FUNCTION   : getRepackMemory
+ *
+ * DESCRIPTION: get an idle app buffer of the given size, allocating one
+ *              only when none can be recycled
+ *
+ * PARAMETERS :
+ *   @size    : size of the buffer
+ *
+ * RETURN     : app memory, to be returned with putMemory
+ *              NULL on failure
+ *==========================================================================*/
+camera_memory_t *QCameraPreviewCbPool::getRepackMemory(size_t size)
+{
+    camera_memory_t *mem = NULL;
+
+    pthread_mutex_lock(&mLock);
+
+    List<QCameraPreviewCbMem>::iterator it = mRepackMem.begin();
+    while (it != mRepackMem.end()) {
+        if ((*it).refs != 0) {
+            it++;
+        } else if ((*it).size != size) {
+            // Left over from a previous preview size
+            (*it).mem->release((*it).mem);
+            it = mRepackMem.erase(it);
+        } else {
+            (*it).refs = 1;
+            mem = (*it).mem;
+            break;
+        }
+    }
+
+    if ((NULL == mem) && (NULL != mGetMemory)) {
+        mem = mGetMemory(-1, size, 1, mCallbackCookie);
+        if ((NULL != mem) && (NULL == mem->data)) {
+            mem->release(mem);
+            mem = NULL;
+        }
+        if (NULL != mem) {
+            QCameraPreviewCbMem entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.mem = mem;
+            entry.fd = -1;
+            entry.size = size;
+            entry.refs = 1;
+            mRepackMem.push_back(entry);
+            LOGD("Allocated repack buffer %zu, %zu in pool",
+                    size, mRepackMem.size());
+        }
+    }
+
+    pthread_mutex_unlock(&mLock);
+
+    return mem;
+}
+
+/*===========================================================================
+ * FUNCTION   : putMemory
+ *
+ * DESCRIPTION: return app memory obtained from the pool once the callback
+ *              carrying it is done
+ *
+ * PARAMETERS :
+ *   @mem     : app memory
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraPreviewCbPool::putMemory(camera_memory_t *mem)
+{
+    bool found = false;
+
+    if (NULL == mem) {
+        return;
+    }
+
+    pthread_mutex_lock(&mLock);
+
+    for (int i = 0; !found && (i < MM_CAMERA_MAX_NUM_FRAMES); i++) {
+        if ((mStreamMem[i].mem == mem) && (mStreamMem[i].refs > 0)) {
+            mStreamMem[i].refs--;
+            found = true;
+        }
+    }
+
+    List<QCameraPreviewCbMem>::iterator it = mRepackMem.begin();
+    for (; !found && (it != mRepackMem.end()); it++) {
+        if (((*it).mem == mem) && ((*it).refs > 0)) {
+            (*it).refs--;
+            found = true;
+        }
+    }
+
+    for (it = mRetiredMem.begin(); !found && (it != mRetiredMem.end()); it++) {
+        if ((*it).mem == mem) {
+            found = true;
+            if (--(*it).refs == 0) {
+                mem->release(mem);
+                mRetiredMem.erase(it);
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&mLock);
+
+    if (!found) {
+        LOGW("Memory %p is not from the pool", mem);
+        mem->release(mem);
+    }
+}
+
+/*===========================================================================
+ * FUNCTION   : addBytes
+ *
+ * DESCRIPTION: account the data of one preview callback
+ *
+ * PARAMETERS :
+ *   @copied  : bytes repacked into an app buffer
+ *   @passed  : bytes passed to the app in the stream buffer
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraPreviewCbPool::addBytes(size_t copied, size_t passed)
+{
+    pthread_mutex_lock(&mLock);
+    mBytesCopied += copied;
+    mBytesPassed += passed;
+    pthread_mutex_unlock(&mLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : clear
+ *
+ * DESCRIPTION: drop all pool entries. Must be called before the stream
+ *              buffers are freed.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraPreviewCbPool::clear()
+{
+    pthread_mutex_lock(&mLock);
+
+    for (int i = 0; i < MM_CAMERA_MAX_NUM_FRAMES; i++) {
+        retireLocked(mStreamMem[i]);
+    }
+
+    List<QCameraPreviewCbMem>::iterator it = mRepackMem.begin();
+    for (; it != mRepackMem.end(); it++) {
+        retireLocked(*it);
+    }
+    mRepackMem.clear();
+
+    if ((mBytesCopied != 0) || (mBytesPassed != 0)) {
+        LOGI("[KPI Perf] preview callbacks: %llu bytes copied, %llu bytes passed through",
+                (unsigned long long)mBytesCopied, (unsigned long long)mBytesPassed);
+        mBytesCopied = 0;
+        mBytesPassed = 0;
+    }
+
+    pthread_mutex_unlock(&mLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : repackPlane
+ *
+ * DESCRIPTION: copy one image plane between buffers of different strides.
+ *              Planes of equal stride are copied in one go.
+ *
+ * PARAMETERS :
+ *   @dst       : destination plane
+ *   @dstStride : destination stride
+ *   @src       : source plane
+ *   @srcStride : source stride
+ *   @width     : bytes to copy per row
+ *   @rows      : number of rows
+ *
+ * RETURN     : number of bytes copied
+ *==========================================================================*/
+size_t QCameraPreviewCbPool::repackPlane(uint8_t *dst, size_t dstStride,
+        const uint8_t *src, size_t srcStride, size_t width, size_t rows)
+{
+    if (0 == rows) {
+        return 0;
+    }
+
+    if (dstStride == srcStride) {
+        size_t len = (rows - 1) * dstStride + width;
+        memcpy(dst, src, len);
+        return len;
+    }
+
+    for (size_t i = 0; i < rows; i++) {
+        memcpy(dst, src, width);
+        dst += dstStride;
+        src += srcStride;
+    }
+
+    return rows * width;
+}
+
 /*===========================================================================
  * FUNCTION   : QCameraHeapMemory
  *
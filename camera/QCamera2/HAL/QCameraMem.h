@@ -161,6 +161,51 @@ protected:
     pthread_mutex_t mLock;
 };
 
+// Recycles the camera_memory_t objects handed to the app with preview
+// frame callbacks. Stream buffers are wrapped once per buffer index and
+// repack buffers are reused across frames, so steady state preview
+// callbacks neither map nor allocate memory.
+class QCameraPreviewCbPool {
+
+public:
+
+    QCameraPreviewCbPool();
+    virtual ~QCameraPreviewCbPool();
+
+    void setCallbacks(camera_request_memory getMemory, void *cbCookie);
+    camera_memory_t *getStreamMemory(const QCameraMemory *memory,
+            uint32_t index, size_t size);
+    camera_memory_t *getRepackMemory(size_t size);
+    void putMemory(camera_memory_t *mem);
+    void addBytes(size_t copied, size_t passed);
+    void clear();
+
+    static size_t repackPlane(uint8_t *dst, size_t dstStride,
+            const uint8_t *src, size_t srcStride, size_t width, size_t rows);
+
+protected:
+
+    struct QCameraPreviewCbMem {
+        camera_memory_t *mem;
+        const QCameraMemory *owner;
+        int fd;
+        size_t size;
+        uint32_t refs;
+    };
+
+    void retireLocked(QCameraPreviewCbMem &entry);
+
+    camera_request_memory mGetMemory;
+    void *mCallbackCookie;
+    QCameraPreviewCbMem mStreamMem[MM_CAMERA_MAX_NUM_FRAMES];
+    android::List<QCameraPreviewCbMem> mRepackMem;
+    // Entries dropped from the pool while still held by a pending callback
+    android::List<QCameraPreviewCbMem> mRetiredMem;
+    uint64_t mBytesCopied;
+    uint64_t mBytesPassed;
+    pthread_mutex_t mLock;
+};
+
 // Internal heap memory is used for memories used internally
 // They are allocated from /dev/ion.
 class QCameraHeapMemory : public QCameraMemory {
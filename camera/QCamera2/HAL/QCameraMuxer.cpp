@@ -89,6 +89,21 @@ QCameraMuxer *gMuxer = NULL;
         return -ENODEV; \
     } \
 
+// Job of a physical camera open thread
+typedef struct {
+    QCamera2HardwareInterface *hwi;
+    cam_sync_related_sensors_event_info_t info;
+    hw_device_t *hw_dev;
+    int rc;
+} cam_phy_open_job_t;
+
+// Job of a per physical camera preview operation thread
+typedef struct {
+    qcamera_physical_descriptor_t *pCam;
+    int (*op)(struct camera_device *);
+    int rc;
+} cam_phy_preview_job_t;
+
 
 /*===========================================================================
  * FUNCTION         : getCameraMuxer
@@ -138,7 +153,9 @@ QCameraMuxer::QCameraMuxer(uint32_t num_of_cameras)
       m_pJpegCallbackCookie(NULL),
       m_bDumpImages(FALSE),
       m_bMpoEnabled(TRUE),
-      m_bFrameSyncEnabled(FALSE)
+      m_bFrameSyncEnabled(FALSE),
+      m_PreviewSyncSkew(0),
+      m_PreviewSyncLatency(0)
 {
     setupLogicalCameras();
     memset(&mJpegOps, 0, sizeof(mJpegOps));
@@ -148,6 +165,8 @@ QCameraMuxer::QCameraMuxer(uint32_t num_of_cameras)
 
     // initialize mutex for MPO composition
     pthread_mutex_init(&m_JpegLock, NULL);
+    pthread_mutex_init(&m_PreviewSyncLock, NULL);
+    resetPreviewSync();
     // launch MPO composition thread
     m_ComposeMpoTh.launch(composeMpoRoutine, this);
 
@@ -156,6 +175,14 @@ QCameraMuxer::QCameraMuxer(uint32_t num_of_cameras)
     property_get("persist.camera.dual.camera.dump", prop, "0");
     m_bDumpImages = atoi(prop);
     LOGH("dualCamera dump images:%d ", m_bDumpImages);
+
+    // Preview pairing tolerances
+    property_get("persist.camera.dc.sync.skew_ms", prop, "10");
+    m_PreviewSyncSkew = ms2ns(atoi(prop));
+    property_get("persist.camera.dc.sync.latency_ms", prop, "66");
+    m_PreviewSyncLatency = ms2ns(atoi(prop));
+    LOGH("dualCamera preview sync skew %lld latency %lld",
+            (long long)m_PreviewSyncSkew, (long long)m_PreviewSyncLatency);
 }
 
 /*===========================================================================
@@ -187,6 +214,7 @@ QCameraMuxer::~QCameraMuxer() {
     m_ComposeMpoTh.exit();
 
     pthread_mutex_destroy(&m_JpegLock);
+    pthread_mutex_destroy(&m_PreviewSyncLock);
 }
 
 /*===========================================================================
@@ -399,6 +427,11 @@ void QCameraMuxer::set_callBacks(struct camera_device * device,
         // delivering JPEGs
         hwi->setJpegCallBacks(jpeg_data_callback, (void*)pCam);
 
+        // Preview frames of related sessions are paired in the muxer
+        if (cam->numCameras > 1) {
+            hwi->setPreviewSyncCallBack(preview_sync_callback, (void*)pCam);
+        }
+
         if (pCam->mode == CAM_MODE_PRIMARY) {
             rc = gMuxer->setMainJpegCallbackCookie((void*)(pCam));
             if(rc != NO_ERROR) {
@@ -541,18 +574,10 @@ int QCameraMuxer::start_preview(struct camera_device * device)
     CHECK_CAMERA_ERROR(cam);
 
     // prepare preview first for all cameras
-    for (uint32_t i = 0; i < cam->numCameras; i++) {
-        pCam = gMuxer->getPhysicalCamera(cam, i);
-        CHECK_CAMERA_ERROR(pCam);
-
-        QCamera2HardwareInterface *hwi = pCam->hwi;
-        CHECK_HWI_ERROR(hwi);
-
-        rc = hwi->prepare_preview(pCam->dev);
-        if (rc != NO_ERROR) {
-            LOGE("Error preparing preview !! ");
-            return rc;
-        }
+    rc = gMuxer->runPreviewOp(cam, QCamera2HardwareInterface::prepare_preview);
+    if (rc != NO_ERROR) {
+        LOGE("Error preparing preview !! ");
+        return rc;
     }
 
     if (cam->numCameras > 1) {
@@ -601,17 +626,11 @@ int QCameraMuxer::start_preview(struct camera_device * device)
         cam->bSyncOn = true;
     }
     // Start Preview for all cameras
-    for (uint32_t i = 0; i < cam->numCameras; i++) {
-        pCam = gMuxer->getPhysicalCamera(cam, i);
-        CHECK_CAMERA_ERROR(pCam);
-
-        QCamera2HardwareInterface *hwi = pCam->hwi;
-        CHECK_HWI_ERROR(hwi);
-        rc = hwi->start_preview(pCam->dev);
-        if (rc != NO_ERROR) {
-            LOGE("Error starting preview !! ");
-            return rc;
-        }
+    gMuxer->resetPreviewSync();
+    rc = gMuxer->runPreviewOp(cam, QCamera2HardwareInterface::start_preview);
+    if (rc != NO_ERROR) {
+        LOGE("Error starting preview !! ");
+        return rc;
     }
     LOGH("X");
     return rc;
@@ -1344,6 +1363,9 @@ int QCameraMuxer::dump(struct camera_device * device, int fd)
             return rc;
         }
     }
+    if (cam->numCameras > 1) {
+        gMuxer->dumpPreviewSync(fd);
+    }
     LOGH("X");
     return rc;
 }
@@ -1814,35 +1836,66 @@ int QCameraMuxer::cameraDeviceOpen(int camera_id,
             return UNKNOWN_ERROR;
         }
 
-        // Open all physical cameras
+        // Open all physical cameras in parallel, sensor power up and
+        // session setup of one camera doesn't depend on the other
+        nsecs_t openStart = systemTime();
+        cam_phy_open_job_t jobs[MM_CAMERA_MAX_NUM_SENSORS];
+        pthread_t threads[MM_CAMERA_MAX_NUM_SENSORS];
+        bool launched[MM_CAMERA_MAX_NUM_SENSORS];
         for (uint32_t i = 0; i < cam->numCameras; i++) {
             phyId = cam->pId[i];
-            QCamera2HardwareInterface *hw =
-                    new QCamera2HardwareInterface((uint32_t)phyId);
-            if (!hw) {
+            memset(&jobs[i], 0, sizeof(jobs[i]));
+            launched[i] = false;
+            hw_dev[i] = NULL;
+
+            jobs[i].hwi = new QCamera2HardwareInterface((uint32_t)phyId);
+            if (!jobs[i].hwi) {
                 LOGE("Allocation of hardware interface failed");
-                return NO_MEMORY;
+                jobs[i].rc = NO_MEMORY;
+                continue;
             }
-            hw_dev[i] = NULL;
 
             // Make Camera HWI aware of its mode
-            cam_sync_related_sensors_event_info_t info;
-            info.sync_control = CAM_SYNC_RELATED_SENSORS_ON;
-            info.mode = m_pPhyCamera[phyId].mode;
-            info.type = m_pPhyCamera[phyId].type;
-            info.is_frame_sync_enabled = m_bFrameSyncEnabled;
-            rc = hw->setRelatedCamSyncInfo(&info);
-            if (rc != NO_ERROR) {
-                LOGE("setRelatedCamSyncInfo failed %d", rc);
-                delete hw;
-                return rc;
+            jobs[i].info.sync_control = CAM_SYNC_RELATED_SENSORS_ON;
+            jobs[i].info.mode = m_pPhyCamera[phyId].mode;
+            jobs[i].info.type = m_pPhyCamera[phyId].type;
+            jobs[i].info.is_frame_sync_enabled = m_bFrameSyncEnabled;
+
+            if (pthread_create(&threads[i], NULL, openPhysicalCameraRoutine,
+                    &jobs[i]) == 0) {
+                pthread_setname_np(threads[i], "CAM_muxOpen");
+                launched[i] = true;
+            } else {
+                // Fall back to opening in the caller context
+                openPhysicalCameraRoutine(&jobs[i]);
             }
+        }
 
-            rc = hw->openCamera(&hw_dev[i]);
-            if (rc != NO_ERROR) {
-                delete hw;
-                return rc;
+        for (uint32_t i = 0; i < cam->numCameras; i++) {
+            if (launched[i]) {
+                pthread_join(threads[i], NULL);
+            }
+            if (jobs[i].rc != NO_ERROR) {
+                LOGE("Opening camera id %d failed %d", cam->pId[i], jobs[i].rc);
+                rc = jobs[i].rc;
+            }
+        }
+
+        if (rc != NO_ERROR) {
+            // Release the cameras which did open
+            for (uint32_t i = 0; i < cam->numCameras; i++) {
+                if (jobs[i].rc == NO_ERROR) {
+                    QCamera2HardwareInterface::close_camera_device(
+                            jobs[i].hw_dev);
+                }
             }
+            return rc;
+        }
+
+        for (uint32_t i = 0; i < cam->numCameras; i++) {
+            phyId = cam->pId[i];
+            QCamera2HardwareInterface *hw = jobs[i].hwi;
+            hw_dev[i] = jobs[i].hw_dev;
             hw->getCameraSessionId(&m_pPhyCamera[phyId].camera_server_id);
             m_pPhyCamera[phyId].dev = reinterpret_cast<camera_device_t*>(hw_dev[i]);
             m_pPhyCamera[phyId].hwi = hw;
@@ -1850,6 +1903,8 @@ int QCameraMuxer::cameraDeviceOpen(int camera_id,
             LOGH("camera id %d server id : %d hw device %x, hw %x",
                      phyId, cam->sId[i], hw_dev[i], hw);
         }
+        LOGI("[KPI Perf] %d cameras opened in %lld ms", cam->numCameras,
+                (long long)ns2ms(systemTime() - openStart));
     } else {
         LOGE("Device version for camera id %d invalid %d",
                  camera_id, m_pLogicalCamera[camera_id].device_version);
@@ -1866,6 +1921,273 @@ int QCameraMuxer::cameraDeviceOpen(int camera_id,
 }
 
 
+/*===========================================================================
+ * FUNCTION   : openPhysicalCameraRoutine
+ *
+ * DESCRIPTION: thread routine opening one physical camera of a logical camera
+ *
+ * PARAMETERS :
+ *   @data    : ptr to cam_phy_open_job_t
+ *
+ * RETURN     : NULL
+ *==========================================================================*/
+void* QCameraMuxer::openPhysicalCameraRoutine(void* data)
+{
+    cam_phy_open_job_t *job = (cam_phy_open_job_t *)data;
+
+    job->rc = job->hwi->setRelatedCamSyncInfo(&job->info);
+    if (job->rc != NO_ERROR) {
+        LOGE("setRelatedCamSyncInfo failed %d", job->rc);
+        delete job->hwi;
+        job->hwi = NULL;
+        return NULL;
+    }
+
+    job->rc = job->hwi->openCamera(&job->hw_dev);
+    if (job->rc != NO_ERROR) {
+        delete job->hwi;
+        job->hwi = NULL;
+    }
+    return NULL;
+}
+
+/*===========================================================================
+ * FUNCTION   : previewOpRoutine
+ *
+ * DESCRIPTION: thread routine running a preview operation on one physical
+ *              camera
+ *
+ * PARAMETERS :
+ *   @data    : ptr to cam_phy_preview_job_t
+ *
+ * RETURN     : NULL
+ *==========================================================================*/
+void* QCameraMuxer::previewOpRoutine(void* data)
+{
+    cam_phy_preview_job_t *job = (cam_phy_preview_job_t *)data;
+    job->rc = job->op(job->pCam->dev);
+    return NULL;
+}
+
+/*===========================================================================
+ * FUNCTION   : runPreviewOp
+ *
+ * DESCRIPTION: runs a preview operation on all physical cameras of a logical
+ *              camera in parallel and waits for all of them to finish
+ *
+ * PARAMETERS :
+ *   @cam     : logical camera descriptor
+ *   @op      : HWI operation
+ *
+ * RETURN     : int32_t type of status
+ *              NO_ERROR  -- success
+ *              none-zero failure code of the first failing camera
+ *==========================================================================*/
+int QCameraMuxer::runPreviewOp(qcamera_logical_descriptor_t *cam,
+        int (*op)(struct camera_device *))
+{
+    int rc = NO_ERROR;
+    cam_phy_preview_job_t jobs[MM_CAMERA_MAX_NUM_SENSORS];
+    pthread_t threads[MM_CAMERA_MAX_NUM_SENSORS];
+    bool launched[MM_CAMERA_MAX_NUM_SENSORS];
+
+    for (uint32_t i = 0; i < cam->numCameras; i++) {
+        qcamera_physical_descriptor_t *pCam = getPhysicalCamera(cam, i);
+        CHECK_CAMERA_ERROR(pCam);
+        CHECK_HWI_ERROR(pCam->hwi);
+    }
+
+    for (uint32_t i = 0; i < cam->numCameras; i++) {
+        jobs[i].pCam = getPhysicalCamera(cam, i);
+        jobs[i].op = op;
+        jobs[i].rc = NO_ERROR;
+        launched[i] = false;
+
+        // The last camera runs in the caller context
+        if ((i + 1 < cam->numCameras) &&
+                (pthread_create(&threads[i], NULL, previewOpRoutine,
+                &jobs[i]) == 0)) {
+            pthread_setname_np(threads[i], "CAM_muxPrev");
+            launched[i] = true;
+        } else {
+            previewOpRoutine(&jobs[i]);
+        }
+    }
+
+    for (uint32_t i = 0; i < cam->numCameras; i++) {
+        if (launched[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        if ((jobs[i].rc != NO_ERROR) && (rc == NO_ERROR)) {
+            LOGE("camera id %d failed %d", cam->pId[i], jobs[i].rc);
+            rc = jobs[i].rc;
+        }
+    }
+    return rc;
+}
+
+/*===========================================================================
+ * FUNCTION   : preview_sync_callback
+ *
+ * DESCRIPTION: preview sync callback of the related cam instances. Frames
+ *              are paired by SOF time stamp; only the main session preview
+ *              is delivered so the app sees a single logical stream.
+ *
+ * PARAMETERS :
+ *   @timestamp : SOF time stamp of the frame
+ *   @frame_idx : frame id
+ *   @user      : physical camera descriptor of the session
+ *
+ * RETURN     : true if the preview data callback is to be sent
+ *==========================================================================*/
+bool QCameraMuxer::preview_sync_callback(nsecs_t timestamp,
+        uint32_t frame_idx, void *user)
+{
+    qcamera_physical_descriptor_t *pCam = (qcamera_physical_descriptor_t*)user;
+    if (!gMuxer || !pCam) {
+        return true;
+    }
+
+    gMuxer->matchPreviewFrame(pCam->mode, timestamp, frame_idx);
+    return (pCam->mode == CAM_MODE_PRIMARY);
+}
+
+/*===========================================================================
+ * FUNCTION   : matchPreviewFrame
+ *
+ * DESCRIPTION: pairs a preview frame with the closest unmatched frame of the
+ *              other session within the skew tolerance. Frames waiting longer
+ *              than the latency window are counted as unmatched drops.
+ *
+ * PARAMETERS :
+ *   @cam_mode  : indicates whether primary or secondary camera sent the frame
+ *   @timestamp : SOF time stamp of the frame
+ *   @frame_idx : frame id
+ *
+ * RETURN     : none
+ *==========================================================================*/
+void QCameraMuxer::matchPreviewFrame(cam_sync_mode_t cam_mode,
+        nsecs_t timestamp, uint32_t frame_idx)
+{
+    uint32_t self = (cam_mode == CAM_MODE_PRIMARY) ? 0 : 1;
+    uint32_t other = 1 - self;
+
+    pthread_mutex_lock(&m_PreviewSyncLock);
+
+    // Expire frames which waited past the latency window
+    for (uint32_t r = 0; r < 2; r++) {
+        cam_preview_sync_ring_t *ring = &m_PreviewSyncRing[r];
+        uint32_t expired = 0;
+        while ((expired < ring->count) &&
+                (timestamp - ring->ts[expired] > m_PreviewSyncLatency)) {
+            expired++;
+        }
+        if (expired) {
+            m_PreviewSyncStats.unmatched[r] += expired;
+            ring->count -= expired;
+            memmove(&ring->ts[0], &ring->ts[expired],
+                    ring->count * sizeof(ring->ts[0]));
+            memmove(&ring->frame_idx[0], &ring->frame_idx[expired],
+                    ring->count * sizeof(ring->frame_idx[0]));
+        }
+    }
+
+    // Closest partner within tolerance
+    cam_preview_sync_ring_t *ring = &m_PreviewSyncRing[other];
+    int32_t best = -1;
+    nsecs_t bestSkew = m_PreviewSyncSkew + 1;
+    for (uint32_t i = 0; i < ring->count; i++) {
+        nsecs_t skew = timestamp - ring->ts[i];
+        if (skew < 0) {
+            skew = -skew;
+        }
+        if (skew < bestSkew) {
+            bestSkew = skew;
+            best = (int32_t)i;
+        }
+    }
+
+    if (best >= 0) {
+        LOGD("paired frame %d with %d skew %lld", frame_idx,
+                ring->frame_idx[best], (long long)bestSkew);
+        m_PreviewSyncStats.matched++;
+        m_PreviewSyncStats.skewSum += bestSkew;
+        if (bestSkew > m_PreviewSyncStats.skewMax) {
+            m_PreviewSyncStats.skewMax = bestSkew;
+        }
+        // Older frames of the other session can no longer be paired
+        uint32_t consumed = (uint32_t)best + 1;
+        m_PreviewSyncStats.unmatched[other] += (uint32_t)best;
+        ring->count -= consumed;
+        memmove(&ring->ts[0], &ring->ts[consumed],
+                ring->count * sizeof(ring->ts[0]));
+        memmove(&ring->frame_idx[0], &ring->frame_idx[consumed],
+                ring->count * sizeof(ring->frame_idx[0]));
+    } else {
+        ring = &m_PreviewSyncRing[self];
+        if (ring->count == MUXER_PREVIEW_SYNC_DEPTH) {
+            m_PreviewSyncStats.unmatched[self]++;
+            ring->count--;
+            memmove(&ring->ts[0], &ring->ts[1],
+                    ring->count * sizeof(ring->ts[0]));
+            memmove(&ring->frame_idx[0], &ring->frame_idx[1],
+                    ring->count * sizeof(ring->frame_idx[0]));
+        }
+        ring->ts[ring->count] = timestamp;
+        ring->frame_idx[ring->count] = frame_idx;
+        ring->count++;
+    }
+
+    pthread_mutex_unlock(&m_PreviewSyncLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : resetPreviewSync
+ *
+ * DESCRIPTION: clears pending preview frames and pairing statistics
+ *
+ * PARAMETERS : none
+ *
+ * RETURN     : none
+ *==========================================================================*/
+void QCameraMuxer::resetPreviewSync()
+{
+    pthread_mutex_lock(&m_PreviewSyncLock);
+    memset(m_PreviewSyncRing, 0, sizeof(m_PreviewSyncRing));
+    memset(&m_PreviewSyncStats, 0, sizeof(m_PreviewSyncStats));
+    pthread_mutex_unlock(&m_PreviewSyncLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : dumpPreviewSync
+ *
+ * DESCRIPTION: dumps preview pairing statistics
+ *
+ * PARAMETERS :
+ *   @fd      : file descriptor to dump to
+ *
+ * RETURN     : none
+ *==========================================================================*/
+void QCameraMuxer::dumpPreviewSync(int fd)
+{
+    pthread_mutex_lock(&m_PreviewSyncLock);
+    cam_preview_sync_stats_t stats = m_PreviewSyncStats;
+    pthread_mutex_unlock(&m_PreviewSyncLock);
+
+    dprintf(fd, "\n Dual camera preview sync:\n");
+    dprintf(fd, "  skew tolerance %lld us, latency window %lld us\n",
+            (long long)ns2us(m_PreviewSyncSkew),
+            (long long)ns2us(m_PreviewSyncLatency));
+    dprintf(fd, "  matched %u, unmatched main %u aux %u\n",
+            stats.matched, stats.unmatched[0], stats.unmatched[1]);
+    if (stats.matched) {
+        dprintf(fd, "  skew avg %lld us, max %lld us\n",
+                (long long)ns2us(stats.skewSum / stats.matched),
+                (long long)ns2us(stats.skewMax));
+    }
+}
+
+
 /*===========================================================================
  * FUNCTION   : getLogicalCamera
  *
@@ -125,6 +125,36 @@ typedef struct {
     void *release_data;
 }cam_compose_jpeg_info_t;
 
+/* Struct@ cam_preview_sync_ring_t
+ *
+ *  Description@ This structure stores the SOF time stamps of preview frames
+ *  of one related camera session still waiting for a partner frame from the
+ *  other session. Entries are kept oldest first.
+ */
+#define MUXER_PREVIEW_SYNC_DEPTH 4
+typedef struct {
+    // SOF time stamps of the unmatched frames
+    nsecs_t ts[MUXER_PREVIEW_SYNC_DEPTH];
+    // frame ids of the unmatched frames
+    uint32_t frame_idx[MUXER_PREVIEW_SYNC_DEPTH];
+    // number of valid entries
+    uint32_t count;
+} cam_preview_sync_ring_t;
+
+/* Struct@ cam_preview_sync_stats_t
+ *
+ *  Description@ Preview frame pairing statistics of a dual camera session
+ */
+typedef struct {
+    // number of main/aux frame pairs
+    uint32_t matched;
+    // frames that found no partner within the latency window, main and aux
+    uint32_t unmatched[2];
+    // sum and maximum of the SOF skew of the matched pairs
+    nsecs_t skewSum;
+    nsecs_t skewMax;
+} cam_preview_sync_stats_t;
+
 /* Class@ QCameraMuxer
  *
  * Description@ Muxer interface
@@ -200,6 +230,11 @@ public:
     void composeMpo(cam_compose_jpeg_info_t* main_Jpeg,
         cam_compose_jpeg_info_t* aux_Jpeg);
     static void* composeMpoRoutine(void* data);
+    // pairs preview frames of the related cam instances by SOF time stamp
+    static bool preview_sync_callback(nsecs_t timestamp, uint32_t frame_idx,
+            void *user);
+    static void* openPhysicalCameraRoutine(void* data);
+    static void* previewOpRoutine(void* data);
     static bool matchFrameId(void *data, void *user_data, void *match_data);
     static bool findPreviousJpegs(void *data, void *user_data, void *match_data);
     static void releaseJpegInfo(void *data, void *user_data);
@@ -247,6 +282,15 @@ private:
     bool m_bMpoEnabled;
     // Signifies if frame sync is enabled
     bool m_bFrameSyncEnabled;
+    // Lock protecting the preview pairing rings and statistics
+    pthread_mutex_t m_PreviewSyncLock;
+    // unmatched preview frames of the main and aux sessions
+    cam_preview_sync_ring_t m_PreviewSyncRing[2];
+    cam_preview_sync_stats_t m_PreviewSyncStats;
+    // max SOF skew between paired preview frames
+    nsecs_t m_PreviewSyncSkew;
+    // how long a preview frame waits for its partner before being dropped
+    nsecs_t m_PreviewSyncLatency;
 
     /* Private Member Methods */
     int setupLogicalCameras();
@@ -267,6 +311,12 @@ private:
     void* getMainJpegCallbackCookie();
     void setJpegHandle(uint32_t handle) { mJpegClientHandle = handle;};
     // function to store single JPEG from 1 related physical camera instance
+    void matchPreviewFrame(cam_sync_mode_t cam_mode, nsecs_t timestamp,
+            uint32_t frame_idx);
+    void resetPreviewSync();
+    void dumpPreviewSync(int fd);
+    int runPreviewOp(qcamera_logical_descriptor_t *cam,
+            int (*op)(struct camera_device *));
     int32_t storeJpeg(cam_sync_type_t cam_type, int32_t msg_type,
             const camera_memory_t *data, unsigned int index,
             camera_frame_metadata_t *metadata, void *user,
@@ -1030,6 +1030,7 @@ int32_t QCameraPostProcessor::processJpegEvt(qcamera_jpeg_evt_payload_t *evt)
             m_dataProcTh.sendCmd(CAMERA_CMD_TYPE_DO_NEXT_JOB, FALSE, FALSE);
         }
         LOGH("[KPI Perf] : jpeg job %d", evt->jobId);
+        m_parent->m_kpiRing.recordJob(QCAMERA_KPI_JPEG_END, evt->jobId);
 
         if ((false == m_parent->m_bIntJpegEvtPending) &&
              (m_parent->mDataCb == NULL ||
@@ -2034,6 +2035,10 @@ int32_t QCameraPostProcessor::encodeData(qcamera_jpeg_data_t *jpeg_job_data,
         jpg_job.encode_job.dst_index = -1;
     }
 
+    // The first jpeg of a capture is the one the user waits for, let it
+    // go ahead of jobs queued by other sessions
+    jpg_job.encode_job.priority = (m_ongoingJpegQ.getCurrentSize() <= 1);
+
     // use src to reproc frame as work buffer; if src buf is not available
     // jpeg interface will allocate work buffer
     if (jpeg_job_data->src_reproc_frame != NULL) {
@@ -2349,6 +2354,7 @@ int32_t QCameraPostProcessor::encodeData(qcamera_jpeg_data_t *jpeg_job_data,
     if (ret == NO_ERROR) {
         // remember job info
         jpeg_job_data->jobId = jobId;
+        m_parent->m_kpiRing.record(QCAMERA_KPI_JPEG_START, main_frame->frame_idx, jobId);
     }
 
     return ret;
@@ -3203,7 +3209,8 @@ int QCameraPostProcessor::releaseJpegMemory(omx_jpeg_ouput_buf_t *out_buf)
  * RETURN     : None
  *==========================================================================*/
 QCameraExif::QCameraExif()
-    : m_nNumEntries(0)
+    : m_nNumEntries(0),
+      m_nArenaUsed(0)
 {
     memset(m_Entries, 0, sizeof(m_Entries));
 }
@@ -3211,7 +3218,8 @@ QCameraExif::QCameraExif()
 /*===========================================================================
  * FUNCTION   : ~QCameraExif
  *
- * DESCRIPTION: deconstructor of QCameraExif. Will release internal memory ptr.
+ * DESCRIPTION: deconstructor of QCameraExif. Tag data lives in the arena, so
+ *              there is nothing to release.
  *
  * PARAMETERS : None
  *
@@ -3219,80 +3227,31 @@ QCameraExif::QCameraExif()
  *==========================================================================*/
 QCameraExif::~QCameraExif()
 {
-    for (uint32_t i = 0; i < m_nNumEntries; i++) {
-        switch (m_Entries[i].tag_entry.type) {
-        case EXIF_BYTE:
-            {
-                if (m_Entries[i].tag_entry.count > 1 &&
-                    m_Entries[i].tag_entry.data._bytes != NULL) {
-                    free(m_Entries[i].tag_entry.data._bytes);
-                    m_Entries[i].tag_entry.data._bytes = NULL;
-                }
-            }
-            break;
-        case EXIF_ASCII:
-            {
-                if (m_Entries[i].tag_entry.data._ascii != NULL) {
-                    free(m_Entries[i].tag_entry.data._ascii);
-                    m_Entries[i].tag_entry.data._ascii = NULL;
-                }
-            }
-            break;
-        case EXIF_SHORT:
-            {
-                if (m_Entries[i].tag_entry.count > 1 &&
-                    m_Entries[i].tag_entry.data._shorts != NULL) {
-                    free(m_Entries[i].tag_entry.data._shorts);
-                    m_Entries[i].tag_entry.data._shorts = NULL;
-                }
-            }
-            break;
-        case EXIF_LONG:
-            {
-                if (m_Entries[i].tag_entry.count > 1 &&
-                    m_Entries[i].tag_entry.data._longs != NULL) {
-                    free(m_Entries[i].tag_entry.data._longs);
-                    m_Entries[i].tag_entry.data._longs = NULL;
-                }
-            }
-            break;
-        case EXIF_RATIONAL:
-            {
-                if (m_Entries[i].tag_entry.count > 1 &&
-                    m_Entries[i].tag_entry.data._rats != NULL) {
-                    free(m_Entries[i].tag_entry.data._rats);
-                    m_Entries[i].tag_entry.data._rats = NULL;
-                }
-            }
-            break;
-        case EXIF_UNDEFINED:
-            {
-                if (m_Entries[i].tag_entry.data._undefined != NULL) {
-                    free(m_Entries[i].tag_entry.data._undefined);
-                    m_Entries[i].tag_entry.data._undefined = NULL;
-                }
-            }
-            break;
-        case EXIF_SLONG:
-            {
-                if (m_Entries[i].tag_entry.count > 1 &&
-                    m_Entries[i].tag_entry.data._slongs != NULL) {
-                    free(m_Entries[i].tag_entry.data._slongs);
-                    m_Entries[i].tag_entry.data._slongs = NULL;
-                }
-            }
-            break;
-        case EXIF_SRATIONAL:
-            {
-                if (m_Entries[i].tag_entry.count > 1 &&
-                    m_Entries[i].tag_entry.data._srats != NULL) {
-                    free(m_Entries[i].tag_entry.data._srats);
-                    m_Entries[i].tag_entry.data._srats = NULL;
-                }
-            }
-            break;
-        }
+}
+
+/*===========================================================================
+ * FUNCTION   : allocData
+ *
+ * DESCRIPTION: bump allocate tag data from the arena of this object. The
+ *              memory goes away together with the object, after encoding.
+ *
+ * PARAMETERS :
+ *   @size    : number of bytes
+ *
+ * RETURN     : ptr to the memory, NULL if the arena is exhausted
+ *==========================================================================*/
+void *QCameraExif::allocData(size_t size)
+{
+    size_t offset = (m_nArenaUsed + 7) & ~(size_t)7;
+
+    if (offset + size > sizeof(m_Arena)) {
+        LOGE("Exif arena exhausted, used %zu, requested %zu",
+                m_nArenaUsed, size);
+        return NULL;
     }
+
+    m_nArenaUsed = offset + size;
+    return &m_Arena[offset];
 }
 
 /*===========================================================================
@@ -3315,149 +3274,108 @@ int32_t QCameraExif::addEntry(exif_tag_id_t tagid,
                               uint32_t count,
                               void *data)
 {
-    int32_t rc = NO_ERROR;
+    size_t elem_size = 0;
     if(m_nNumEntries >= MAX_EXIF_TABLE_ENTRIES) {
         LOGE("Number of entries exceeded limit");
         return NO_MEMORY;
     }
 
+    exif_tag_entry_t *entry = &m_Entries[m_nNumEntries].tag_entry;
     m_Entries[m_nNumEntries].tag_id = tagid;
-    m_Entries[m_nNumEntries].tag_entry.type = type;
-    m_Entries[m_nNumEntries].tag_entry.count = count;
-    m_Entries[m_nNumEntries].tag_entry.copy = 1;
+    entry->type = type;
+    entry->count = count;
+    entry->copy = 1;
     switch (type) {
     case EXIF_BYTE:
-        {
-            if (count > 1) {
-                uint8_t *values = (uint8_t *)malloc(count);
-                if (values == NULL) {
-                    LOGE("No memory for byte array");
-                    rc = NO_MEMORY;
-                } else {
-                    memcpy(values, data, count);
-                    m_Entries[m_nNumEntries].tag_entry.data._bytes = values;
-                }
-            } else {
-                m_Entries[m_nNumEntries].tag_entry.data._byte = *(uint8_t *)data;
-            }
-        }
-        break;
     case EXIF_ASCII:
-        {
-            char *str = NULL;
-            str = (char *)malloc(count + 1);
-            if (str == NULL) {
-                LOGE("No memory for ascii string");
-                rc = NO_MEMORY;
-            } else {
-                memset(str, 0, count + 1);
-                memcpy(str, data, count);
-                m_Entries[m_nNumEntries].tag_entry.data._ascii = str;
-            }
-        }
+    case EXIF_UNDEFINED:
+        elem_size = 1;
         break;
     case EXIF_SHORT:
-        {
-            uint16_t *exif_data = (uint16_t *)data;
-            if (count > 1) {
-                uint16_t *values = (uint16_t *)malloc(count * sizeof(uint16_t));
-                if (values == NULL) {
-                    LOGE("No memory for short array");
-                    rc = NO_MEMORY;
-                } else {
-                    memcpy(values, exif_data, count * sizeof(uint16_t));
-                    m_Entries[m_nNumEntries].tag_entry.data._shorts = values;
-                }
-            } else {
-                m_Entries[m_nNumEntries].tag_entry.data._short = *(uint16_t *)data;
-            }
-        }
+        elem_size = sizeof(uint16_t);
         break;
     case EXIF_LONG:
-        {
-            uint32_t *exif_data = (uint32_t *)data;
-            if (count > 1) {
-                uint32_t *values = (uint32_t *)malloc(count * sizeof(uint32_t));
-                if (values == NULL) {
-                    LOGE("No memory for long array");
-                    rc = NO_MEMORY;
-                } else {
-                    memcpy(values, exif_data, count * sizeof(uint32_t));
-                    m_Entries[m_nNumEntries].tag_entry.data._longs = values;
-                }
-            } else {
-                m_Entries[m_nNumEntries].tag_entry.data._long = *(uint32_t *)data;
-            }
-        }
+    case EXIF_SLONG:
+        elem_size = sizeof(uint32_t);
         break;
     case EXIF_RATIONAL:
-        {
-            rat_t *exif_data = (rat_t *)data;
-            if (count > 1) {
-                rat_t *values = (rat_t *)malloc(count * sizeof(rat_t));
-                if (values == NULL) {
-                    LOGE("No memory for rational array");
-                    rc = NO_MEMORY;
-                } else {
-                    memcpy(values, exif_data, count * sizeof(rat_t));
-                    m_Entries[m_nNumEntries].tag_entry.data._rats = values;
-                }
-            } else {
-                m_Entries[m_nNumEntries].tag_entry.data._rat = *(rat_t *)data;
-            }
-        }
+        elem_size = sizeof(rat_t);
         break;
-    case EXIF_UNDEFINED:
-        {
-            uint8_t *values = (uint8_t *)malloc(count);
-            if (values == NULL) {
-                LOGE("No memory for undefined array");
-                rc = NO_MEMORY;
-            } else {
-                memcpy(values, data, count);
-                m_Entries[m_nNumEntries].tag_entry.data._undefined = values;
-            }
-        }
+    case EXIF_SRATIONAL:
+        elem_size = sizeof(srat_t);
         break;
-    case EXIF_SLONG:
-        {
-            uint32_t *exif_data = (uint32_t *)data;
-            if (count > 1) {
-                int32_t *values = (int32_t *)malloc(count * sizeof(int32_t));
-                if (values == NULL) {
-                    LOGE("No memory for signed long array");
-                    rc = NO_MEMORY;
-                } else {
-                    memcpy(values, exif_data, count * sizeof(int32_t));
-                    m_Entries[m_nNumEntries].tag_entry.data._slongs = values;
-                }
-            } else {
-                m_Entries[m_nNumEntries].tag_entry.data._slong = *(int32_t *)data;
-            }
+    default:
+        LOGE("Error, Unknown type");
+        return BAD_VALUE;
+    }
+
+    // Single values are stored inline, strings and undefined data
+    // always go to the arena.
+    if (count == 1 && type != EXIF_ASCII && type != EXIF_UNDEFINED) {
+        switch (type) {
+        case EXIF_BYTE:
+            entry->data._byte = *(uint8_t *)data;
+            break;
+        case EXIF_SHORT:
+            entry->data._short = *(uint16_t *)data;
+            break;
+        case EXIF_LONG:
+            entry->data._long = *(uint32_t *)data;
+            break;
+        case EXIF_SLONG:
+            entry->data._slong = *(int32_t *)data;
+            break;
+        case EXIF_RATIONAL:
+            entry->data._rat = *(rat_t *)data;
+            break;
+        case EXIF_SRATIONAL:
+            entry->data._srat = *(srat_t *)data;
+            break;
+        default:
+            break;
         }
-        break;
-    case EXIF_SRATIONAL:
-        {
-            srat_t *exif_data = (srat_t *)data;
-            if (count > 1) {
-                srat_t *values = (srat_t *)malloc(count * sizeof(srat_t));
-                if (values == NULL) {
-                    LOGE("No memory for signed rational array");
-                    rc = NO_MEMORY;
-                } else {
-                    memcpy(values, exif_data, count * sizeof(srat_t));
-                    m_Entries[m_nNumEntries].tag_entry.data._srats = values;
-                }
-            } else {
-                m_Entries[m_nNumEntries].tag_entry.data._srat = *(srat_t *)data;
-            }
+    } else {
+        size_t size = elem_size * count;
+        void *values = allocData((type == EXIF_ASCII) ? size + 1 : size);
+        if (values == NULL) {
+            return NO_MEMORY;
+        }
+        memcpy(values, data, size);
+
+        switch (type) {
+        case EXIF_BYTE:
+            entry->data._bytes = (uint8_t *)values;
+            break;
+        case EXIF_ASCII:
+            ((char *)values)[size] = '\0';
+            entry->data._ascii = (char *)values;
+            break;
+        case EXIF_UNDEFINED:
+            entry->data._undefined = (uint8_t *)values;
+            break;
+        case EXIF_SHORT:
+            entry->data._shorts = (uint16_t *)values;
+            break;
+        case EXIF_LONG:
+            entry->data._longs = (uint32_t *)values;
+            break;
+        case EXIF_SLONG:
+            entry->data._slongs = (int32_t *)values;
+            break;
+        case EXIF_RATIONAL:
+            entry->data._rats = (rat_t *)values;
+            break;
+        case EXIF_SRATIONAL:
+            entry->data._srats = (srat_t *)values;
+            break;
+        default:
+            break;
         }
-        break;
     }
 
     // Increase number of entries
     m_nNumEntries++;
-    return rc;
+    return NO_ERROR;
 }
 
 }; // namespace qcamera
@@ -100,6 +100,7 @@ typedef struct {
 } qcamera_data_argm_t;
 
 #define MAX_EXIF_TABLE_ENTRIES 17
+#define MAX_EXIF_ARENA_SIZE 2048 // bytes of string and array tag data
 class QCameraExif
 {
 public:
@@ -114,8 +115,12 @@ public:
     QEXIF_INFO_DATA *getEntries() {return m_Entries;};
 
 private:
+    void *allocData(size_t size);
+
     QEXIF_INFO_DATA m_Entries[MAX_EXIF_TABLE_ENTRIES];  // exif tags for JPEG encoder
     uint32_t  m_nNumEntries;                            // number of valid entries
+    uint8_t m_Arena[MAX_EXIF_ARENA_SIZE] __attribute__((aligned(8)));  // backing store of tag data
+    size_t m_nArenaUsed;
 };
 
 class QCameraPostProcessor
@@ -535,6 +535,20 @@ int32_t QCameraStream::unMapBuf(QCameraMemory *Buf,
     uint32_t i;
 
     cnt = Buf->getCnt();
+    if (m_MemOpsTbl.bundled_unmap_ops != NULL) {
+        for (i = 0; i < cnt; i++) {
+            if (BAD_INDEX == Buf->getSize(i)) {
+                LOGE("Failed to retrieve buffer size (bad index)");
+                return BAD_INDEX;
+            }
+        }
+        rc = unmapStreamBufs(&m_MemOpsTbl, bufType, cnt);
+        if (rc < 0) {
+            LOGE("Failed to unmap buffers");
+        }
+        return rc;
+    }
+
     for (i = 0; i < cnt; i++) {
         bufSize = Buf->getSize(i);
         if (BAD_INDEX != bufSize) {
@@ -736,6 +750,7 @@ int32_t QCameraStream::init(QCameraHeapMemory *streamInfoBuf,
     if (mDefferedAllocation) {
         mMapTask.bgFunction = backgroundMap;
         mMapTask.bgArgs = this;
+        mMapTask.dependsOn = mAllocTaskId;
         mMapTaskId = mAllocator.scheduleBackgroundTask(&mMapTask);
         if (mMapTaskId == 0) {
             LOGE("Failed to schedule buffer alloction");
@@ -1336,9 +1351,7 @@ int32_t QCameraStream::getBufs(cam_frame_len_offset_t *offset,
     regFlags = (uint8_t *)malloc(sizeof(uint8_t) * mNumBufs);
     if (!regFlags) {
         LOGE("Out of memory");
-        for (uint32_t i = 0; i < numBufsToMap; i++) {
-            ops_tbl->unmap_ops(i, -1, CAM_MAPPING_BUF_TYPE_STREAM_BUF, ops_tbl->userdata);
-        }
+        unmapStreamBufs(ops_tbl, CAM_MAPPING_BUF_TYPE_STREAM_BUF, numBufsToMap);
         mStreamBufs->deallocate();
         delete mStreamBufs;
         mStreamBufs = NULL;
@@ -1349,9 +1362,7 @@ int32_t QCameraStream::getBufs(cam_frame_len_offset_t *offset,
     mBufDefs = (mm_camera_buf_def_t *)malloc(mNumBufs * sizeof(mm_camera_buf_def_t));
     if (mBufDefs == NULL) {
         LOGE("getRegFlags failed %d", rc);
-        for (uint32_t i = 0; i < numBufsToMap; i++) {
-            ops_tbl->unmap_ops(i, -1, CAM_MAPPING_BUF_TYPE_STREAM_BUF, ops_tbl->userdata);
-        }
+        unmapStreamBufs(ops_tbl, CAM_MAPPING_BUF_TYPE_STREAM_BUF, numBufsToMap);
         mStreamBufs->deallocate();
         delete mStreamBufs;
         mStreamBufs = NULL;
@@ -1367,9 +1378,7 @@ int32_t QCameraStream::getBufs(cam_frame_len_offset_t *offset,
     rc = mStreamBufs->getRegFlags(regFlags);
     if (rc < 0) {
         LOGE("getRegFlags failed %d", rc);
-        for (uint32_t i = 0; i < numBufsToMap; i++) {
-            ops_tbl->unmap_ops(i, -1, CAM_MAPPING_BUF_TYPE_STREAM_BUF, ops_tbl->userdata);
-        }
+        unmapStreamBufs(ops_tbl, CAM_MAPPING_BUF_TYPE_STREAM_BUF, numBufsToMap);
         mStreamBufs->deallocate();
         delete mStreamBufs;
         mStreamBufs = NULL;
@@ -2101,11 +2110,9 @@ int32_t QCameraStream::putBufs(mm_camera_map_unmap_ops_tbl_t *ops_tbl)
     }
 
     uint8_t numBufsToUnmap = mStreamBufs->getMappable();
-    for (uint32_t i = 0; i < numBufsToUnmap; i++) {
-        rc = ops_tbl->unmap_ops(i, -1, CAM_MAPPING_BUF_TYPE_STREAM_BUF, ops_tbl->userdata);
-        if (rc < 0) {
-            LOGE("map_stream_buf failed: %d", rc);
-        }
+    rc = unmapStreamBufs(ops_tbl, CAM_MAPPING_BUF_TYPE_STREAM_BUF, numBufsToUnmap);
+    if (rc < 0) {
+        LOGE("unmap_stream_bufs failed: %d", rc);
     }
     mBufDefs = NULL; // mBufDefs just keep a ptr to the buffer
                      // mm-camera-interface own the buffer, so no need to free
@@ -2119,6 +2126,39 @@ int32_t QCameraStream::putBufs(mm_camera_map_unmap_ops_tbl_t *ops_tbl)
     return rc;
 }
 
+/*===========================================================================
+ * FUNCTION   : unmapStreamBufs
+ *
+ * DESCRIPTION: unmap the first buffers of a stream from the server with a
+ *              single message
+ *
+ * PARAMETERS :
+ *   @ops_tbl    : ptr to buf mapping/unmapping ops
+ *   @bufType    : buffer type
+ *   @numBufs    : number of buffers to unmap, starting at index 0
+ *
+ * RETURN     : int32_t type of status
+ *              NO_ERROR  -- success
+ *              none-zero failure code
+ *==========================================================================*/
+int32_t QCameraStream::unmapStreamBufs(mm_camera_map_unmap_ops_tbl_t *ops_tbl,
+        cam_mapping_buf_type bufType, uint32_t numBufs)
+{
+    cam_buf_unmap_type_list bufUnmapList;
+    int32_t rc = NO_ERROR;
+
+    memset(&bufUnmapList, 0, sizeof(bufUnmapList));
+    for (uint32_t i = 0; i < numBufs; i++) {
+        rc = QCameraBufferMaps::enqueueUnmap(bufType, i, -1, bufUnmapList);
+        if (rc != NO_ERROR) {
+            LOGE("Failed to queue buffer %d for unmapping", i);
+            return BAD_INDEX;
+        }
+    }
+
+    return ops_tbl->bundled_unmap_ops(&bufUnmapList, ops_tbl->userdata);
+}
+
 /*===========================================================================
  * FUNCTION   : invalidateBuf
  *
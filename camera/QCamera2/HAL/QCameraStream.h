@@ -250,6 +250,8 @@ private:
             mm_camera_map_unmap_ops_tbl_t *ops_tbl = NULL);
     int32_t unMapBuf(QCameraMemory *heapBuf, cam_mapping_buf_type bufType,
             mm_camera_map_unmap_ops_tbl_t *ops_tbl = NULL);
+    int32_t unmapStreamBufs(mm_camera_map_unmap_ops_tbl_t *ops_tbl,
+            cam_mapping_buf_type bufType, uint32_t numBufs);
 
     bool mDefferedAllocation;
 
@@ -58,6 +58,10 @@ QCamera3CropRegionMapper::QCamera3CropRegionMapper()
           mActiveArrayW(0),
           mActiveArrayH(0)
 {
+    memset(&mToActiveX, 0, sizeof(mToActiveX));
+    memset(&mToActiveY, 0, sizeof(mToActiveY));
+    memset(&mToSensorX, 0, sizeof(mToSensorX));
+    memset(&mToSensorY, 0, sizeof(mToSensorY));
 }
 
 /*===========================================================================
@@ -107,6 +111,11 @@ void QCamera3CropRegionMapper::update(uint32_t active_array_w,
     mActiveArrayW = active_array_w;
     mActiveArrayH = active_array_h;
 
+    initRatio(mToActiveX, mActiveArrayW, mSensorW);
+    initRatio(mToActiveY, mActiveArrayH, mSensorH);
+    initRatio(mToSensorX, mSensorW, mActiveArrayW);
+    initRatio(mToSensorY, mSensorH, mActiveArrayH);
+
     LOGH("active_array: %d x %d, sensor size %d x %d",
             mActiveArrayW, mActiveArrayH, mSensorW, mSensorH);
 }
@@ -133,10 +142,10 @@ void QCamera3CropRegionMapper::toActiveArray(int32_t& crop_left, int32_t& crop_t
         return;
     }
 
-    crop_left = crop_left * mActiveArrayW / mSensorW;
-    crop_top = crop_top * mActiveArrayH / mSensorH;
-    crop_width = crop_width * mActiveArrayW / mSensorW;
-    crop_height = crop_height * mActiveArrayH / mSensorH;
+    crop_left = scale(crop_left, mToActiveX);
+    crop_top = scale(crop_top, mToActiveY);
+    crop_width = scale(crop_width, mToActiveX);
+    crop_height = scale(crop_height, mToActiveY);
 
     boundToSize(crop_left, crop_top, crop_width, crop_height,
             mActiveArrayW, mActiveArrayH);
@@ -165,10 +174,10 @@ void QCamera3CropRegionMapper::toSensor(int32_t& crop_left, int32_t& crop_top,
         return;
     }
 
-    crop_left = crop_left * mSensorW / mActiveArrayW;
-    crop_top = crop_top * mSensorH / mActiveArrayH;
-    crop_width = crop_width * mSensorW / mActiveArrayW;
-    crop_height = crop_height * mSensorH / mActiveArrayH;
+    crop_left = scale(crop_left, mToSensorX);
+    crop_top = scale(crop_top, mToSensorY);
+    crop_width = scale(crop_width, mToSensorX);
+    crop_height = scale(crop_height, mToSensorY);
 
     LOGD("before bounding left %d, top %d, width %d, height %d",
          crop_left, crop_top, crop_width, crop_height);
@@ -178,6 +187,65 @@ void QCamera3CropRegionMapper::toSensor(int32_t& crop_left, int32_t& crop_top,
          crop_left, crop_top, crop_width, crop_height);
 }
 
+/*===========================================================================
+ * FUNCTION   : initRatio
+ *
+ * DESCRIPTION: Precompute the reciprocal used by scale(). With
+ *              shift = 31 + ceil(log2(den)) and mul = 2^shift / den + 1,
+ *              (n * mul) >> shift equals n / den for every n below 2^31,
+ *              and the product still fits in 64 bits.
+ *
+ * PARAMETERS :
+ *   @ratio : [out] precomputed ratio
+ *   @num   : numerator
+ *   @den   : denominator, must be non zero
+ *
+ * RETURN     : none
+ *==========================================================================*/
+void QCamera3CropRegionMapper::initRatio(scale_ratio_t& ratio, int32_t num,
+        int32_t den)
+{
+    uint32_t log2_den = 0;
+
+    while ((1LL << log2_den) < den) {
+        log2_den++;
+    }
+    ratio.num = num;
+    ratio.den = den;
+    ratio.shift = 31 + log2_den;
+    ratio.mul = (1ULL << ratio.shift) / static_cast<uint64_t>(den) + 1;
+}
+
+/*===========================================================================
+ * FUNCTION   : scale
+ *
+ * DESCRIPTION: Compute v * num / den with the rounding of integer division,
+ *              i.e. truncated toward zero
+ *
+ * PARAMETERS :
+ *   @v     : value to scale
+ *   @ratio : precomputed ratio
+ *
+ * RETURN     : scaled value
+ *==========================================================================*/
+int32_t QCamera3CropRegionMapper::scale(int32_t v, const scale_ratio_t& ratio)
+{
+    int64_t n = static_cast<int64_t>(v) * ratio.num;
+    uint64_t u = static_cast<uint64_t>(n < 0 ? -n : n);
+    int64_t q;
+
+    if (u >= (1ULL << 31)) {
+        // Out of range of the reciprocal; only reachable with bogus input
+        q = n / ratio.den;
+    } else {
+        q = static_cast<int64_t>((u * ratio.mul) >> ratio.shift);
+        if (n < 0) {
+            q = -q;
+        }
+    }
+    return static_cast<int32_t>(q);
+}
+
 /*===========================================================================
  * FUNCTION   : boundToSize
  *
@@ -235,8 +303,8 @@ void QCamera3CropRegionMapper::toActiveArray(uint32_t& x, uint32_t& y)
                  x, y, mSensorW, mSensorH);
         return;
     }
-    x = x * mActiveArrayW / mSensorW;
-    y = y * mActiveArrayH / mSensorH;
+    x = static_cast<uint32_t>(scale(static_cast<int32_t>(x), mToActiveX));
+    y = static_cast<uint32_t>(scale(static_cast<int32_t>(y), mToActiveY));
 }
 
 /*===========================================================================
@@ -265,8 +333,8 @@ void QCamera3CropRegionMapper::toSensor(uint32_t& x, uint32_t& y)
                  x, y, mSensorW, mSensorH);
         return;
     }
-    x = x * mSensorW / mActiveArrayW;
-    y = y * mSensorH / mActiveArrayH;
+    x = static_cast<uint32_t>(scale(static_cast<int32_t>(x), mToSensorX));
+    y = static_cast<uint32_t>(scale(static_cast<int32_t>(y), mToSensorY));
 }
 
 }; //end namespace android
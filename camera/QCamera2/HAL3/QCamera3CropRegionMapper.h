@@ -52,10 +52,25 @@ public:
     void toSensor(uint32_t& x, uint32_t& y);
 
 private:
+    /* Fixed-point form of v * num / den: den is replaced by an exact
+     * reciprocal so that mapping costs a multiply and a shift. */
+    typedef struct {
+        int64_t num;
+        int64_t den;
+        uint64_t mul;
+        uint32_t shift;
+    } scale_ratio_t;
+
     /* sensor output size */
     int32_t mSensorW, mSensorH;
     int32_t mActiveArrayW, mActiveArrayH;
 
+    /* sensor to active array and active array to sensor, per axis */
+    scale_ratio_t mToActiveX, mToActiveY;
+    scale_ratio_t mToSensorX, mToSensorY;
+
+    static void initRatio(scale_ratio_t& ratio, int32_t num, int32_t den);
+    static int32_t scale(int32_t v, const scale_ratio_t& ratio);
     void boundToSize(int32_t& left, int32_t& top, int32_t& width,
             int32_t& height, int32_t bound_w, int32_t bound_h);
 };
@@ -50,6 +50,8 @@
 
 // Camera dependencies
 #include "android/QCamera3External.h"
+#include "util/QCameraCapsCache.h"
+#include "util/QCameraDumpWriter.h"
 #include "util/QCameraFlash.h"
 #include "QCamera3HWI.h"
 #include "QCamera3VendorTags.h"
@@ -107,6 +109,10 @@ namespace qcamera {
 
 cam_capability_t *gCamCapability[MM_CAMERA_MAX_NUM_SENSORS];
 const camera_metadata_t *gStaticMetadata[MM_CAMERA_MAX_NUM_SENSORS];
+// Guards the lazy init of gCamCapability and gStaticMetadata of one camera,
+// so that different cameras can be queried concurrently
+static pthread_mutex_t gCamInfoLock[MM_CAMERA_MAX_NUM_SENSORS];
+static pthread_once_t gCamInfoLockOnce = PTHREAD_ONCE_INIT;
 extern pthread_mutex_t gCamLock;
 volatile uint32_t gCamHal3LogLevel = 1;
 extern uint8_t gNumCameraSessions;
@@ -362,6 +368,8 @@ QCamera3HardwareInterface::QCamera3HardwareInterface(uint32_t cameraId,
       mLdafCalibExist(false),
       mPowerHintEnabled(false),
       mLastCustIntentFrmNum(-1),
+      mResultEntryCapacity(0),
+      mResultDataCapacity(0),
       mState(CLOSED)
 {
     getLogLevel();
@@ -396,6 +404,7 @@ QCamera3HardwareInterface::QCamera3HardwareInterface(uint32_t cameraId,
 
     memset(&mInputStreamInfo, 0, sizeof(mInputStreamInfo));
     memset(mLdafCalib, 0, sizeof(mLdafCalib));
+    memset(&mBatchResults, 0, sizeof(mBatchResults));
 
     memset(prop, 0, sizeof(prop));
     property_get("persist.camera.tnr.preview", prop, "0");
@@ -2485,11 +2494,16 @@ void QCamera3HardwareInterface::handleBatchMetadata(
             }
         }
         pthread_mutex_lock(&mMutex);
+        mBatchResults.active = true;
         handleMetadataWithLock(metadata_buf,
                 false /* free_and_bufdone_meta_buf */);
         pthread_mutex_unlock(&mMutex);
     }
 
+    pthread_mutex_lock(&mMutex);
+    releaseBatchResults();
+    pthread_mutex_unlock(&mMutex);
+
     /* BufDone metadata buffer */
     if (free_and_bufdone_meta_buf) {
         mMetadataChannel->bufDone(metadata_buf);
@@ -2584,9 +2598,18 @@ void QCamera3HardwareInterface::handleMetadataWithLock(
 
                 i->partial_result_cnt++;
                 i->bUrgentReceived = 1;
-                // Extract 3A metadata
-                result.result =
-                    translateCbUrgentMetadataToResultMetadata(metadata);
+                // Extract 3A metadata. It carries no per-frame entries,
+                // so a batch translates it once for all of its frames.
+                if (mBatchResults.active) {
+                    if (mBatchResults.urgent == NULL) {
+                        mBatchResults.urgent =
+                            translateCbUrgentMetadataToResultMetadata(metadata);
+                    }
+                    result.result = mBatchResults.urgent;
+                } else {
+                    result.result =
+                        translateCbUrgentMetadataToResultMetadata(metadata);
+                }
                 // Populate metadata result
                 result.frame_number = urgent_frame_number;
                 result.num_output_buffers = 0;
@@ -2596,7 +2619,7 @@ void QCamera3HardwareInterface::handleMetadataWithLock(
                 mCallbackOps->process_capture_result(mCallbackOps, &result);
                 LOGD("urgent frame_number = %u, capture_time = %lld",
                       result.frame_number, capture_time);
-                free_camera_metadata((camera_metadata_t *)result.result);
+                releaseResultMetadata(result.result);
                 break;
             }
         }
@@ -2739,7 +2762,7 @@ void QCamera3HardwareInterface::handleMetadataWithLock(
                 }
             }
 
-            result.result = translateFromHalMetadata(metadata,
+            result.result = translateBatchFromHalMetadata(metadata,
                     i->timestamp, i->request_id, i->jpegMetadata, i->pipeline_depth,
                     i->capture_intent, internalPproc, i->fwkCacMode);
 
@@ -2830,7 +2853,7 @@ void QCamera3HardwareInterface::handleMetadataWithLock(
                 mCallbackOps->process_capture_result(mCallbackOps, &result);
                 LOGD("meta frame_number = %u, capture_time = %lld",
                         result.frame_number, i->timestamp);
-                free_camera_metadata((camera_metadata_t *)result.result);
+                releaseResultMetadata(result.result);
                 delete[] result_buffers;
             }else {
                 LOGE("Fatal error: out of memory");
@@ -2839,7 +2862,7 @@ void QCamera3HardwareInterface::handleMetadataWithLock(
             mCallbackOps->process_capture_result(mCallbackOps, &result);
             LOGD("meta frame_number = %u, capture_time = %lld",
                     result.frame_number, i->timestamp);
-            free_camera_metadata((camera_metadata_t *)result.result);
+            releaseResultMetadata(result.result);
         }
         // erase the element from the list
         i = erasePendingRequest(i);
@@ -3915,6 +3938,8 @@ void QCamera3HardwareInterface::dump(int fd)
     }
     dprintf(fd, "-------+-----------\n");
 
+    QCameraDumpWriter::getInstance().dump(fd);
+
     dprintf(fd, "\n Camera HAL3 information End \n");
 
     /* use dumpsys media.camera as trigger to send update debug level event */
@@ -4467,7 +4492,10 @@ QCamera3HardwareInterface::translateFromHalMetadata(
                                  bool pprocDone,
                                  uint8_t fwk_cacMode)
 {
-    CameraMetadata camMetadata;
+    // Presize for the largest result seen so far. Starting from an empty
+    // buffer, the updates below would grow and copy it several times per
+    // frame, while the set of tags hardly changes from one frame to the next.
+    CameraMetadata camMetadata(mResultEntryCapacity, mResultDataCapacity);
     camera_metadata_t *resultMetadata;
 
     if (jpegMetadata.entryCount())
@@ -5252,9 +5280,156 @@ QCamera3HardwareInterface::translateFromHalMetadata(
     }
 
     resultMetadata = camMetadata.release();
+    if (resultMetadata != NULL) {
+        mResultEntryCapacity = MAX(mResultEntryCapacity,
+                get_camera_metadata_entry_count(resultMetadata));
+        mResultDataCapacity = MAX(mResultDataCapacity,
+                get_camera_metadata_data_count(resultMetadata));
+    }
     return resultMetadata;
 }
 
+/*===========================================================================
+ * FUNCTION   : updateResultEntry
+ *
+ * DESCRIPTION: overwrite an existing entry of a result metadata in place
+ *
+ * PARAMETERS :
+ *   @result  : result metadata
+ *   @tag     : tag of the entry
+ *   @data    : new entry data
+ *   @count   : number of data elements, must match the existing entry
+ *
+ * RETURN     : NO_ERROR on success
+ *              Error code otherwise
+ *==========================================================================*/
+static int updateResultEntry(camera_metadata_t *result, uint32_t tag,
+        const void *data, size_t count)
+{
+    camera_metadata_entry_t entry;
+
+    if (find_camera_metadata_entry(result, tag, &entry) != OK) {
+        return NAME_NOT_FOUND;
+    }
+    // Same element count keeps the entry in its slot without reallocation
+    if (entry.count != count) {
+        return BAD_VALUE;
+    }
+    return update_camera_metadata_entry(result, entry.index, data, count, NULL);
+}
+
+/*===========================================================================
+ * FUNCTION   : translateBatchFromHalMetadata
+ *
+ * DESCRIPTION: translate a result for one frame of an HFR batch. All frames
+ *              of a batch share one HAL metadata buffer, so the full
+ *              translation is done once and only the per-frame entries are
+ *              rewritten for the remaining frames. Outside of a batch this
+ *              is translateFromHalMetadata.
+ *
+ * PARAMETERS : same as translateFromHalMetadata
+ *
+ * RETURN     : camera_metadata_t*
+ *              metadata in a format specified by fwk, to be released with
+ *              releaseResultMetadata
+ *==========================================================================*/
+camera_metadata_t*
+QCamera3HardwareInterface::translateBatchFromHalMetadata(
+                                 metadata_buffer_t *metadata,
+                                 nsecs_t timestamp,
+                                 int32_t request_id,
+                                 const CameraMetadata& jpegMetadata,
+                                 uint8_t pipeline_depth,
+                                 uint8_t capture_intent,
+                                 bool pprocDone,
+                                 uint8_t fwk_cacMode)
+{
+    if (!mBatchResults.active || jpegMetadata.entryCount()) {
+        return translateFromHalMetadata(metadata, timestamp, request_id,
+                jpegMetadata, pipeline_depth, capture_intent, pprocDone,
+                fwk_cacMode);
+    }
+
+    if ((mBatchResults.result != NULL) &&
+            (mBatchResults.pprocDone == pprocDone) &&
+            (mBatchResults.cacMode == fwk_cacMode)) {
+        camera_metadata_t *result = mBatchResults.result;
+        bool patched = false;
+
+        IF_META_AVAILABLE(uint32_t, frame_number, CAM_INTF_META_FRAME_NUMBER, metadata) {
+            int64_t fwk_frame_number = *frame_number;
+            patched =
+                (updateResultEntry(result, ANDROID_SENSOR_TIMESTAMP,
+                        &timestamp, 1) == NO_ERROR) &&
+                (updateResultEntry(result, ANDROID_REQUEST_ID,
+                        &request_id, 1) == NO_ERROR) &&
+                (updateResultEntry(result, ANDROID_REQUEST_PIPELINE_DEPTH,
+                        &pipeline_depth, 1) == NO_ERROR) &&
+                (updateResultEntry(result, ANDROID_CONTROL_CAPTURE_INTENT,
+                        &capture_intent, 1) == NO_ERROR) &&
+                (updateResultEntry(result, ANDROID_SYNC_FRAME_NUMBER,
+                        &fwk_frame_number, 1) == NO_ERROR);
+        }
+        if (patched) {
+            return result;
+        }
+        LOGW("Batch result could not be patched, translating again");
+    }
+
+    if (mBatchResults.result != NULL) {
+        free_camera_metadata(mBatchResults.result);
+    }
+    mBatchResults.result = translateFromHalMetadata(metadata, timestamp,
+            request_id, jpegMetadata, pipeline_depth, capture_intent,
+            pprocDone, fwk_cacMode);
+    mBatchResults.pprocDone = pprocDone;
+    mBatchResults.cacMode = fwk_cacMode;
+    return mBatchResults.result;
+}
+
+/*===========================================================================
+ * FUNCTION   : releaseResultMetadata
+ *
+ * DESCRIPTION: release a result metadata once it has been sent to the
+ *              framework. Results shared across a batch are kept until
+ *              releaseBatchResults.
+ *
+ * PARAMETERS :
+ *   @result  : result metadata
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCamera3HardwareInterface::releaseResultMetadata(
+        const camera_metadata_t *result)
+{
+    if ((result == NULL) || (result == mBatchResults.result) ||
+            (result == mBatchResults.urgent)) {
+        return;
+    }
+    free_camera_metadata((camera_metadata_t *)result);
+}
+
+/*===========================================================================
+ * FUNCTION   : releaseBatchResults
+ *
+ * DESCRIPTION: free the results shared by the frames of a batch and leave
+ *              batch mode
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCamera3HardwareInterface::releaseBatchResults()
+{
+    if (mBatchResults.urgent != NULL) {
+        free_camera_metadata(mBatchResults.urgent);
+    }
+    if (mBatchResults.result != NULL) {
+        free_camera_metadata(mBatchResults.result);
+    }
+    memset(&mBatchResults, 0, sizeof(mBatchResults));
+}
+
 /*===========================================================================
  * FUNCTION   : saveExifParams
  *
@@ -5487,64 +5662,38 @@ void QCamera3HardwareInterface::dumpMetadataToFile(tuning_params_t &meta,
     //
 
     if(enabled){
-        char timeBuf[FILENAME_MAX];
+        char filePath[QCAMERA_DUMP_PATH_MAX];
         char buf[FILENAME_MAX];
         memset(buf, 0, sizeof(buf));
-        memset(timeBuf, 0, sizeof(timeBuf));
-        time_t current_time;
-        struct tm * timeinfo;
-        time (&current_time);
-        timeinfo = localtime (&current_time);
-        if (timeinfo != NULL) {
-            strftime (timeBuf, sizeof(timeBuf),
-                    QCAMERA_DUMP_FRM_LOCATION"%Y%m%d%H%M%S", timeinfo);
-        }
-        String8 filePath(timeBuf);
         snprintf(buf,
                 sizeof(buf),
                 "%dm_%s_%d.bin",
                 dumpFrameCount,
                 type,
                 frameNumber);
-        filePath.append(buf);
-        int file_fd = open(filePath.string(), O_RDWR | O_CREAT, 0777);
-        if (file_fd >= 0) {
-            ssize_t written_len = 0;
-            meta.tuning_data_version = TUNING_DATA_VERSION;
-            void *data = (void *)((uint8_t *)&meta.tuning_data_version);
-            written_len += write(file_fd, data, sizeof(uint32_t));
-            data = (void *)((uint8_t *)&meta.tuning_sensor_data_size);
-            LOGD("tuning_sensor_data_size %d",(int)(*(int *)data));
-            written_len += write(file_fd, data, sizeof(uint32_t));
-            data = (void *)((uint8_t *)&meta.tuning_vfe_data_size);
-            LOGD("tuning_vfe_data_size %d",(int)(*(int *)data));
-            written_len += write(file_fd, data, sizeof(uint32_t));
-            data = (void *)((uint8_t *)&meta.tuning_cpp_data_size);
-            LOGD("tuning_cpp_data_size %d",(int)(*(int *)data));
-            written_len += write(file_fd, data, sizeof(uint32_t));
-            data = (void *)((uint8_t *)&meta.tuning_cac_data_size);
-            LOGD("tuning_cac_data_size %d",(int)(*(int *)data));
-            written_len += write(file_fd, data, sizeof(uint32_t));
-            meta.tuning_mod3_data_size = 0;
-            data = (void *)((uint8_t *)&meta.tuning_mod3_data_size);
-            LOGD("tuning_mod3_data_size %d",(int)(*(int *)data));
-            written_len += write(file_fd, data, sizeof(uint32_t));
-            size_t total_size = meta.tuning_sensor_data_size;
-            data = (void *)((uint8_t *)&meta.data);
-            written_len += write(file_fd, data, total_size);
-            total_size = meta.tuning_vfe_data_size;
-            data = (void *)((uint8_t *)&meta.data[TUNING_VFE_DATA_OFFSET]);
-            written_len += write(file_fd, data, total_size);
-            total_size = meta.tuning_cpp_data_size;
-            data = (void *)((uint8_t *)&meta.data[TUNING_CPP_DATA_OFFSET]);
-            written_len += write(file_fd, data, total_size);
-            total_size = meta.tuning_cac_data_size;
-            data = (void *)((uint8_t *)&meta.data[TUNING_CAC_DATA_OFFSET]);
-            written_len += write(file_fd, data, total_size);
-            close(file_fd);
-        }else {
-            LOGE("fail to open file for metadata dumping");
-        }
+        QCameraDumpWriter::getInstance().makePath(filePath, sizeof(filePath), buf);
+
+        meta.tuning_data_version = TUNING_DATA_VERSION;
+        meta.tuning_mod3_data_size = 0;
+        LOGD("tuning_sensor_data_size %d", (int)meta.tuning_sensor_data_size);
+        LOGD("tuning_vfe_data_size %d", (int)meta.tuning_vfe_data_size);
+        LOGD("tuning_cpp_data_size %d", (int)meta.tuning_cpp_data_size);
+        LOGD("tuning_cac_data_size %d", (int)meta.tuning_cac_data_size);
+        LOGD("tuning_mod3_data_size %d", (int)meta.tuning_mod3_data_size);
+        struct iovec iov[] = {
+            { &meta.tuning_data_version, sizeof(uint32_t) },
+            { &meta.tuning_sensor_data_size, sizeof(uint32_t) },
+            { &meta.tuning_vfe_data_size, sizeof(uint32_t) },
+            { &meta.tuning_cpp_data_size, sizeof(uint32_t) },
+            { &meta.tuning_cac_data_size, sizeof(uint32_t) },
+            { &meta.tuning_mod3_data_size, sizeof(uint32_t) },
+            { &meta.data[0], meta.tuning_sensor_data_size },
+            { &meta.data[TUNING_VFE_DATA_OFFSET], meta.tuning_vfe_data_size },
+            { &meta.data[TUNING_CPP_DATA_OFFSET], meta.tuning_cpp_data_size },
+            { &meta.data[TUNING_CAC_DATA_OFFSET], meta.tuning_cac_data_size },
+        };
+        QCameraDumpWriter::getInstance().dumpData(filePath, iov,
+                (int)(sizeof(iov) / sizeof(iov[0])));
     }
 }
 
@@ -5705,13 +5854,20 @@ void QCamera3HardwareInterface::convertToRegions(cam_rect_t rect,
 void QCamera3HardwareInterface::convertFromRegions(cam_area_t &roi,
         const camera_metadata_t *settings, uint32_t tag)
 {
-    CameraMetadata frame_settings;
-    frame_settings = settings;
-    int32_t x_min = frame_settings.find(tag).data.i32[0];
-    int32_t y_min = frame_settings.find(tag).data.i32[1];
-    int32_t x_max = frame_settings.find(tag).data.i32[2];
-    int32_t y_max = frame_settings.find(tag).data.i32[3];
-    roi.weight = frame_settings.find(tag).data.i32[4];
+    // Read the entry in place; wrapping settings in a CameraMetadata
+    // would clone the whole request just to look up one tag.
+    camera_metadata_ro_entry_t entry;
+    if ((find_camera_metadata_ro_entry(settings, tag, &entry) != OK) ||
+            (entry.count < 5)) {
+        LOGE("Invalid region for tag 0x%x", tag);
+        memset(&roi, 0, sizeof(roi));
+        return;
+    }
+    int32_t x_min = entry.data.i32[0];
+    int32_t y_min = entry.data.i32[1];
+    int32_t x_max = entry.data.i32[2];
+    int32_t y_max = entry.data.i32[3];
+    roi.weight = entry.data.i32[4];
     roi.rect.left = x_min;
     roi.rect.top = y_min;
     roi.rect.width = x_max - x_min;
@@ -5814,6 +5970,12 @@ int QCamera3HardwareInterface::initCapabilities(uint32_t cameraId)
     mm_camera_vtbl_t *cameraHandle = NULL;
     QCamera3HeapMemory *capabilityHeap = NULL;
 
+    gCamCapability[cameraId] =
+            QCameraCapsCache::getInstance().loadCapability(cameraId);
+    if (gCamCapability[cameraId] != NULL) {
+        return 0;
+    }
+
     rc = camera_open((uint8_t)cameraId, &cameraHandle);
     if (rc) {
         LOGE("camera_open failed. rc = %d", rc);
@@ -5862,6 +6024,8 @@ int QCamera3HardwareInterface::initCapabilities(uint32_t cameraId)
                                         sizeof(cam_capability_t));
     gCamCapability[cameraId]->analysis_padding_info.offset_info.offset_x = 0;
     gCamCapability[cameraId]->analysis_padding_info.offset_info.offset_y = 0;
+    QCameraCapsCache::getInstance().storeCapability(cameraId,
+            gCamCapability[cameraId]);
     rc = 0;
 
 query_failed:
@@ -6139,6 +6303,12 @@ int QCamera3HardwareInterface::initStaticMetadata(uint32_t cameraId)
     char prop[PROPERTY_VALUE_MAX];
     bool supportBurst = false;
 
+    gStaticMetadata[cameraId] =
+            QCameraCapsCache::getInstance().loadStaticMetadata(cameraId);
+    if (gStaticMetadata[cameraId] != NULL) {
+        return rc;
+    }
+
     supportBurst = supportBurstCapture(cameraId);
 
     /* If sensor is YUV sensor (no raw support) or if per-frame control is not
@@ -7112,6 +7282,8 @@ int QCamera3HardwareInterface::initStaticMetadata(uint32_t cameraId)
             strides.size());
 
     gStaticMetadata[cameraId] = staticInfo.release();
+    QCameraCapsCache::getInstance().storeStaticMetadata(cameraId,
+            gStaticMetadata[cameraId]);
     return rc;
 }
 
@@ -7359,6 +7531,22 @@ int32_t QCamera3HardwareInterface::getSensorSensitivity(int32_t iso_mode)
     return sensitivity;
 }
 
+/*===========================================================================
+ * FUNCTION   : initCamInfoLocks
+ *
+ * DESCRIPTION: initialize the per camera locks used by getCamInfo
+ *
+ * PARAMETERS : none
+ *
+ * RETURN     : none
+ *==========================================================================*/
+static void initCamInfoLocks()
+{
+    for (uint32_t i = 0; i < MM_CAMERA_MAX_NUM_SENSORS; i++) {
+        pthread_mutex_init(&gCamInfoLock[i], NULL);
+    }
+}
+
 /*===========================================================================
  * FUNCTION   : getCamInfo
  *
@@ -7378,11 +7566,12 @@ int QCamera3HardwareInterface::getCamInfo(uint32_t cameraId,
     ATRACE_CALL();
     int rc = 0;
 
-    pthread_mutex_lock(&gCamLock);
+    pthread_once(&gCamInfoLockOnce, initCamInfoLocks);
+    pthread_mutex_lock(&gCamInfoLock[cameraId]);
     if (NULL == gCamCapability[cameraId]) {
         rc = initCapabilities(cameraId);
         if (rc < 0) {
-            pthread_mutex_unlock(&gCamLock);
+            pthread_mutex_unlock(&gCamInfoLock[cameraId]);
             return rc;
         }
     }
@@ -7390,7 +7579,7 @@ int QCamera3HardwareInterface::getCamInfo(uint32_t cameraId,
     if (NULL == gStaticMetadata[cameraId]) {
         rc = initStaticMetadata(cameraId);
         if (rc < 0) {
-            pthread_mutex_unlock(&gCamLock);
+            pthread_mutex_unlock(&gCamInfoLock[cameraId]);
             return rc;
         }
     }
@@ -7436,7 +7625,7 @@ int QCamera3HardwareInterface::getCamInfo(uint32_t cameraId,
     LOGI("camera %d resource cost is %d", cameraId,
             info->resource_cost);
 
-    pthread_mutex_unlock(&gCamLock);
+    pthread_mutex_unlock(&gCamInfoLock[cameraId]);
     return rc;
 }
 
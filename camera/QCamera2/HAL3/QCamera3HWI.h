@@ -167,6 +167,12 @@ public:
                             nsecs_t timestamp, int32_t request_id,
                             const CameraMetadata& jpegMetadata, uint8_t pipeline_depth,
                             uint8_t capture_intent, bool pprocDone, uint8_t fwk_cacMode);
+    camera_metadata_t* translateBatchFromHalMetadata(metadata_buffer_t *metadata,
+                            nsecs_t timestamp, int32_t request_id,
+                            const CameraMetadata& jpegMetadata, uint8_t pipeline_depth,
+                            uint8_t capture_intent, bool pprocDone, uint8_t fwk_cacMode);
+    void releaseResultMetadata(const camera_metadata_t *result);
+    void releaseBatchResults();
     camera_metadata_t* saveRequestSettings(const CameraMetadata& jpegMetadata,
                             camera3_capture_request_t *request);
     int initParameters();
@@ -441,6 +447,17 @@ private:
     float mHFRVideoFps;
     uint8_t mOpMode;
     uint32_t mFirstFrameNumberInBatch;
+    /* Results shared by all frames of the batch being fanned out by
+     * handleBatchMetadata. They are translated for the first frame and
+     * only the per-frame entries are rewritten for the rest. */
+    typedef struct {
+        bool active;
+        camera_metadata_t *urgent;
+        camera_metadata_t *result;
+        bool pprocDone;
+        uint8_t cacMode;
+    } BatchResults;
+    BatchResults mBatchResults;
     camera3_stream_t mDummyBatchStream;
     bool mNeedSensorRestart;
 
@@ -452,6 +469,9 @@ private:
     uint32_t mLdafCalib[2];
     bool mPowerHintEnabled;
     int32_t mLastCustIntentFrmNum;
+    /* Largest result metadata translated so far, used to presize the next */
+    size_t mResultEntryCapacity;
+    size_t mResultDataCapacity;
 
     static const QCameraMap<camera_metadata_enum_android_control_effect_mode_t,
             cam_effect_mode_type> EFFECT_MODES_MAP[];
@@ -58,6 +58,35 @@ static const char ExifUndefinedPrefix[] =
 #define EXIF_ASCII_PREFIX_SIZE           8   //(sizeof(ExifAsciiPrefix))
 #define FOCAL_LENGTH_DECIMAL_PRECISION   1000
 
+#ifdef ENABLE_MODEL_INFO_EXIF
+typedef struct {
+    char make[PROPERTY_VALUE_MAX];
+    char model[PROPERTY_VALUE_MAX];
+    char software[PROPERTY_VALUE_MAX];
+} exif_model_info_t;
+
+/*===========================================================================
+ * FUNCTION   : loadExifModelInfo
+ *
+ * DESCRIPTION: read the make, model and software exif strings. They don't
+ *              change at runtime, so this runs once per process.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : make, model and software strings
+ *==========================================================================*/
+static exif_model_info_t loadExifModelInfo()
+{
+    exif_model_info_t info;
+
+    property_get("ro.product.manufacturer", info.make, "QCOM-AA");
+    property_get("ro.product.model", info.model, "QCAM-AA");
+    property_get("ro.build.description", info.software, "QCAM-AA");
+
+    return info;
+}
+#endif
+
 /*===========================================================================
  * FUNCTION   : QCamera3PostProcessor
  *
@@ -2512,27 +2541,14 @@ QCamera3Exif *QCamera3PostProcessor::getExifData(metadata_buffer_t *metadata,
 
 #ifdef ENABLE_MODEL_INFO_EXIF
 
-    char value[PROPERTY_VALUE_MAX];
-    if (property_get("ro.product.manufacturer", value, "QCOM-AA") > 0) {
-        exif->addEntry(EXIFTAGID_MAKE, EXIF_ASCII,
-                (uint32_t)(strlen(value) + 1), (void *)value);
-    } else {
-        LOGW("getExifMaker failed");
-    }
-
-    if (property_get("ro.product.model", value, "QCAM-AA") > 0) {
-        exif->addEntry(EXIFTAGID_MODEL, EXIF_ASCII,
-                (uint32_t)(strlen(value) + 1), (void *)value);
-    } else {
-        LOGW("getExifModel failed");
-    }
-
-    if (property_get("ro.build.description", value, "QCAM-AA") > 0) {
-        exif->addEntry(EXIFTAGID_SOFTWARE, EXIF_ASCII,
-                (uint32_t)(strlen(value) + 1), (void *)value);
-    } else {
-        LOGW("getExifSoftware failed");
-    }
+    // Read once, then copied into the arena of every capture
+    static const exif_model_info_t modelInfo = loadExifModelInfo();
+    exif->addEntry(EXIFTAGID_MAKE, EXIF_ASCII,
+            (uint32_t)(strlen(modelInfo.make) + 1), (void *)modelInfo.make);
+    exif->addEntry(EXIFTAGID_MODEL, EXIF_ASCII,
+            (uint32_t)(strlen(modelInfo.model) + 1), (void *)modelInfo.model);
+    exif->addEntry(EXIFTAGID_SOFTWARE, EXIF_ASCII,
+            (uint32_t)(strlen(modelInfo.software) + 1), (void *)modelInfo.software);
 
 #endif
 
@@ -2556,7 +2572,8 @@ QCamera3Exif *QCamera3PostProcessor::getExifData(metadata_buffer_t *metadata,
  * RETURN     : None
  *==========================================================================*/
 QCamera3Exif::QCamera3Exif()
-    : m_nNumEntries(0)
+    : m_nNumEntries(0),
+      m_nArenaUsed(0)
 {
     memset(m_Entries, 0, sizeof(m_Entries));
 }
@@ -2564,7 +2581,8 @@ QCamera3Exif::QCamera3Exif()
 /*===========================================================================
  * FUNCTION   : ~QCamera3Exif
  *
- * DESCRIPTION: deconstructor of QCamera3Exif. Will release internal memory ptr.
+ * DESCRIPTION: deconstructor of QCamera3Exif. Tag data lives in the arena, so
+ *              there is nothing to release.
  *
  * PARAMETERS : None
  *
@@ -2572,83 +2590,31 @@ QCamera3Exif::QCamera3Exif()
  *==========================================================================*/
 QCamera3Exif::~QCamera3Exif()
 {
-    for (uint32_t i = 0; i < m_nNumEntries; i++) {
-        switch (m_Entries[i].tag_entry.type) {
-            case EXIF_BYTE:
-                {
-                    if (m_Entries[i].tag_entry.count > 1 &&
-                            m_Entries[i].tag_entry.data._bytes != NULL) {
-                        free(m_Entries[i].tag_entry.data._bytes);
-                        m_Entries[i].tag_entry.data._bytes = NULL;
-                    }
-                }
-                break;
-            case EXIF_ASCII:
-                {
-                    if (m_Entries[i].tag_entry.data._ascii != NULL) {
-                        free(m_Entries[i].tag_entry.data._ascii);
-                        m_Entries[i].tag_entry.data._ascii = NULL;
-                    }
-                }
-                break;
-            case EXIF_SHORT:
-                {
-                    if (m_Entries[i].tag_entry.count > 1 &&
-                            m_Entries[i].tag_entry.data._shorts != NULL) {
-                        free(m_Entries[i].tag_entry.data._shorts);
-                        m_Entries[i].tag_entry.data._shorts = NULL;
-                    }
-                }
-                break;
-            case EXIF_LONG:
-                {
-                    if (m_Entries[i].tag_entry.count > 1 &&
-                            m_Entries[i].tag_entry.data._longs != NULL) {
-                        free(m_Entries[i].tag_entry.data._longs);
-                        m_Entries[i].tag_entry.data._longs = NULL;
-                    }
-                }
-                break;
-            case EXIF_RATIONAL:
-                {
-                    if (m_Entries[i].tag_entry.count > 1 &&
-                            m_Entries[i].tag_entry.data._rats != NULL) {
-                        free(m_Entries[i].tag_entry.data._rats);
-                        m_Entries[i].tag_entry.data._rats = NULL;
-                    }
-                }
-                break;
-            case EXIF_UNDEFINED:
-                {
-                    if (m_Entries[i].tag_entry.data._undefined != NULL) {
-                        free(m_Entries[i].tag_entry.data._undefined);
-                        m_Entries[i].tag_entry.data._undefined = NULL;
-                    }
-                }
-                break;
-            case EXIF_SLONG:
-                {
-                    if (m_Entries[i].tag_entry.count > 1 &&
-                            m_Entries[i].tag_entry.data._slongs != NULL) {
-                        free(m_Entries[i].tag_entry.data._slongs);
-                        m_Entries[i].tag_entry.data._slongs = NULL;
-                    }
-                }
-                break;
-            case EXIF_SRATIONAL:
-                {
-                    if (m_Entries[i].tag_entry.count > 1 &&
-                            m_Entries[i].tag_entry.data._srats != NULL) {
-                        free(m_Entries[i].tag_entry.data._srats);
-                        m_Entries[i].tag_entry.data._srats = NULL;
-                    }
-                }
-                break;
-            default:
-                LOGW("Error, Unknown type");
-                break;
-        }
+}
+
+/*===========================================================================
+ * FUNCTION   : allocData
+ *
+ * DESCRIPTION: bump allocate tag data from the arena of this object. The
+ *              memory goes away together with the object, after encoding.
+ *
+ * PARAMETERS :
+ *   @size    : number of bytes
+ *
+ * RETURN     : ptr to the memory, NULL if the arena is exhausted
+ *==========================================================================*/
+void *QCamera3Exif::allocData(size_t size)
+{
+    size_t offset = (m_nArenaUsed + 7) & ~(size_t)7;
+
+    if (offset + size > sizeof(m_Arena)) {
+        LOGE("Exif arena exhausted, used %zu, requested %zu",
+                m_nArenaUsed, size);
+        return NULL;
     }
+
+    m_nArenaUsed = offset + size;
+    return &m_Arena[offset];
 }
 
 /*===========================================================================
@@ -2667,165 +2633,112 @@ QCamera3Exif::~QCamera3Exif()
  *              none-zero failure code
  *==========================================================================*/
 int32_t QCamera3Exif::addEntry(exif_tag_id_t tagid,
-                              exif_tag_type_t type,
-                              uint32_t count,
-                              void *data)
+                               exif_tag_type_t type,
+                               uint32_t count,
+                               void *data)
 {
-    int32_t rc = NO_ERROR;
+    size_t elem_size = 0;
     if(m_nNumEntries >= MAX_HAL3_EXIF_TABLE_ENTRIES) {
         LOGE("Number of entries exceeded limit");
         return NO_MEMORY;
     }
 
+    exif_tag_entry_t *entry = &m_Entries[m_nNumEntries].tag_entry;
     m_Entries[m_nNumEntries].tag_id = tagid;
-    m_Entries[m_nNumEntries].tag_entry.type = type;
-    m_Entries[m_nNumEntries].tag_entry.count = count;
-    m_Entries[m_nNumEntries].tag_entry.copy = 1;
+    entry->type = type;
+    entry->count = count;
+    entry->copy = 1;
     switch (type) {
+    case EXIF_BYTE:
+    case EXIF_ASCII:
+    case EXIF_UNDEFINED:
+        elem_size = 1;
+        break;
+    case EXIF_SHORT:
+        elem_size = sizeof(uint16_t);
+        break;
+    case EXIF_LONG:
+    case EXIF_SLONG:
+        elem_size = sizeof(uint32_t);
+        break;
+    case EXIF_RATIONAL:
+        elem_size = sizeof(rat_t);
+        break;
+    case EXIF_SRATIONAL:
+        elem_size = sizeof(srat_t);
+        break;
+    default:
+        LOGE("Error, Unknown type");
+        return BAD_VALUE;
+    }
+
+    // Single values are stored inline, strings and undefined data
+    // always go to the arena.
+    if (count == 1 && type != EXIF_ASCII && type != EXIF_UNDEFINED) {
+        switch (type) {
         case EXIF_BYTE:
-            {
-                if (count > 1) {
-                    uint8_t *values = (uint8_t *)malloc(count);
-                    if (values == NULL) {
-                        LOGE("No memory for byte array");
-                        rc = NO_MEMORY;
-                    } else {
-                        memcpy(values, data, count);
-                        m_Entries[m_nNumEntries].tag_entry.data._bytes = values;
-                    }
-                } else {
-                    m_Entries[m_nNumEntries].tag_entry.data._byte =
-                        *(uint8_t *)data;
-                }
-            }
-            break;
-        case EXIF_ASCII:
-            {
-                char *str = NULL;
-                str = (char *)malloc(count + 1);
-                if (str == NULL) {
-                    LOGE("No memory for ascii string");
-                    rc = NO_MEMORY;
-                } else {
-                    memset(str, 0, count + 1);
-                    memcpy(str, data, count);
-                    m_Entries[m_nNumEntries].tag_entry.data._ascii = str;
-                }
-            }
+            entry->data._byte = *(uint8_t *)data;
             break;
         case EXIF_SHORT:
-            {
-                uint16_t *exif_data = (uint16_t *)data;
-                if (count > 1) {
-                    uint16_t *values =
-                        (uint16_t *)malloc(count * sizeof(uint16_t));
-                    if (values == NULL) {
-                        LOGE("No memory for short array");
-                        rc = NO_MEMORY;
-                    } else {
-                        memcpy(values, exif_data, count * sizeof(uint16_t));
-                        m_Entries[m_nNumEntries].tag_entry.data._shorts = values;
-                    }
-                } else {
-                    m_Entries[m_nNumEntries].tag_entry.data._short =
-                        *(uint16_t *)data;
-                }
-            }
+            entry->data._short = *(uint16_t *)data;
             break;
         case EXIF_LONG:
-            {
-                uint32_t *exif_data = (uint32_t *)data;
-                if (count > 1) {
-                    uint32_t *values =
-                        (uint32_t *)malloc(count * sizeof(uint32_t));
-                    if (values == NULL) {
-                        LOGE("No memory for long array");
-                        rc = NO_MEMORY;
-                    } else {
-                        memcpy(values, exif_data, count * sizeof(uint32_t));
-                        m_Entries[m_nNumEntries].tag_entry.data._longs = values;
-                    }
-                } else {
-                    m_Entries[m_nNumEntries].tag_entry.data._long =
-                        *(uint32_t *)data;
-                }
-            }
+            entry->data._long = *(uint32_t *)data;
+            break;
+        case EXIF_SLONG:
+            entry->data._slong = *(int32_t *)data;
             break;
         case EXIF_RATIONAL:
-            {
-                rat_t *exif_data = (rat_t *)data;
-                if (count > 1) {
-                    rat_t *values = (rat_t *)malloc(count * sizeof(rat_t));
-                    if (values == NULL) {
-                        LOGE("No memory for rational array");
-                        rc = NO_MEMORY;
-                    } else {
-                        memcpy(values, exif_data, count * sizeof(rat_t));
-                        m_Entries[m_nNumEntries].tag_entry.data._rats = values;
-                    }
-                } else {
-                    m_Entries[m_nNumEntries].tag_entry.data._rat =
-                        *(rat_t *)data;
-                }
-            }
+            entry->data._rat = *(rat_t *)data;
+            break;
+        case EXIF_SRATIONAL:
+            entry->data._srat = *(srat_t *)data;
+            break;
+        default:
+            break;
+        }
+    } else {
+        size_t size = elem_size * count;
+        void *values = allocData((type == EXIF_ASCII) ? size + 1 : size);
+        if (values == NULL) {
+            return NO_MEMORY;
+        }
+        memcpy(values, data, size);
+
+        switch (type) {
+        case EXIF_BYTE:
+            entry->data._bytes = (uint8_t *)values;
+            break;
+        case EXIF_ASCII:
+            ((char *)values)[size] = '\0';
+            entry->data._ascii = (char *)values;
             break;
         case EXIF_UNDEFINED:
-            {
-                uint8_t *values = (uint8_t *)malloc(count);
-                if (values == NULL) {
-                    LOGE("No memory for undefined array");
-                    rc = NO_MEMORY;
-                } else {
-                    memcpy(values, data, count);
-                    m_Entries[m_nNumEntries].tag_entry.data._undefined = values;
-                }
-            }
+            entry->data._undefined = (uint8_t *)values;
+            break;
+        case EXIF_SHORT:
+            entry->data._shorts = (uint16_t *)values;
+            break;
+        case EXIF_LONG:
+            entry->data._longs = (uint32_t *)values;
             break;
         case EXIF_SLONG:
-            {
-                int32_t *exif_data = (int32_t *)data;
-                if (count > 1) {
-                    int32_t *values =
-                        (int32_t *)malloc(count * sizeof(int32_t));
-                    if (values == NULL) {
-                        LOGE("No memory for signed long array");
-                        rc = NO_MEMORY;
-                    } else {
-                        memcpy(values, exif_data, count * sizeof(int32_t));
-                        m_Entries[m_nNumEntries].tag_entry.data._slongs =values;
-                    }
-                } else {
-                    m_Entries[m_nNumEntries].tag_entry.data._slong =
-                        *(int32_t *)data;
-                }
-            }
+            entry->data._slongs = (int32_t *)values;
+            break;
+        case EXIF_RATIONAL:
+            entry->data._rats = (rat_t *)values;
             break;
         case EXIF_SRATIONAL:
-            {
-                srat_t *exif_data = (srat_t *)data;
-                if (count > 1) {
-                    srat_t *values = (srat_t *)malloc(count * sizeof(srat_t));
-                    if (values == NULL) {
-                        LOGE("No memory for sign rational array");
-                        rc = NO_MEMORY;
-                    } else {
-                        memcpy(values, exif_data, count * sizeof(srat_t));
-                        m_Entries[m_nNumEntries].tag_entry.data._srats = values;
-                    }
-                } else {
-                    m_Entries[m_nNumEntries].tag_entry.data._srat =
-                        *(srat_t *)data;
-                }
-            }
+            entry->data._srats = (srat_t *)values;
             break;
         default:
-            LOGE("Error, Unknown type");
             break;
+        }
     }
 
     // Increase number of entries
     m_nNumEntries++;
-    return rc;
+    return NO_ERROR;
 }
 
 }; // namespace qcamera
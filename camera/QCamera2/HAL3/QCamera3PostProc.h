@@ -87,6 +87,7 @@ typedef struct {
 } qcamera_hal3_pp_buffer_t;
 
 #define MAX_HAL3_EXIF_TABLE_ENTRIES 23
+#define MAX_HAL3_EXIF_ARENA_SIZE 2048 // bytes of string and array tag data
 class QCamera3Exif
 {
 public:
@@ -101,8 +102,12 @@ public:
     QEXIF_INFO_DATA *getEntries() {return m_Entries;};
 
 private:
+    void *allocData(size_t size);
+
     QEXIF_INFO_DATA m_Entries[MAX_HAL3_EXIF_TABLE_ENTRIES];  // exif tags for JPEG encoder
     uint32_t  m_nNumEntries;                            // number of valid entries
+    uint8_t m_Arena[MAX_HAL3_EXIF_ARENA_SIZE] __attribute__((aligned(8)));  // backing store of tag data
+    size_t m_nArenaUsed;
 };
 
 class QCamera3PostProcessor
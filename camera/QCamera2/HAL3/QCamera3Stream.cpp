@@ -32,6 +32,7 @@
 // Camera dependencies
 #include "QCamera3HWI.h"
 #include "QCamera3Stream.h"
+#include "QCameraBufferMaps.h"
 
 extern "C" {
 #include "mm_camera_dbg.h"
@@ -776,41 +777,40 @@ int32_t QCamera3Stream::getBufs(cam_frame_len_offset_t *offset,
         return NO_MEMORY;
     }
 
+    // Map all the buffers allocated up front with a single message
+    QCameraBufferMaps bufferMaps;
     for (uint32_t i = 0; i < mNumBufs; i++) {
         if (mStreamBufs->valid(i)) {
             ssize_t bufSize = mStreamBufs->getSize(i);
-            if (BAD_INDEX != bufSize) {
-                rc = ops_tbl->map_ops(i, -1, mStreamBufs->getFd(i),
-                        (size_t)bufSize, CAM_MAPPING_BUF_TYPE_STREAM_BUF,
-                        ops_tbl->userdata);
-                if (rc < 0) {
-                    LOGE("map_stream_buf failed: %d", rc);
-                    for (uint32_t j = 0; j < i; j++) {
-                        if (mStreamBufs->valid(j)) {
-                            ops_tbl->unmap_ops(j, -1,
-                                    CAM_MAPPING_BUF_TYPE_STREAM_BUF,
-                                    ops_tbl->userdata);
-                        }
-                    }
-                    return INVALID_OPERATION;
-                }
-            } else {
+            if (BAD_INDEX == bufSize) {
                 LOGE("Failed to retrieve buffer size (bad index)");
                 return INVALID_OPERATION;
             }
+            rc = bufferMaps.enqueue(CAM_MAPPING_BUF_TYPE_STREAM_BUF,
+                    0 /*stream id*/, i /*buf index*/, -1 /*plane index*/,
+                    0 /*cookie*/, mStreamBufs->getFd(i), (size_t)bufSize);
+            if (rc != NO_ERROR) {
+                LOGE("Failed to queue buffer %d for mapping", i);
+                return BAD_INDEX;
+            }
         }
     }
 
+    cam_buf_map_type_list bufMapList;
+    rc = bufferMaps.getCamBufMapList(bufMapList);
+    if (rc == NO_ERROR) {
+        rc = ops_tbl->bundled_map_ops(&bufMapList, ops_tbl->userdata);
+    }
+    if (rc < 0) {
+        LOGE("map_stream_bufs failed: %d", rc);
+        return INVALID_OPERATION;
+    }
+
     //regFlags array is allocated by us, but consumed and freed by mm-camera-interface
     regFlags = (uint8_t *)malloc(sizeof(uint8_t) * mNumBufs);
     if (!regFlags) {
         LOGE("Out of memory");
-        for (uint32_t i = 0; i < mNumBufs; i++) {
-            if (mStreamBufs->valid(i)) {
-                ops_tbl->unmap_ops(i, -1, CAM_MAPPING_BUF_TYPE_STREAM_BUF,
-                        ops_tbl->userdata);
-            }
-        }
+        unmapStreamBufs(ops_tbl, false);
         return NO_MEMORY;
     }
     memset(regFlags, 0, sizeof(uint8_t) * mNumBufs);
@@ -818,12 +818,7 @@ int32_t QCamera3Stream::getBufs(cam_frame_len_offset_t *offset,
     mBufDefs = (mm_camera_buf_def_t *)malloc(mNumBufs * sizeof(mm_camera_buf_def_t));
     if (mBufDefs == NULL) {
         LOGE("Failed to allocate mm_camera_buf_def_t %d", rc);
-        for (uint32_t i = 0; i < mNumBufs; i++) {
-            if (mStreamBufs->valid(i)) {
-                ops_tbl->unmap_ops(i, -1, CAM_MAPPING_BUF_TYPE_STREAM_BUF,
-                        ops_tbl->userdata);
-            }
-        }
+        unmapStreamBufs(ops_tbl, false);
         free(regFlags);
         regFlags = NULL;
         return INVALID_OPERATION;
@@ -838,12 +833,7 @@ int32_t QCamera3Stream::getBufs(cam_frame_len_offset_t *offset,
     rc = mStreamBufs->getRegFlags(regFlags);
     if (rc < 0) {
         LOGE("getRegFlags failed %d", rc);
-        for (uint32_t i = 0; i < mNumBufs; i++) {
-            if (mStreamBufs->valid(i)) {
-                ops_tbl->unmap_ops(i, -1, CAM_MAPPING_BUF_TYPE_STREAM_BUF,
-                        ops_tbl->userdata);
-            }
-        }
+        unmapStreamBufs(ops_tbl, false);
         free(mBufDefs);
         mBufDefs = NULL;
         free(regFlags);
@@ -874,13 +864,9 @@ int32_t QCamera3Stream::putBufs(mm_camera_map_unmap_ops_tbl_t *ops_tbl)
     int rc = NO_ERROR;
     Mutex::Autolock lock(mLock);
 
-    for (uint32_t i = 0; i < mNumBufs; i++) {
-        if (mStreamBufs->valid(i) && NULL != mBufDefs[i].mem_info) {
-            rc = ops_tbl->unmap_ops(i, -1, CAM_MAPPING_BUF_TYPE_STREAM_BUF, ops_tbl->userdata);
-            if (rc < 0) {
-                LOGE("un-map stream buf failed: %d", rc);
-            }
-        }
+    rc = unmapStreamBufs(ops_tbl, true);
+    if (rc < 0) {
+        LOGE("un-map stream bufs failed: %d", rc);
     }
     mBufDefs = NULL; // mBufDefs just keep a ptr to the buffer
                      // mm-camera-interface own the buffer, so no need to free
@@ -898,6 +884,42 @@ int32_t QCamera3Stream::putBufs(mm_camera_map_unmap_ops_tbl_t *ops_tbl)
     return rc;
 }
 
+/*===========================================================================
+ * FUNCTION   : unmapStreamBufs
+ *
+ * DESCRIPTION: unmap the stream buffers from the server with a single
+ *              message
+ *
+ * PARAMETERS :
+ *   @ops_tbl        : ptr to buf mapping/unmapping ops
+ *   @registeredOnly : only unmap buffers that have a buffer definition,
+ *                     i.e. that were mapped
+ *
+ * RETURN     : int32_t type of status
+ *              NO_ERROR  -- success
+ *              none-zero failure code
+ *==========================================================================*/
+int32_t QCamera3Stream::unmapStreamBufs(mm_camera_map_unmap_ops_tbl_t *ops_tbl,
+        bool registeredOnly)
+{
+    cam_buf_unmap_type_list bufUnmapList;
+
+    if ((mStreamBufs == NULL) || (registeredOnly && (mBufDefs == NULL))) {
+        return NO_ERROR;
+    }
+
+    memset(&bufUnmapList, 0, sizeof(bufUnmapList));
+    for (uint32_t i = 0; i < mNumBufs; i++) {
+        if (mStreamBufs->valid(i) &&
+                (!registeredOnly || (NULL != mBufDefs[i].mem_info))) {
+            QCameraBufferMaps::enqueueUnmap(CAM_MAPPING_BUF_TYPE_STREAM_BUF,
+                    i, -1, bufUnmapList);
+        }
+    }
+
+    return ops_tbl->bundled_unmap_ops(&bufUnmapList, ops_tbl->userdata);
+}
+
 /*===========================================================================
  * FUNCTION   : invalidateBuf
  *
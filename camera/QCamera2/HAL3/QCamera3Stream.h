@@ -149,6 +149,8 @@ private:
                      mm_camera_buf_def_t **bufs,
                      mm_camera_map_unmap_ops_tbl_t *ops_tbl);
     int32_t putBufs(mm_camera_map_unmap_ops_tbl_t *ops_tbl);
+    int32_t unmapStreamBufs(mm_camera_map_unmap_ops_tbl_t *ops_tbl,
+            bool registeredOnly);
     int32_t invalidateBuf(uint32_t index);
     int32_t cleanInvalidateBuf(uint32_t index);
     int32_t getBatchBufs(
@@ -41,26 +41,19 @@ using namespace android;
 
 namespace qcamera {
 
-enum qcamera3_ext_tags qcamera3_ext3_section_bounds[QCAMERA3_SECTIONS_END -
-    VENDOR_SECTION] = {
-        QCAMERA3_PRIVATEDATA_END,
-        QCAMERA3_CDS_END,
-        QCAMERA3_OPAQUE_RAW_END,
-        QCAMERA3_CROP_END,
-        QCAMERA3_TUNING_META_DATA_END,
-        QCAMERA3_TEMPORAL_DENOISE_END,
-        QCAMERA3_AV_TIMER_END,
-        QCAMERA3_SENSOR_META_DATA_END,
-        NEXUS_EXPERIMENTAL_2015_END,
-} ;
-
 typedef struct vendor_tag_info {
     const char *tag_name;
     uint8_t     tag_type;
 } vendor_tag_info_t;
 
-const char *qcamera3_ext_section_names[QCAMERA3_SECTIONS_END -
-        VENDOR_SECTION] = {
+/* Each section table is sized by its initializer and checked against the
+ * tag range of the section, so a tag added to QCamera3VendorTags.h without
+ * a name and type here fails to build instead of resolving to NULL. */
+#define VENDOR_TAG_SECTION_CHECK(table, start, end) \
+    static_assert(sizeof(table) / sizeof(table[0]) == (size_t)((end) - (start)), \
+            #table " does not cover " #start " to " #end)
+
+static const char *qcamera3_ext_section_names[] = {
     "org.codeaurora.qcamera3.privatedata",
     "org.codeaurora.qcamera3.CDS",
     "org.codeaurora.qcamera3.opaque_raw",
@@ -71,57 +64,69 @@ const char *qcamera3_ext_section_names[QCAMERA3_SECTIONS_END -
     "org.codeaurora.qcamera3.sensor_meta_data",
     "com.google.nexus.experimental2015"
 };
+VENDOR_TAG_SECTION_CHECK(qcamera3_ext_section_names,
+        VENDOR_SECTION, QCAMERA3_SECTIONS_END);
 
-vendor_tag_info_t qcamera3_privatedata[QCAMERA3_PRIVATEDATA_END - QCAMERA3_PRIVATEDATA_START] = {
+static const vendor_tag_info_t qcamera3_privatedata[] = {
     { "privatedata_reprocess", TYPE_INT32 }
 };
+VENDOR_TAG_SECTION_CHECK(qcamera3_privatedata,
+        QCAMERA3_PRIVATEDATA_START, QCAMERA3_PRIVATEDATA_END);
 
-vendor_tag_info_t qcamera3_cds[QCAMERA3_CDS_END - QCAMERA3_CDS_START] = {
+static const vendor_tag_info_t qcamera3_cds[] = {
     { "cds_mode", TYPE_INT32 },
     { "cds_info", TYPE_BYTE }
 };
+VENDOR_TAG_SECTION_CHECK(qcamera3_cds, QCAMERA3_CDS_START, QCAMERA3_CDS_END);
 
-vendor_tag_info_t qcamera3_opaque_raw[QCAMERA3_OPAQUE_RAW_END -
-        QCAMERA3_OPAQUE_RAW_START] = {
+static const vendor_tag_info_t qcamera3_opaque_raw[] = {
     { "opaque_raw_strides", TYPE_INT32 },
     { "opaque_raw_format", TYPE_BYTE }
 };
+VENDOR_TAG_SECTION_CHECK(qcamera3_opaque_raw,
+        QCAMERA3_OPAQUE_RAW_START, QCAMERA3_OPAQUE_RAW_END);
 
-vendor_tag_info_t qcamera3_crop[QCAMERA3_CROP_END- QCAMERA3_CROP_START] = {
+static const vendor_tag_info_t qcamera3_crop[] = {
     { "count", TYPE_INT32 },
     { "data", TYPE_INT32},
     { "roimap", TYPE_INT32 }
 };
+VENDOR_TAG_SECTION_CHECK(qcamera3_crop, QCAMERA3_CROP_START, QCAMERA3_CROP_END);
 
-vendor_tag_info_t qcamera3_tuning_meta_data[QCAMERA3_TUNING_META_DATA_END -
-        QCAMERA3_TUNING_META_DATA_START] = {
+static const vendor_tag_info_t qcamera3_tuning_meta_data[] = {
     { "tuning_meta_data_blob", TYPE_INT32 }
 };
+VENDOR_TAG_SECTION_CHECK(qcamera3_tuning_meta_data,
+        QCAMERA3_TUNING_META_DATA_START, QCAMERA3_TUNING_META_DATA_END);
 
-vendor_tag_info_t qcamera3_temporal_denoise[QCAMERA3_TEMPORAL_DENOISE_END -
-        QCAMERA3_TEMPORAL_DENOISE_START] = {
+static const vendor_tag_info_t qcamera3_temporal_denoise[] = {
     { "enable", TYPE_BYTE },
     { "process_type", TYPE_INT32 }
 };
+VENDOR_TAG_SECTION_CHECK(qcamera3_temporal_denoise,
+        QCAMERA3_TEMPORAL_DENOISE_START, QCAMERA3_TEMPORAL_DENOISE_END);
 
-vendor_tag_info qcamera3_av_timer[QCAMERA3_AV_TIMER_END -
-                                  QCAMERA3_AV_TIMER_START] = {
+static const vendor_tag_info_t qcamera3_av_timer[] = {
    {"use_av_timer", TYPE_BYTE }
 };
+VENDOR_TAG_SECTION_CHECK(qcamera3_av_timer,
+        QCAMERA3_AV_TIMER_START, QCAMERA3_AV_TIMER_END);
 
-vendor_tag_info qcamera3_sensor_meta_data[QCAMERA3_SENSOR_META_DATA_END -
-                                  QCAMERA3_SENSOR_META_DATA_START] = {
+static const vendor_tag_info_t qcamera3_sensor_meta_data[] = {
    {"dynamic_black_level_pattern", TYPE_FLOAT }
 };
+VENDOR_TAG_SECTION_CHECK(qcamera3_sensor_meta_data,
+        QCAMERA3_SENSOR_META_DATA_START, QCAMERA3_SENSOR_META_DATA_END);
 
-vendor_tag_info_t nexus_experimental_2015[NEXUS_EXPERIMENTAL_2015_END -
-        NEXUS_EXPERIMENTAL_2015_START] = {
+static const vendor_tag_info_t nexus_experimental_2015[] = {
     {"sensor.dynamicBlackLevel", TYPE_FLOAT },
     {"sensor.info.opticallyShieldedRegions", TYPE_INT32 }
 };
+VENDOR_TAG_SECTION_CHECK(nexus_experimental_2015,
+        NEXUS_EXPERIMENTAL_2015_START, NEXUS_EXPERIMENTAL_2015_END);
 
-vendor_tag_info_t *qcamera3_tag_info[QCAMERA3_SECTIONS_END -
-        VENDOR_SECTION] = {
+/* Section tables and their tag counts, both indexed by section - VENDOR_SECTION */
+static const vendor_tag_info_t *qcamera3_tag_info[] = {
     qcamera3_privatedata,
     qcamera3_cds,
     qcamera3_opaque_raw,
@@ -132,8 +137,24 @@ vendor_tag_info_t *qcamera3_tag_info[QCAMERA3_SECTIONS_END -
     qcamera3_sensor_meta_data,
     nexus_experimental_2015,
 };
+VENDOR_TAG_SECTION_CHECK(qcamera3_tag_info,
+        VENDOR_SECTION, QCAMERA3_SECTIONS_END);
+
+static const uint32_t qcamera3_tag_count[] = {
+    QCAMERA3_PRIVATEDATA_END - QCAMERA3_PRIVATEDATA_START,
+    QCAMERA3_CDS_END - QCAMERA3_CDS_START,
+    QCAMERA3_OPAQUE_RAW_END - QCAMERA3_OPAQUE_RAW_START,
+    QCAMERA3_CROP_END - QCAMERA3_CROP_START,
+    QCAMERA3_TUNING_META_DATA_END - QCAMERA3_TUNING_META_DATA_START,
+    QCAMERA3_TEMPORAL_DENOISE_END - QCAMERA3_TEMPORAL_DENOISE_START,
+    QCAMERA3_AV_TIMER_END - QCAMERA3_AV_TIMER_START,
+    QCAMERA3_SENSOR_META_DATA_END - QCAMERA3_SENSOR_META_DATA_START,
+    NEXUS_EXPERIMENTAL_2015_END - NEXUS_EXPERIMENTAL_2015_START,
+};
+VENDOR_TAG_SECTION_CHECK(qcamera3_tag_count,
+        VENDOR_SECTION, QCAMERA3_SECTIONS_END);
 
-uint32_t qcamera3_all_tags[] = {
+static const uint32_t qcamera3_all_tags[] = {
     // QCAMERA3_PRIVATEDATA
     (uint32_t)QCAMERA3_PRIVATEDATA_REPROCESS,
 
@@ -166,6 +187,17 @@ uint32_t qcamera3_all_tags[] = {
     (uint32_t)NEXUS_EXPERIMENTAL_2015_SENSOR_DYNAMIC_BLACK_LEVEL,
     (uint32_t)NEXUS_EXPERIMENTAL_2015_SENSOR_INFO_OPTICALLY_SHIELDED_REGIONS,
 };
+static_assert(sizeof(qcamera3_all_tags) / sizeof(qcamera3_all_tags[0]) ==
+        (size_t)((QCAMERA3_PRIVATEDATA_END - QCAMERA3_PRIVATEDATA_START) +
+        (QCAMERA3_CDS_END - QCAMERA3_CDS_START) +
+        (QCAMERA3_OPAQUE_RAW_END - QCAMERA3_OPAQUE_RAW_START) +
+        (QCAMERA3_CROP_END - QCAMERA3_CROP_START) +
+        (QCAMERA3_TUNING_META_DATA_END - QCAMERA3_TUNING_META_DATA_START) +
+        (QCAMERA3_TEMPORAL_DENOISE_END - QCAMERA3_TEMPORAL_DENOISE_START) +
+        (QCAMERA3_AV_TIMER_END - QCAMERA3_AV_TIMER_START) +
+        (QCAMERA3_SENSOR_META_DATA_END - QCAMERA3_SENSOR_META_DATA_START) +
+        (NEXUS_EXPERIMENTAL_2015_END - NEXUS_EXPERIMENTAL_2015_START)),
+        "qcamera3_all_tags does not list every vendor tag");
 
 const vendor_tag_ops_t* QCamera3VendorTags::Ops = NULL;
 
@@ -244,7 +276,6 @@ void QCamera3VendorTags::get_all_tags(
             i < sizeof(qcamera3_all_tags)/sizeof(qcamera3_all_tags[0]);
             i++) {
         g_array[i] = qcamera3_all_tags[i];
-        LOGD("g_array[%d] is %d", i, g_array[i]);
     }
 }
 
@@ -266,7 +297,6 @@ const char* QCamera3VendorTags::get_section_name(
                 const vendor_tag_ops_t * ops,
                 uint32_t tag)
 {
-    LOGL("E");
     if (ops != Ops)
         return NULL;
 
@@ -278,9 +308,6 @@ const char* QCamera3VendorTags::get_section_name(
     else
         ret = qcamera3_ext_section_names[section - VENDOR_SECTION];
 
-    if (ret)
-        LOGL("section_name[%d] is %s", tag, ret);
-    LOGL("X");
     return ret;
 }
 
@@ -300,7 +327,6 @@ const char* QCamera3VendorTags::get_tag_name(
                 const vendor_tag_ops_t * ops,
                 uint32_t tag)
 {
-    LOGL("E");
     const char *ret;
     uint32_t section = tag >> 16;
     uint32_t section_index = section - VENDOR_SECTION;
@@ -313,15 +339,11 @@ const char* QCamera3VendorTags::get_tag_name(
 
     if (section < VENDOR_SECTION || section >= QCAMERA3_SECTIONS_END)
         ret = NULL;
-    else if (tag >= (uint32_t)qcamera3_ext3_section_bounds[section_index])
+    else if (tag_index >= qcamera3_tag_count[section_index])
         ret = NULL;
     else
         ret = qcamera3_tag_info[section_index][tag_index].tag_name;
 
-    if (ret)
-        LOGL("tag name for tag %d is %s", tag, ret);
-    LOGL("X");
-
 done:
     return ret;
 }
@@ -342,7 +364,6 @@ int QCamera3VendorTags::get_tag_type(
                 const vendor_tag_ops_t *ops,
                 uint32_t tag)
 {
-    LOGL("E");
     int ret;
     uint32_t section = tag >> 16;
     uint32_t section_index = section - VENDOR_SECTION;
@@ -354,13 +375,11 @@ int QCamera3VendorTags::get_tag_type(
     }
     if (section < VENDOR_SECTION || section >= QCAMERA3_SECTIONS_END)
         ret = -1;
-    else if (tag >= (uint32_t )qcamera3_ext3_section_bounds[section_index])
+    else if (tag_index >= qcamera3_tag_count[section_index])
         ret = -1;
     else
         ret = qcamera3_tag_info[section_index][tag_index].tag_type;
 
-    LOGL("tag type for tag %d is %d", tag, ret);
-    LOGL("X");
 done:
     return ret;
 }
@@ -30,8 +30,10 @@
 #define LOG_TAG "QCamera2Factory"
 
 // System dependencies
+#include <pthread.h>
 #include <stdlib.h>
 #include <utils/Errors.h>
+#include <utils/Timers.h>
 #include <cutils/properties.h>
 
 // Camera dependencies
@@ -76,10 +78,12 @@ volatile uint32_t gKpiDebugLevel = 1;
  *==========================================================================*/
 QCamera2Factory::QCamera2Factory()
 {
-    camera_info info;
     mHalDescriptors = NULL;
     mCallbacks = NULL;
+    nsecs_t probeStart = systemTime();
     mNumOfCameras = get_num_of_cameras();
+    LOGI("[KPI Perf] %d cameras probed in %lld ms", mNumOfCameras,
+            (long long)ns2ms(systemTime() - probeStart));
     int bDualCamera = 0;
     char prop[PROPERTY_VALUE_MAX];
     property_get("persist.camera.HAL3.enabled", prop, "1");
@@ -126,11 +130,11 @@ QCamera2Factory::QCamera2Factory()
                     mHalDescriptors[i].device_version =
                             CAMERA_DEVICE_API_VERSION_1_0;
                 }
-                //Query camera at this point in order
-                //to avoid any delays during subsequent
-                //calls to 'getCameraInfo()'
-                getCameraInfo(i, &info);
             }
+            //Query cameras at this point in order
+            //to avoid any delays during subsequent
+            //calls to 'getCameraInfo()'
+            queryCameraInfo();
         } else {
             LOGE("Not enough resources to allocate HAL descriptor table!");
         }
@@ -139,6 +143,72 @@ QCamera2Factory::QCamera2Factory()
     }
 }
 
+/*===========================================================================
+ * FUNCTION   : queryCameraInfo
+ *
+ * DESCRIPTION: query capabilities and static metadata of all cameras. Each
+ *              camera is opened, queried and closed on a thread of its own
+ *              since the backend sessions of different sensors are
+ *              independent.
+ *
+ * PARAMETERS : none
+ *
+ * RETURN     : none
+ *==========================================================================*/
+void QCamera2Factory::queryCameraInfo()
+{
+    cam_info_query_job_t jobs[MM_CAMERA_MAX_NUM_SENSORS];
+    pthread_t threads[MM_CAMERA_MAX_NUM_SENSORS];
+    bool launched[MM_CAMERA_MAX_NUM_SENSORS];
+    nsecs_t queryStart = systemTime();
+
+    for (int i = 0; i < mNumOfCameras; i++) {
+        jobs[i].factory = this;
+        jobs[i].camera_id = i;
+        jobs[i].rc = NO_ERROR;
+        launched[i] = false;
+        if (pthread_create(&threads[i], NULL, queryCameraInfoRoutine,
+                &jobs[i]) == 0) {
+            pthread_setname_np(threads[i], "CAM_infoQuery");
+            launched[i] = true;
+        } else {
+            // Fall back to querying in the caller context
+            queryCameraInfoRoutine(&jobs[i]);
+        }
+    }
+
+    for (int i = 0; i < mNumOfCameras; i++) {
+        if (launched[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        if (jobs[i].rc != NO_ERROR) {
+            // Not fatal, the query is retried on the next getCameraInfo
+            LOGE("Querying camera id %d failed %d", i, jobs[i].rc);
+        }
+    }
+    LOGI("[KPI Perf] %d cameras queried in %lld ms", mNumOfCameras,
+            (long long)ns2ms(systemTime() - queryStart));
+}
+
+/*===========================================================================
+ * FUNCTION   : queryCameraInfoRoutine
+ *
+ * DESCRIPTION: thread routine querying the info of one camera
+ *
+ * PARAMETERS :
+ *   @data    : ptr to cam_info_query_job_t
+ *
+ * RETURN     : NULL
+ *==========================================================================*/
+void *QCamera2Factory::queryCameraInfoRoutine(void *data)
+{
+    cam_info_query_job_t *job = (cam_info_query_job_t *)data;
+    struct camera_info info;
+
+    job->rc = job->factory->getCameraInfo(job->camera_id, &info);
+    return NULL;
+}
+
 /*===========================================================================
  * FUNCTION   : ~QCamera2Factory
  *
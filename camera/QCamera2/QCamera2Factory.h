@@ -40,6 +40,14 @@ typedef struct {
     uint32_t device_version;
 } hal_desc;
 
+class QCamera2Factory;
+
+typedef struct {
+    QCamera2Factory *factory;
+    int camera_id;
+    int rc;
+} cam_info_query_job_t;
+
 class QCamera2Factory
 {
 public:
@@ -63,6 +71,8 @@ private:
     static int openLegacy(
             int32_t cameraId, uint32_t halVersion, struct hw_device_t** hw_device);
     int setTorchMode(const char* camera_id, bool on);
+    void queryCameraInfo();
+    static void *queryCameraInfoRoutine(void *data);
 public:
     static struct hw_module_methods_t mModuleMethods;
 
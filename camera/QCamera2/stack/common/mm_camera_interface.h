@@ -241,17 +241,29 @@ typedef int32_t (*unmap_stream_buf_op_t) (uint32_t frame_idx,
                                           cam_mapping_buf_type type,
                                           void *userdata);
 
+/** unmap_stream_bufs_op_t: function definition for operation of
+*                           unmapping a list of stream buffers
+*                           with a single domain socket message
+*    @buf_unmap_list : list of buffers to unmap
+*    @userdata : user data pointer
+**/
+typedef int32_t (*unmap_stream_bufs_op_t) (const cam_buf_unmap_type_list *buf_unmap_list,
+                                           void *userdata);
+
 /** mm_camera_map_unmap_ops_tbl_t: virtual table
 *                      for mapping/unmapping stream buffers via
 *                      domain socket
 *    @map_ops : operation for mapping
+*    @bundled_map_ops : operation for mapping a list of buffers
 *    @unmap_ops : operation for unmapping
+*    @bundled_unmap_ops : operation for unmapping a list of buffers
 *    @userdata: user data pointer
 **/
 typedef struct {
     map_stream_buf_op_t map_ops;
     map_stream_bufs_op_t bundled_map_ops;
     unmap_stream_buf_op_t unmap_ops;
+    unmap_stream_bufs_op_t bundled_unmap_ops;
     void *userdata;
 } mm_camera_map_unmap_ops_tbl_t;
 
@@ -913,4 +925,6 @@ struct camera_info *get_cam_info(uint32_t camera_id, cam_sync_type_t *pCamType);
 
 uint8_t is_yuv_sensor(uint32_t camera_id);
 
+const char *get_sensor_name(uint32_t camera_id);
+
 #endif /*__MM_CAMERA_INTERFACE_H__*/
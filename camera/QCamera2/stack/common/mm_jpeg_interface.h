@@ -279,6 +279,10 @@ typedef struct {
 
   /* work buf */
   mm_jpeg_buf_t work_buf;
+
+  /* schedule ahead of queued jobs of other sessions,
+   * e.g. for the shutter frame of a capture */
+  uint8_t priority;
 } mm_jpeg_encode_job_t;
 
 typedef struct {
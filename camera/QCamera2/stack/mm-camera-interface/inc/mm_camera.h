@@ -291,6 +291,10 @@ typedef struct mm_stream {
 
     /* Need to wait for buffer mapping before stream-on*/
     pthread_cond_t buf_cond;
+
+    /* map/unmap traffic to the server, protected by buf_lock */
+    uint32_t map_msg_cnt; /* socket round trips */
+    uint32_t map_buf_cnt; /* buffers mapped or unmapped */
 } mm_stream_t;
 
 /* mm_channel */
@@ -542,6 +546,7 @@ typedef struct {
     cam_sync_type_t cam_type[MM_CAMERA_MAX_NUM_SENSORS];
     cam_sync_mode_t cam_mode[MM_CAMERA_MAX_NUM_SENSORS];
     uint8_t is_yuv[MM_CAMERA_MAX_NUM_SENSORS]; // 1=CAM_SENSOR_YUV, 0=CAM_SENSOR_RAW
+    char sensor_name[MM_CAMERA_MAX_NUM_SENSORS][MM_CAMERA_DEV_NAME_LEN]; // sensor subdev entity name
 } mm_camera_ctrl_t;
 
 typedef enum {
@@ -726,6 +731,8 @@ extern int32_t mm_stream_unmap_buf(mm_stream_t *my_obj,
                                    uint8_t buf_type,
                                    uint32_t frame_idx,
                                    int32_t plane_idx);
+extern int32_t mm_stream_unmap_bufs(mm_stream_t *my_obj,
+                                    const cam_buf_unmap_type_list *buf_unmap_list);
 
 
 /* utiltity fucntion declared in mm-camera-inteface2.c
@@ -1556,6 +1556,8 @@ void get_sensor_info()
                 g_cam_ctrl.info[num_cameras].orientation = (int)mount_angle;
                 g_cam_ctrl.cam_type[num_cameras] = type;
                 g_cam_ctrl.is_yuv[num_cameras] = is_yuv;
+                strlcpy(g_cam_ctrl.sensor_name[num_cameras], entity.name,
+                        MM_CAMERA_DEV_NAME_LEN);
                 LOGD("dev_info[id=%zu,name='%s']\n",
                          num_cameras, g_cam_ctrl.video_dev_name[num_cameras]);
                 num_cameras++;
@@ -1589,9 +1591,11 @@ void sort_camera_info(int num_cam)
     cam_sync_mode_t temp_mode[MM_CAMERA_MAX_NUM_SENSORS];
     uint8_t temp_is_yuv[MM_CAMERA_MAX_NUM_SENSORS];
     char temp_dev_name[MM_CAMERA_MAX_NUM_SENSORS][MM_CAMERA_DEV_NAME_LEN];
+    char temp_sensor_name[MM_CAMERA_MAX_NUM_SENSORS][MM_CAMERA_DEV_NAME_LEN];
 
     memset(temp_info, 0, sizeof(temp_info));
     memset(temp_dev_name, 0, sizeof(temp_dev_name));
+    memset(temp_sensor_name, 0, sizeof(temp_sensor_name));
     memset(temp_type, 0, sizeof(temp_type));
     memset(temp_mode, 0, sizeof(temp_mode));
     memset(temp_is_yuv, 0, sizeof(temp_is_yuv));
@@ -1624,6 +1628,8 @@ void sort_camera_info(int num_cam)
             temp_type[idx] = g_cam_ctrl.cam_type[i];
             temp_mode[idx] = g_cam_ctrl.cam_mode[i];
             temp_is_yuv[idx] = g_cam_ctrl.is_yuv[i];
+            memcpy(temp_sensor_name[idx], g_cam_ctrl.sensor_name[i],
+                MM_CAMERA_DEV_NAME_LEN);
             LOGD("Found Back Main Camera: i: %d idx: %d", i, idx);
             memcpy(temp_dev_name[idx++],g_cam_ctrl.video_dev_name[i],
                 MM_CAMERA_DEV_NAME_LEN);
@@ -1639,6 +1645,8 @@ void sort_camera_info(int num_cam)
                 temp_type[idx] = g_cam_ctrl.cam_type[i];
                 temp_mode[idx] = g_cam_ctrl.cam_mode[i];
                 temp_is_yuv[idx] = g_cam_ctrl.is_yuv[i];
+                memcpy(temp_sensor_name[idx], g_cam_ctrl.sensor_name[i],
+                    MM_CAMERA_DEV_NAME_LEN);
                 LOGD("Found Back Aux Camera: i: %d idx: %d", i, idx);
                 memcpy(temp_dev_name[idx++],g_cam_ctrl.video_dev_name[i],
                     MM_CAMERA_DEV_NAME_LEN);
@@ -1655,6 +1663,8 @@ void sort_camera_info(int num_cam)
                 temp_type[idx] = g_cam_ctrl.cam_type[i];
                 temp_mode[idx] = g_cam_ctrl.cam_mode[i];
                 temp_is_yuv[idx] = g_cam_ctrl.is_yuv[i];
+                memcpy(temp_sensor_name[idx], g_cam_ctrl.sensor_name[i],
+                    MM_CAMERA_DEV_NAME_LEN);
                 LOGD("Found Front Main Camera: i: %d idx: %d", i, idx);
                 memcpy(temp_dev_name[idx++],g_cam_ctrl.video_dev_name[i],
                     MM_CAMERA_DEV_NAME_LEN);
@@ -1671,6 +1681,8 @@ void sort_camera_info(int num_cam)
             temp_type[idx] = g_cam_ctrl.cam_type[i];
             temp_mode[idx] = g_cam_ctrl.cam_mode[i];
             temp_is_yuv[idx] = g_cam_ctrl.is_yuv[i];
+            memcpy(temp_sensor_name[idx], g_cam_ctrl.sensor_name[i],
+                MM_CAMERA_DEV_NAME_LEN);
             LOGD("Found Front Aux Camera: i: %d idx: %d", i, idx);
             memcpy(temp_dev_name[idx++],g_cam_ctrl.video_dev_name[i],
                 MM_CAMERA_DEV_NAME_LEN);
@@ -1683,6 +1695,7 @@ void sort_camera_info(int num_cam)
         memcpy(g_cam_ctrl.cam_mode, temp_mode, sizeof(temp_mode));
         memcpy(g_cam_ctrl.is_yuv, temp_is_yuv, sizeof(temp_is_yuv));
         memcpy(g_cam_ctrl.video_dev_name, temp_dev_name, sizeof(temp_dev_name));
+        memcpy(g_cam_ctrl.sensor_name, temp_sensor_name, sizeof(temp_sensor_name));
         //Set num cam based on the cameras exposed finally via dual/aux properties.
         g_cam_ctrl.num_cam = idx;
         for (i = 0; i < idx; i++) {
@@ -1955,6 +1968,11 @@ uint8_t is_yuv_sensor(uint32_t camera_id)
     return g_cam_ctrl.is_yuv[camera_id];
 }
 
+const char *get_sensor_name(uint32_t camera_id)
+{
+    return g_cam_ctrl.sensor_name[camera_id];
+}
+
 /* camera ops v-table */
 static mm_camera_ops_t mm_camera_ops = {
     .query_capability = mm_camera_intf_query_capability,
@@ -28,6 +28,7 @@
  */
 
 // System dependencies
+#include <cutils/properties.h>
 #include <stdlib.h>
 #include <pthread.h>
 #include <errno.h>
@@ -1026,6 +1027,50 @@ static int32_t mm_stream_unmap_buf_ops(uint32_t frame_idx,
                                plane_idx);
 }
 
+/*===========================================================================
+ * FUNCTION   : mm_stream_bundled_unmap_buf_ops
+ *
+ * DESCRIPTION: ops for unmapping a list of stream buffers via domain socket
+ *              to server with a single message. This function will be passed
+ *              to upper layer as part of ops table to be used by upper layer
+ *              when releasing stream buffers.
+ *
+ * PARAMETERS :
+ *   @buf_unmap_list : list of buffers to unmap
+ *   @userdata       : user data ptr (stream object)
+ *
+ * RETURN     : int32_t type of status
+ *              0  -- success
+ *              -1 -- failure
+ *==========================================================================*/
+static int32_t mm_stream_bundled_unmap_buf_ops(
+        const cam_buf_unmap_type_list *buf_unmap_list,
+        void *userdata)
+{
+    mm_stream_t *my_obj = (mm_stream_t *)userdata;
+    return mm_stream_unmap_bufs(my_obj,
+                                buf_unmap_list);
+}
+
+/*===========================================================================
+ * FUNCTION   : mm_stream_count_map_msg
+ *
+ * DESCRIPTION: account one map/unmap round trip to the server
+ *
+ * PARAMETERS :
+ *   @my_obj       : stream object
+ *   @num_bufs     : number of buffers carried by the message
+ *
+ * RETURN     : none
+ *==========================================================================*/
+static void mm_stream_count_map_msg(mm_stream_t *my_obj, uint32_t num_bufs)
+{
+    pthread_mutex_lock(&my_obj->buf_lock);
+    my_obj->map_msg_cnt++;
+    my_obj->map_buf_cnt += num_bufs;
+    pthread_mutex_unlock(&my_obj->buf_lock);
+}
+
 /*===========================================================================
  * FUNCTION   : mm_stream_config
  *
@@ -1077,6 +1122,7 @@ int32_t mm_stream_config(mm_stream_t *my_obj,
     my_obj->map_ops.map_ops = mm_stream_map_buf_ops;
     my_obj->map_ops.bundled_map_ops = mm_stream_bundled_map_buf_ops;
     my_obj->map_ops.unmap_ops = mm_stream_unmap_buf_ops;
+    my_obj->map_ops.bundled_unmap_ops = mm_stream_bundled_unmap_buf_ops;
     my_obj->map_ops.userdata = my_obj;
 
     if(my_obj->mem_vtbl.set_config_ops != NULL) {
@@ -1850,6 +1896,7 @@ int32_t mm_stream_map_buf(mm_stream_t * my_obj,
              buf_type, my_obj->server_stream_id, frame_idx, fd, size);
     rc = mm_camera_util_sendmsg(my_obj->ch_obj->cam_obj,
             &packet, sizeof(cam_sock_packet_t), fd);
+    mm_stream_count_map_msg(my_obj, 1);
 
     if ((buf_type == CAM_MAPPING_BUF_TYPE_STREAM_BUF)
             || ((buf_type
@@ -1922,6 +1969,7 @@ int32_t mm_stream_map_bufs(mm_stream_t * my_obj,
 
     int32_t ret = mm_camera_util_bundled_sendmsg(my_obj->ch_obj->cam_obj,
             &packet, sizeof(cam_sock_packet_t), sendfds, numbufs);
+    mm_stream_count_map_msg(my_obj, numbufs);
     if ((numbufs > 0) && ((buf_map_list->buf_maps[0].type
             == CAM_MAPPING_BUF_TYPE_STREAM_BUF)
             || ((buf_map_list->buf_maps[0].type ==
@@ -1931,10 +1979,14 @@ int32_t mm_stream_map_bufs(mm_stream_t * my_obj,
             == CAM_STREAMING_MODE_BATCH)))) {
         pthread_mutex_lock(&my_obj->buf_lock);
         for (i = 0; i < numbufs; i++) {
+           uint32_t frame_idx = buf_map_list->buf_maps[i].frame_idx;
+           if (frame_idx >= CAM_MAX_NUM_BUFS_PER_STREAM) {
+               continue;
+           }
            if (ret < 0) {
-               my_obj->buf_status[i].map_status = -1;
+               my_obj->buf_status[frame_idx].map_status = -1;
            } else {
-               my_obj->buf_status[i].map_status = 1;
+               my_obj->buf_status[frame_idx].map_status = 1;
            }
         }
 
@@ -1990,12 +2042,95 @@ int32_t mm_stream_unmap_buf(mm_stream_t * my_obj,
             &packet,
             sizeof(cam_sock_packet_t),
             -1);
+    mm_stream_count_map_msg(my_obj, 1);
     pthread_mutex_lock(&my_obj->buf_lock);
     my_obj->buf_status[frame_idx].map_status = 0;
     pthread_mutex_unlock(&my_obj->buf_lock);
     return ret;
 }
 
+/*===========================================================================
+ * FUNCTION   : mm_stream_unmap_bufs
+ *
+ * DESCRIPTION: unmapping a list of stream buffers via domain socket to server
+ *              with a single message when persist.camera.bundled.unmap is
+ *              set. Otherwise the buffers are unmapped one by one.
+ *
+ * PARAMETERS :
+ *   @my_obj         : stream object
+ *   @buf_unmap_list : list of buffers to unmap
+ *
+ * RETURN     : int32_t type of status
+ *              0  -- success
+ *              -1 -- failure
+ *==========================================================================*/
+int32_t mm_stream_unmap_bufs(mm_stream_t * my_obj,
+                             const cam_buf_unmap_type_list *buf_unmap_list)
+{
+    if (NULL == my_obj || NULL == my_obj->ch_obj || NULL == my_obj->ch_obj->cam_obj) {
+        LOGE("NULL obj of stream/channel/camera");
+        return -1;
+    }
+
+    uint32_t i;
+    int32_t ret = 0;
+    char prop[PROPERTY_VALUE_MAX];
+    uint32_t numbufs = buf_unmap_list->length;
+    if (numbufs < 1) {
+        LOGD("No buffers, suppressing the unmapping command");
+        return 0;
+    }
+    if (numbufs > CAM_MAX_NUM_BUFS_PER_STREAM) {
+        LOGE("Too many buffers %u", numbufs);
+        return -1;
+    }
+
+    /* Only servers known to ack bundled unmapping get it. Any other server
+     * would leave us waiting for MAP_UNMAP_DONE until the event times out. */
+    memset(prop, 0, sizeof(prop));
+    property_get("persist.camera.bundled.unmap", prop, "0");
+    if (atoi(prop) == 0) {
+        for (i = 0; i < numbufs; i++) {
+            const cam_buf_unmap_type *unmap = &buf_unmap_list->buf_unmaps[i];
+            if (mm_stream_unmap_buf(my_obj, (uint8_t)unmap->type,
+                    unmap->frame_idx, unmap->plane_idx) < 0) {
+                ret = -1;
+            }
+        }
+        return ret;
+    }
+
+    cam_sock_packet_t packet;
+    memset(&packet, 0, sizeof(cam_sock_packet_t));
+    packet.msg_type = CAM_MAPPING_TYPE_FD_BUNDLED_UNMAPPING;
+    memcpy(&packet.payload.buf_unmap_list, buf_unmap_list,
+           sizeof(packet.payload.buf_unmap_list));
+    for (i = 0; i < numbufs; i++) {
+        packet.payload.buf_unmap_list.buf_unmaps[i].stream_id =
+                my_obj->server_stream_id;
+    }
+
+    ret = mm_camera_util_sendmsg(my_obj->ch_obj->cam_obj,
+            &packet,
+            sizeof(cam_sock_packet_t),
+            -1);
+    mm_stream_count_map_msg(my_obj, numbufs);
+    if (ret < 0) {
+        LOGE("Bundled unmapping of %u buffers failed", numbufs);
+        return ret;
+    }
+
+    pthread_mutex_lock(&my_obj->buf_lock);
+    for (i = 0; i < numbufs; i++) {
+        uint32_t frame_idx = buf_unmap_list->buf_unmaps[i].frame_idx;
+        if (frame_idx < CAM_MAX_NUM_BUFS_PER_STREAM) {
+            my_obj->buf_status[frame_idx].map_status = 0;
+        }
+    }
+    pthread_mutex_unlock(&my_obj->buf_lock);
+    return ret;
+}
+
 /*===========================================================================
  * FUNCTION   : mm_stream_init_bufs
  *
@@ -2100,11 +2235,19 @@ int32_t mm_stream_deinit_bufs(mm_stream_t * my_obj)
     ops_tbl.map_ops = mm_stream_map_buf_ops;
     ops_tbl.bundled_map_ops = mm_stream_bundled_map_buf_ops;
     ops_tbl.unmap_ops = mm_stream_unmap_buf_ops;
+    ops_tbl.bundled_unmap_ops = mm_stream_bundled_unmap_buf_ops;
     ops_tbl.userdata = my_obj;
 
     rc = my_obj->mem_vtbl.put_bufs(&ops_tbl,
                                    my_obj->mem_vtbl.user_data);
 
+    pthread_mutex_lock(&my_obj->buf_lock);
+    LOGH("stream %d: %u buffers mapped/unmapped in %u socket round trips",
+          my_obj->server_stream_id, my_obj->map_buf_cnt, my_obj->map_msg_cnt);
+    my_obj->map_msg_cnt = 0;
+    my_obj->map_buf_cnt = 0;
+    pthread_mutex_unlock(&my_obj->buf_lock);
+
     if (my_obj->plane_buf != NULL) {
         free(my_obj->plane_buf);
         my_obj->plane_buf = NULL;
@@ -2288,7 +2431,7 @@ uint32_t mm_stream_get_v4l2_fmt(cam_format_t fmt)
 }
 
 /*===========================================================================
- * FUNCTION   : mm_stream_calc_offset_preview
+ * FUNCTION   : mm_stream_compute_offset_preview
  *
  * DESCRIPTION: calculate preview frame offset based on format and
  *              padding information
@@ -2302,10 +2445,10 @@ uint32_t mm_stream_get_v4l2_fmt(cam_format_t fmt)
  *              0  -- success
  *              -1 -- failure
  *==========================================================================*/
-int32_t mm_stream_calc_offset_preview(cam_stream_info_t *stream_info,
-                                      cam_dimension_t *dim,
-                                      cam_padding_info_t *padding,
-                                      cam_stream_buf_plane_info_t *buf_planes)
+static int32_t mm_stream_compute_offset_preview(cam_stream_info_t *stream_info,
+                                                cam_dimension_t *dim,
+                                                cam_padding_info_t *padding,
+                                                cam_stream_buf_plane_info_t *buf_planes)
 {
     int32_t rc = 0;
     int stride = 0, scanline = 0;
@@ -2589,7 +2732,7 @@ int32_t mm_stream_calc_offset_preview(cam_stream_info_t *stream_info,
     return rc;
 }
 /*===========================================================================
- * FUNCTION   : mm_stream_calc_offset_post_view
+ * FUNCTION   : mm_stream_compute_offset_post_view
  *
  * DESCRIPTION: calculate postview frame offset based on format and
  *              padding information
@@ -2603,9 +2746,9 @@ int32_t mm_stream_calc_offset_preview(cam_stream_info_t *stream_info,
  *              0  -- success
  *              -1 -- failure
  *==========================================================================*/
-int32_t mm_stream_calc_offset_post_view(cam_format_t fmt,
-                                      cam_dimension_t *dim,
-                                      cam_stream_buf_plane_info_t *buf_planes)
+static int32_t mm_stream_compute_offset_post_view(cam_format_t fmt,
+                                                cam_dimension_t *dim,
+                                                cam_stream_buf_plane_info_t *buf_planes)
 {
     int32_t rc = 0;
     int stride = 0, scanline = 0;
@@ -2877,7 +3020,7 @@ int32_t mm_stream_calc_offset_post_view(cam_format_t fmt,
 }
 
 /*===========================================================================
- * FUNCTION   : mm_stream_calc_offset_snapshot
+ * FUNCTION   : mm_stream_compute_offset_snapshot
  *
  * DESCRIPTION: calculate snapshot/postproc frame offset based on format and
  *              padding information
@@ -2892,10 +3035,10 @@ int32_t mm_stream_calc_offset_post_view(cam_format_t fmt,
  *              0  -- success
  *              -1 -- failure
  *==========================================================================*/
-int32_t mm_stream_calc_offset_snapshot(cam_format_t fmt,
-                                       cam_dimension_t *dim,
-                                       cam_padding_info_t *padding,
-                                       cam_stream_buf_plane_info_t *buf_planes)
+static int32_t mm_stream_compute_offset_snapshot(cam_format_t fmt,
+                                                 cam_dimension_t *dim,
+                                                 cam_padding_info_t *padding,
+                                                 cam_stream_buf_plane_info_t *buf_planes)
 {
     int32_t rc = 0;
     uint8_t isAFamily = mm_camera_util_chip_is_a_family();
@@ -3170,7 +3313,7 @@ int32_t mm_stream_calc_offset_snapshot(cam_format_t fmt,
 }
 
 /*===========================================================================
- * FUNCTION   : mm_stream_calc_offset_raw
+ * FUNCTION   : mm_stream_compute_offset_raw
  *
  * DESCRIPTION: calculate raw frame offset based on format and padding information
  *
@@ -3184,10 +3327,10 @@ int32_t mm_stream_calc_offset_snapshot(cam_format_t fmt,
  *              0  -- success
  *              -1 -- failure
  *==========================================================================*/
-int32_t mm_stream_calc_offset_raw(cam_format_t fmt,
-                                  cam_dimension_t *dim,
-                                  cam_padding_info_t *padding,
-                                  cam_stream_buf_plane_info_t *buf_planes)
+static int32_t mm_stream_compute_offset_raw(cam_format_t fmt,
+                                            cam_dimension_t *dim,
+                                            cam_padding_info_t *padding,
+                                            cam_stream_buf_plane_info_t *buf_planes)
 {
     int32_t rc = 0;
 
@@ -3461,7 +3604,7 @@ int32_t mm_stream_calc_offset_raw(cam_format_t fmt,
 }
 
 /*===========================================================================
- * FUNCTION   : mm_stream_calc_offset_video
+ * FUNCTION   : mm_stream_compute_offset_video
  *
  * DESCRIPTION: calculate video frame offset based on format and
  *              padding information
@@ -3475,7 +3618,7 @@ int32_t mm_stream_calc_offset_raw(cam_format_t fmt,
  *              0  -- success
  *              -1 -- failure
  *==========================================================================*/
-int32_t mm_stream_calc_offset_video(cam_format_t fmt,
+static int32_t mm_stream_compute_offset_video(cam_format_t fmt,
         cam_dimension_t *dim, cam_stream_buf_plane_info_t *buf_planes)
 {
     int32_t rc = 0;
@@ -3686,7 +3829,7 @@ int32_t mm_stream_calc_offset_metadata(cam_dimension_t *dim,
 }
 
 /*===========================================================================
- * FUNCTION   : mm_stream_calc_offset_analysis
+ * FUNCTION   : mm_stream_compute_offset_analysis
  *
  * DESCRIPTION: calculate analysis frame offset based on format and
  *              padding information
@@ -3701,10 +3844,10 @@ int32_t mm_stream_calc_offset_metadata(cam_dimension_t *dim,
  *              0  -- success
  *              -1 -- failure
  *==========================================================================*/
-int32_t mm_stream_calc_offset_analysis(cam_format_t fmt,
-                                       cam_dimension_t *dim,
-                                       cam_padding_info_t *padding,
-                                       cam_stream_buf_plane_info_t *buf_planes)
+static int32_t mm_stream_compute_offset_analysis(cam_format_t fmt,
+                                                 cam_dimension_t *dim,
+                                                 cam_padding_info_t *padding,
+                                                 cam_stream_buf_plane_info_t *buf_planes)
 {
     int32_t rc = 0;
     int32_t offset_x = 0, offset_y = 0;
@@ -3877,6 +4020,341 @@ int32_t mm_stream_calc_offset_analysis(cam_format_t fmt,
     return rc;
 }
 
+/* Number of (kind, format, dimension, padding) results kept by the
+ * offset cache. A session rarely configures more than a handful of
+ * distinct streams, so this covers mode switches without eviction. */
+#define MM_STREAM_OFFSET_CACHE_SIZE 32
+
+typedef enum {
+    MM_STREAM_OFFSET_PREVIEW,
+    MM_STREAM_OFFSET_POST_VIEW,
+    MM_STREAM_OFFSET_SNAPSHOT,
+    MM_STREAM_OFFSET_RAW,
+    MM_STREAM_OFFSET_VIDEO,
+    MM_STREAM_OFFSET_ANALYSIS,
+} mm_stream_offset_kind_t;
+
+typedef struct {
+    mm_stream_offset_kind_t kind;
+    cam_format_t fmt;
+    uint32_t offline_proc; /* preview layout differs for offline proc */
+    cam_dimension_t dim;
+    cam_padding_info_t padding;
+} mm_stream_offset_key_t;
+
+typedef struct {
+    uint8_t valid;
+    mm_stream_offset_key_t key;
+    cam_stream_buf_plane_info_t planes;
+    /* bytes of planes written by the calculation; the rest are left
+     * untouched in the caller's buffer, exactly as a direct call would */
+    uint8_t written[sizeof(cam_stream_buf_plane_info_t)];
+} mm_stream_offset_entry_t;
+
+static pthread_mutex_t g_offset_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static mm_stream_offset_entry_t g_offset_cache[MM_STREAM_OFFSET_CACHE_SIZE];
+static uint32_t g_offset_cache_next = 0;
+
+/*===========================================================================
+ * FUNCTION   : mm_stream_compute_offset
+ *
+ * DESCRIPTION: run the per-format offset calculation selected by a cache key
+ *
+ * PARAMETERS :
+ *   @key     : cache key describing the calculation
+ *   @stream_info : stream info, only used for preview
+ *   @buf_planes : [out] buffer plane information
+ *
+ * RETURN     : int32_t type of status
+ *              0  -- success
+ *              -1 -- failure
+ *==========================================================================*/
+static int32_t mm_stream_compute_offset(mm_stream_offset_key_t *key,
+                                        cam_stream_info_t *stream_info,
+                                        cam_stream_buf_plane_info_t *buf_planes)
+{
+    switch (key->kind) {
+    case MM_STREAM_OFFSET_PREVIEW:
+        return mm_stream_compute_offset_preview(stream_info,
+                &key->dim, &key->padding, buf_planes);
+    case MM_STREAM_OFFSET_POST_VIEW:
+        return mm_stream_compute_offset_post_view(key->fmt,
+                &key->dim, buf_planes);
+    case MM_STREAM_OFFSET_SNAPSHOT:
+        return mm_stream_compute_offset_snapshot(key->fmt,
+                &key->dim, &key->padding, buf_planes);
+    case MM_STREAM_OFFSET_RAW:
+        return mm_stream_compute_offset_raw(key->fmt,
+                &key->dim, &key->padding, buf_planes);
+    case MM_STREAM_OFFSET_VIDEO:
+        return mm_stream_compute_offset_video(key->fmt,
+                &key->dim, buf_planes);
+    case MM_STREAM_OFFSET_ANALYSIS:
+        return mm_stream_compute_offset_analysis(key->fmt,
+                &key->dim, &key->padding, buf_planes);
+    default:
+        LOGE("Invalid offset kind %d", key->kind);
+        return -1;
+    }
+}
+
+/*===========================================================================
+ * FUNCTION   : mm_stream_apply_offset
+ *
+ * DESCRIPTION: copy the written bytes of a cached result into buf_planes
+ *
+ * PARAMETERS :
+ *   @entry   : cache entry
+ *   @buf_planes : [out] buffer plane information
+ *
+ * RETURN     : none
+ *==========================================================================*/
+static void mm_stream_apply_offset(const mm_stream_offset_entry_t *entry,
+                                   cam_stream_buf_plane_info_t *buf_planes)
+{
+    const uint8_t *src = (const uint8_t *)&entry->planes;
+    uint8_t *dst = (uint8_t *)buf_planes;
+    size_t i;
+
+    for (i = 0; i < sizeof(cam_stream_buf_plane_info_t); i++) {
+        if (entry->written[i]) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+/*===========================================================================
+ * FUNCTION   : mm_stream_calc_offset_cached
+ *
+ * DESCRIPTION: look up plane offsets for a stream configuration, running
+ *              the per-format calculation only on the first request. The
+ *              calculations depend on nothing but the key, so a hit
+ *              leaves buf_planes byte for byte as a direct call would.
+ *
+ * PARAMETERS :
+ *   @kind    : calculation to run
+ *   @fmt     : image format
+ *   @stream_info : stream info, only used for preview
+ *   @dim     : image dimension
+ *   @padding : padding information, NULL if unused by the calculation
+ *   @buf_planes : [out] buffer plane information
+ *
+ * RETURN     : int32_t type of status
+ *              0  -- success
+ *              -1 -- failure
+ *==========================================================================*/
+static int32_t mm_stream_calc_offset_cached(mm_stream_offset_kind_t kind,
+                                            cam_format_t fmt,
+                                            cam_stream_info_t *stream_info,
+                                            cam_dimension_t *dim,
+                                            cam_padding_info_t *padding,
+                                            cam_stream_buf_plane_info_t *buf_planes)
+{
+    int32_t rc = 0;
+    mm_stream_offset_key_t key;
+    mm_stream_offset_entry_t entry;
+    cam_stream_buf_plane_info_t probe;
+    const uint8_t *a, *b;
+    uint32_t i;
+
+    /* zero the whole key so padding bytes compare equal */
+    memset(&key, 0, sizeof(key));
+    key.kind = kind;
+    key.fmt = fmt;
+    key.offline_proc = (stream_info != NULL) &&
+            (stream_info->stream_type == CAM_STREAM_TYPE_OFFLINE_PROC);
+    key.dim = *dim;
+    if (padding != NULL) {
+        key.padding = *padding;
+    }
+
+    pthread_mutex_lock(&g_offset_cache_lock);
+    for (i = 0; i < MM_STREAM_OFFSET_CACHE_SIZE; i++) {
+        if (g_offset_cache[i].valid &&
+                !memcmp(&g_offset_cache[i].key, &key, sizeof(key))) {
+            mm_stream_apply_offset(&g_offset_cache[i], buf_planes);
+            pthread_mutex_unlock(&g_offset_cache_lock);
+            return 0;
+        }
+    }
+    pthread_mutex_unlock(&g_offset_cache_lock);
+
+    /* Run the calculation over two differently filled buffers: a byte
+     * the calculation writes ends up the same in both, any other byte
+     * keeps its fill and differs. */
+    memset(&entry, 0, sizeof(entry));
+    memset(&probe, 0xFF, sizeof(probe));
+    rc = mm_stream_compute_offset(&key, stream_info, &entry.planes);
+    if (rc == 0) {
+        rc = mm_stream_compute_offset(&key, stream_info, &probe);
+    }
+    if (rc != 0) {
+        /* not cached; repeat on the caller's buffer for the same
+         * partial output and logs as before */
+        return mm_stream_compute_offset(&key, stream_info, buf_planes);
+    }
+
+    a = (const uint8_t *)&entry.planes;
+    b = (const uint8_t *)&probe;
+    for (i = 0; i < sizeof(cam_stream_buf_plane_info_t); i++) {
+        entry.written[i] = (a[i] == b[i]);
+    }
+    entry.key = key;
+    entry.valid = 1;
+    mm_stream_apply_offset(&entry, buf_planes);
+
+    pthread_mutex_lock(&g_offset_cache_lock);
+    g_offset_cache[g_offset_cache_next] = entry;
+    g_offset_cache_next = (g_offset_cache_next + 1) % MM_STREAM_OFFSET_CACHE_SIZE;
+    pthread_mutex_unlock(&g_offset_cache_lock);
+
+    return rc;
+}
+
+/*===========================================================================
+ * FUNCTION   : mm_stream_calc_offset_preview
+ *
+ * DESCRIPTION: calculate preview frame offset based on format and
+ *              padding information
+ *
+ * PARAMETERS :
+ *   @stream_info : stream info
+ *   @dim     : image dimension
+ *   @padding : padding information
+ *   @buf_planes : [out] buffer plane information
+ *
+ * RETURN     : int32_t type of status
+ *              0  -- success
+ *              -1 -- failure
+ *==========================================================================*/
+int32_t mm_stream_calc_offset_preview(cam_stream_info_t *stream_info,
+                                      cam_dimension_t *dim,
+                                      cam_padding_info_t *padding,
+                                      cam_stream_buf_plane_info_t *buf_planes)
+{
+    return mm_stream_calc_offset_cached(MM_STREAM_OFFSET_PREVIEW,
+            stream_info->fmt, stream_info, dim, padding, buf_planes);
+}
+
+/*===========================================================================
+ * FUNCTION   : mm_stream_calc_offset_post_view
+ *
+ * DESCRIPTION: calculate postview frame offset based on format and
+ *              padding information
+ *
+ * PARAMETERS :
+ *   @fmt     : image format
+ *   @dim     : image dimension
+ *   @buf_planes : [out] buffer plane information
+ *
+ * RETURN     : int32_t type of status
+ *              0  -- success
+ *              -1 -- failure
+ *==========================================================================*/
+int32_t mm_stream_calc_offset_post_view(cam_format_t fmt,
+                                      cam_dimension_t *dim,
+                                      cam_stream_buf_plane_info_t *buf_planes)
+{
+    return mm_stream_calc_offset_cached(MM_STREAM_OFFSET_POST_VIEW,
+            fmt, NULL, dim, NULL, buf_planes);
+}
+
+/*===========================================================================
+ * FUNCTION   : mm_stream_calc_offset_snapshot
+ *
+ * DESCRIPTION: calculate snapshot/postproc frame offset based on format and
+ *              padding information
+ *
+ * PARAMETERS :
+ *   @fmt     : image format
+ *   @dim     : image dimension
+ *   @padding : padding information
+ *   @buf_planes : [out] buffer plane information
+ *
+ * RETURN     : int32_t type of status
+ *              0  -- success
+ *              -1 -- failure
+ *==========================================================================*/
+int32_t mm_stream_calc_offset_snapshot(cam_format_t fmt,
+                                       cam_dimension_t *dim,
+                                       cam_padding_info_t *padding,
+                                       cam_stream_buf_plane_info_t *buf_planes)
+{
+    return mm_stream_calc_offset_cached(MM_STREAM_OFFSET_SNAPSHOT,
+            fmt, NULL, dim, padding, buf_planes);
+}
+
+/*===========================================================================
+ * FUNCTION   : mm_stream_calc_offset_raw
+ *
+ * DESCRIPTION: calculate raw frame offset based on format and padding information
+ *
+ * PARAMETERS :
+ *   @fmt     : image format
+ *   @dim     : image dimension
+ *   @padding : padding information
+ *   @buf_planes : [out] buffer plane information
+ *
+ * RETURN     : int32_t type of status
+ *              0  -- success
+ *              -1 -- failure
+ *==========================================================================*/
+int32_t mm_stream_calc_offset_raw(cam_format_t fmt,
+                                  cam_dimension_t *dim,
+                                  cam_padding_info_t *padding,
+                                  cam_stream_buf_plane_info_t *buf_planes)
+{
+    return mm_stream_calc_offset_cached(MM_STREAM_OFFSET_RAW,
+            fmt, NULL, dim, padding, buf_planes);
+}
+
+/*===========================================================================
+ * FUNCTION   : mm_stream_calc_offset_video
+ *
+ * DESCRIPTION: calculate video frame offset based on format and
+ *              padding information
+ *
+ * PARAMETERS :
+ *   @fmt     : image format
+ *   @dim     : image dimension
+ *   @buf_planes : [out] buffer plane information
+ *
+ * RETURN     : int32_t type of status
+ *              0  -- success
+ *              -1 -- failure
+ *==========================================================================*/
+int32_t mm_stream_calc_offset_video(cam_format_t fmt,
+        cam_dimension_t *dim, cam_stream_buf_plane_info_t *buf_planes)
+{
+    return mm_stream_calc_offset_cached(MM_STREAM_OFFSET_VIDEO,
+            fmt, NULL, dim, NULL, buf_planes);
+}
+
+/*===========================================================================
+ * FUNCTION   : mm_stream_calc_offset_analysis
+ *
+ * DESCRIPTION: calculate analysis frame offset based on format and
+ *              padding information
+ *
+ * PARAMETERS :
+ *   @fmt     : image format
+ *   @dim     : image dimension
+ *   @padding : padding information
+ *   @buf_planes : [out] buffer plane information
+ *
+ * RETURN     : int32_t type of status
+ *              0  -- success
+ *              -1 -- failure
+ *==========================================================================*/
+int32_t mm_stream_calc_offset_analysis(cam_format_t fmt,
+                                       cam_dimension_t *dim,
+                                       cam_padding_info_t *padding,
+                                       cam_stream_buf_plane_info_t *buf_planes)
+{
+    return mm_stream_calc_offset_cached(MM_STREAM_OFFSET_ANALYSIS,
+            fmt, NULL, dim, padding, buf_planes);
+}
+
 /*===========================================================================
  * FUNCTION   : mm_stream_calc_offset_postproc
  *
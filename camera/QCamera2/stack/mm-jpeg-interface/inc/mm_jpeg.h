@@ -49,8 +49,12 @@
 #define MM_JPEG_CIRQ_SIZE 30
 #define MM_JPEG_MAX_SESSION 10
 #define MAX_EXIF_TABLE_ENTRIES 50
+/* Bytes of tag data (strings, arrays) the metadata exif tags may use */
+#define MM_JPEG_EXIF_ARENA_SIZE 2048
 #define MAX_JPEG_SIZE 20000000
 #define MAX_OMX_HANDLES (5)
+/* Max sessions the job manager tracks while looking for a runnable job */
+#define MM_JPEG_JOBMGR_SCAN_MAX 8
 // Thumbnail src and dest aspect ratio diffrence tolerance
 #define ASPECT_TOLERANCE 0.001
 
@@ -134,6 +138,17 @@ typedef enum {
 #define GET_SESSION_IDX(x) (((x) >> 8) & 0xff)
 #define GET_JOB_IDX(x) (((x) >> 16) & 0xff)
 
+/** mm_jpeg_exif_arena_t:
+ *  @buf: backing store
+ *  @used: bytes handed out so far
+ *
+ *  Bump allocator for the data of the exif tags of one job.
+ **/
+typedef struct {
+  uint8_t buf[MM_JPEG_EXIF_ARENA_SIZE] __attribute__((aligned(8)));
+  size_t used;
+} mm_jpeg_exif_arena_t;
+
 typedef struct {
   union {
     int i_data[MM_JPEG_CIRQ_SIZE];
@@ -307,6 +322,7 @@ typedef struct mm_jpeg_job_session {
 
   QEXIF_INFO_DATA exif_info_local[MAX_EXIF_TABLE_ENTRIES];  //all exif tags for JPEG encoder
   int exif_count_local;
+  mm_jpeg_exif_arena_t exif_arena;  //backing store of exif_info_local data
 
   mm_jpeg_cirq_t cb_q;
   int32_t ebd_count;
@@ -343,12 +359,17 @@ typedef struct mm_jpeg_job_session {
 
   int thumb_from_main;
   uint32_t job_index;
+
+  /* timing of the current job in us, for KPI */
+  uint64_t job_queued_time;
+  uint64_t job_start_time;
 } mm_jpeg_job_session_t;
 
 typedef struct {
   mm_jpeg_encode_job_t encode_job;
   uint32_t job_id;
   uint32_t client_handle;
+  uint64_t queued_time;          /* time the job was queued in us */
 } mm_jpeg_encode_job_info_t;
 
 typedef struct {
@@ -469,12 +490,13 @@ extern int32_t mm_jpeg_queue_deinit(mm_jpeg_queue_t* queue);
 extern int32_t mm_jpeg_queue_flush(mm_jpeg_queue_t* queue);
 extern uint32_t mm_jpeg_queue_get_size(mm_jpeg_queue_t* queue);
 extern mm_jpeg_q_data_t mm_jpeg_queue_peek(mm_jpeg_queue_t* queue);
-extern int32_t addExifEntry(QOMX_EXIF_INFO *p_exif_info, exif_tag_id_t tagid,
+extern void mm_jpeg_exif_arena_reset(mm_jpeg_exif_arena_t *p_arena);
+extern int32_t addExifEntry(QOMX_EXIF_INFO *p_exif_info,
+  mm_jpeg_exif_arena_t *p_arena, exif_tag_id_t tagid,
   exif_tag_type_t type, uint32_t count, void *data);
-extern int32_t releaseExifEntry(QEXIF_INFO_DATA *p_exif_data);
 extern int process_meta_data(metadata_buffer_t *p_meta,
-  QOMX_EXIF_INFO *exif_info, mm_jpeg_exif_params_t *p_cam3a_params,
-  cam_hal_version_t hal_version);
+  QOMX_EXIF_INFO *exif_info, mm_jpeg_exif_arena_t *p_arena,
+  mm_jpeg_exif_params_t *p_cam3a_params, cam_hal_version_t hal_version);
 
 OMX_ERRORTYPE mm_jpeg_session_change_state(mm_jpeg_job_session_t* p_session,
   OMX_STATETYPE new_state,
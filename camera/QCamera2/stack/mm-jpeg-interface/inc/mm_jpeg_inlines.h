@@ -30,6 +30,9 @@
 #ifndef MM_JPEG_INLINES_H_
 #define MM_JPEG_INLINES_H_
 
+// System dependencies
+#include <time.h>
+
 // JPEG dependencies
 #include "mm_jpeg.h"
 
@@ -122,6 +125,22 @@ static inline void mm_jpeg_remove_session_idx(mm_jpeg_obj *my_obj, uint32_t job_
   pthread_mutex_unlock(&my_obj->clnt_mgr[client_idx].lock);
 }
 
-
+/** mm_jpeg_get_time_us:
+ *
+ *  Arguments:
+ *
+ *  Return:
+ *       monotonic time in us
+ *
+ *  Description:
+ *       Get time stamp for job timing
+ *
+ **/
+static inline uint64_t mm_jpeg_get_time_us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
 
 #endif /* MM_JPEG_INLINES_H_ */
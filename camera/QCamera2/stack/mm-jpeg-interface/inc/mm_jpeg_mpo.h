@@ -37,6 +37,26 @@
 #define TRUE 1
 #define FALSE 0
 
+/** mm_jpeg_mpo_layout_t:
+ *  @app2_offset: offset of the MP Format APP2 marker
+ *  @app2_end: offset just past the APP2 segment
+ *  @mp_header_offset: offset of the MP endian field. Offsets
+ *                   written to the MP header are relative to it
+ *  @mp_entry_offset: offset of the MP Entry value of the
+ *                  primary image
+ *  @little_endian: byte order of the MP header
+ *
+ *  Offsets into the primary image at which the MP header is
+ *  patched during composition
+ **/
+typedef struct {
+  uint32_t app2_offset;
+  uint32_t app2_end;
+  uint32_t mp_header_offset;
+  uint32_t mp_entry_offset;
+  uint8_t little_endian;
+} mm_jpeg_mpo_layout_t;
+
 extern int mm_jpeg_mpo_compose(mm_jpeg_mpo_info_t *mpo_info);
 
 extern int get_mpo_size(mm_jpeg_output_t jpeg_buffer[MM_JPEG_MAX_MPO_IMAGES],
@@ -291,6 +291,7 @@ OMX_ERRORTYPE mm_jpeg_session_create(mm_jpeg_job_session_t* p_session)
   p_session->encode_pid = -1;
   p_session->config = OMX_FALSE;
   p_session->exif_count_local = 0;
+  mm_jpeg_exif_arena_reset(&p_session->exif_arena);
   p_session->auto_out_buf = OMX_FALSE;
 
   p_session->omx_callbacks.EmptyBufferDone = mm_jpeg_ebd;
@@ -1348,8 +1349,10 @@ OMX_ERRORTYPE mm_jpeg_session_config_common(mm_jpeg_job_session_t *p_session)
   /*parse aditional exif data from the metadata*/
   exif_info.numOfEntries = 0;
   exif_info.exif_data = &p_session->exif_info_local[0];
+  mm_jpeg_exif_arena_reset(&p_session->exif_arena);
   process_meta_data(p_jobparams->p_metadata, &exif_info,
-    &p_jobparams->cam_exif_params, p_jobparams->hal_version);
+    &p_session->exif_arena, &p_jobparams->cam_exif_params,
+    p_jobparams->hal_version);
   /* After Parse metadata */
   p_session->exif_count_local = (int)exif_info.numOfEntries;
 
@@ -1810,6 +1813,8 @@ int32_t mm_jpeg_process_encoding_job(mm_jpeg_obj *my_obj, mm_jpeg_job_q_node_t*
 
   p_session->encode_job = job_node->enc_info.encode_job;
   p_session->jobId = job_node->enc_info.job_id;
+  p_session->job_queued_time = job_node->enc_info.queued_time;
+  p_session->job_start_time = mm_jpeg_get_time_us();
   ret = mm_jpeg_session_encode(p_session);
   if (ret) {
     LOGE("encode session failed");
@@ -1842,6 +1847,99 @@ error:
 
 
 
+/** mm_jpeg_jobmgr_next_job:
+ *
+ *  Arguments:
+ *    @my_obj: jpeg object
+ *
+ *  Return:
+ *       job node to run, NULL if no queued job can run now
+ *
+ *  Description:
+ *       Removes the next job to run from the todo queue. A job whose
+ *       session has no free OMX handle or output buffer doesn't hold
+ *       back the jobs of other sessions queued behind it, and the
+ *       first runnable priority job goes ahead of them. Jobs of one
+ *       session always run in order. Decode and exit commands are
+ *       not overtaken.
+ *
+ **/
+static mm_jpeg_job_q_node_t *mm_jpeg_jobmgr_next_job(mm_jpeg_obj *my_obj)
+{
+  mm_jpeg_queue_t *queue = &my_obj->job_mgr.job_queue;
+  mm_jpeg_queue_t *seen[MM_JPEG_JOBMGR_SCAN_MAX];
+  mm_jpeg_q_node_t *node = NULL;
+  mm_jpeg_q_node_t *pick = NULL;
+  mm_jpeg_job_q_node_t *data = NULL;
+  mm_jpeg_job_session_t *p_session = NULL;
+  struct cam_list *head = NULL;
+  struct cam_list *pos = NULL;
+  uint32_t num_seen = 0;
+  uint32_t i;
+
+  pthread_mutex_lock(&queue->lock);
+  head = &queue->head.list;
+  for (pos = head->next; pos != head; pos = pos->next) {
+    node = member_of(pos, mm_jpeg_q_node_t, list);
+    data = (mm_jpeg_job_q_node_t *)node->data.p;
+
+    if ((NULL == data) || (MM_JPEG_CMD_TYPE_JOB != data->type)) {
+      if (NULL == pick) {
+        pick = node;
+      }
+      break;
+    }
+
+    p_session = mm_jpeg_get_session(my_obj, data->enc_info.job_id);
+    if (NULL == p_session) {
+      /* let the job processing report the invalid job */
+      if (NULL == pick) {
+        pick = node;
+      }
+      break;
+    }
+
+    /* only the oldest queued job of a session can run */
+    for (i = 0; i < num_seen; i++) {
+      if (seen[i] == p_session->session_handle_q) {
+        break;
+      }
+    }
+    if (i < num_seen) {
+      continue;
+    }
+    if (num_seen == MM_JPEG_JOBMGR_SCAN_MAX) {
+      break;
+    }
+    seen[num_seen++] = p_session->session_handle_q;
+
+    if ((0 == mm_jpeg_queue_get_size(p_session->session_handle_q)) ||
+      ((data->enc_info.encode_job.dst_index < 0) &&
+      (0 == mm_jpeg_queue_get_size(p_session->out_buf_q)))) {
+      continue;
+    }
+
+    if (data->enc_info.encode_job.priority) {
+      pick = node;
+      break;
+    }
+    if (NULL == pick) {
+      pick = node;
+    }
+  }
+
+  data = NULL;
+  if (NULL != pick) {
+    data = (mm_jpeg_job_q_node_t *)pick->data.p;
+    cam_list_del_node(&pick->list);
+    queue->size--;
+    free(pick);
+  }
+  pthread_mutex_unlock(&queue->lock);
+
+  return data;
+}
+
 /** mm_jpeg_jobmgr_thread:
  *
  *  Arguments:
@@ -1856,7 +1954,6 @@ error:
  **/
 static void *mm_jpeg_jobmgr_thread(void *data)
 {
-  mm_jpeg_q_data_t qdata;
   int rc = 0;
   int running = 1;
   uint32_t num_ongoing_jobs = 0;
@@ -1886,8 +1983,7 @@ static void *mm_jpeg_jobmgr_thread(void *data)
 
     pthread_mutex_lock(&my_obj->job_lock);
     /* can go ahead with new work */
-    qdata = mm_jpeg_queue_deq(&cmd_thread->job_queue);
-    node = (mm_jpeg_job_q_node_t*)qdata.p;
+    node = mm_jpeg_jobmgr_next_job(my_obj);
     if (node != NULL) {
       switch (node->type) {
       case MM_JPEG_CMD_TYPE_JOB:
@@ -2352,6 +2448,7 @@ int32_t mm_jpeg_start_job(mm_jpeg_obj *my_obj,
   }
   node->enc_info.job_id = *job_id;
   node->enc_info.client_handle = p_session->client_hdl;
+  node->enc_info.queued_time = mm_jpeg_get_time_us();
   node->type = MM_JPEG_CMD_TYPE_JOB;
 
 
@@ -2670,17 +2767,13 @@ error2:
 static int32_t mm_jpegenc_destroy_job(mm_jpeg_job_session_t *p_session)
 {
   mm_jpeg_encode_job_t *p_jobparams = &p_session->encode_job;
-  int i = 0, rc = 0;
+  int rc = 0;
 
   LOGD("Exif entry count %d %d",
     (int)p_jobparams->exif_info.numOfEntries,
     (int)p_session->exif_count_local);
-  for (i = 0; i < p_session->exif_count_local; i++) {
-    rc = releaseExifEntry(&p_session->exif_info_local[i]);
-    if (rc) {
-      LOGE("Exif release failed (%d)", rc);
-    }
-  }
+  /* all tag data of the job lives in the arena */
+  mm_jpeg_exif_arena_reset(&p_session->exif_arena);
   p_session->exif_count_local = 0;
 
   return rc;
@@ -2992,6 +3085,15 @@ OMX_ERRORTYPE mm_jpeg_fbd(OMX_HANDLETYPE hComponent,
 
   p_session->fbd_count++;
   if (NULL != p_session->params.jpeg_cb) {
+    uint64_t done_time = mm_jpeg_get_time_us();
+    uint32_t queue_us = (uint32_t)(p_session->job_start_time -
+      p_session->job_queued_time);
+    uint32_t encode_us = (uint32_t)(done_time - p_session->job_start_time);
+
+    LOGH("[KPI Perf] JobID %u queued %u us encoded %u us",
+      p_session->jobId, queue_us, encode_us);
+    KPI_ATRACE_INT("Camera:JPEGqueue", (int32_t)queue_us);
+    KPI_ATRACE_INT("Camera:JPEGencode", (int32_t)encode_us);
 
     p_session->job_status = JPEG_JOB_STATUS_DONE;
     output_buf.buf_filled_len = (uint32_t)pBuffer->nFilledLen;
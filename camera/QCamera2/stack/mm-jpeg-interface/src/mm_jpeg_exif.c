@@ -44,11 +44,56 @@
         ((a >= 0) ? (uint32_t)(a + 0.5) : (uint32_t)(a - 0.5))
 
 
+/** mm_jpeg_exif_arena_reset:
+ *
+ *  Arguments:
+ *   @p_arena : exif arena
+ *
+ *  Retrun     : none
+ *
+ *  Description:
+ *       Drop all exif tag data allocated from the arena. Called once the
+ *       job using the tags is done.
+ *
+ **/
+void mm_jpeg_exif_arena_reset(mm_jpeg_exif_arena_t *p_arena)
+{
+  p_arena->used = 0;
+}
+
+/** mm_jpeg_exif_arena_alloc:
+ *
+ *  Arguments:
+ *   @p_arena : exif arena
+ *   @size    : number of bytes
+ *
+ *  Retrun     : ptr to the memory, NULL if the arena is exhausted
+ *
+ *  Description:
+ *       Bump allocate tag data from the arena. The memory is 8 byte
+ *       aligned and only released by mm_jpeg_exif_arena_reset.
+ *
+ **/
+static void *mm_jpeg_exif_arena_alloc(mm_jpeg_exif_arena_t *p_arena,
+  size_t size)
+{
+  size_t offset = (p_arena->used + 7) & ~(size_t)7;
+
+  if (offset + size > sizeof(p_arena->buf)) {
+    LOGE("Exif arena exhausted, used %zu, requested %zu",
+      p_arena->used, size);
+    return NULL;
+  }
+
+  p_arena->used = offset + size;
+  return &p_arena->buf[offset];
+}
+
 /** addExifEntry:
  *
  *  Arguments:
  *   @exif_info : Exif info struct
- *   @p_session: job session
+ *   @p_arena : arena holding the data of array and string tags
  *   @tagid   : exif tag ID
  *   @type    : data type
  *   @count   : number of data in uint of its type
@@ -62,230 +107,127 @@
  *       Function to add an entry to exif data
  *
  **/
-int32_t addExifEntry(QOMX_EXIF_INFO *p_exif_info, exif_tag_id_t tagid,
-  exif_tag_type_t type, uint32_t count, void *data)
+int32_t addExifEntry(QOMX_EXIF_INFO *p_exif_info, mm_jpeg_exif_arena_t *p_arena,
+  exif_tag_id_t tagid, exif_tag_type_t type, uint32_t count, void *data)
 {
-    int32_t rc = 0;
     uint32_t numOfEntries = (uint32_t)p_exif_info->numOfEntries;
     QEXIF_INFO_DATA *p_info_data = p_exif_info->exif_data;
+    exif_tag_entry_t *p_entry;
+    size_t elem_size = 0;
+    void *values = NULL;
+
     if(numOfEntries >= MAX_EXIF_TABLE_ENTRIES) {
         LOGE("Number of entries exceeded limit");
         return -1;
     }
 
+    p_entry = &p_info_data[numOfEntries].tag_entry;
     p_info_data[numOfEntries].tag_id = tagid;
-    p_info_data[numOfEntries].tag_entry.type = type;
-    p_info_data[numOfEntries].tag_entry.count = count;
-    p_info_data[numOfEntries].tag_entry.copy = 1;
+    p_entry->type = type;
+    p_entry->count = count;
+    p_entry->copy = 1;
+
     switch (type) {
-    case EXIF_BYTE: {
-      if (count > 1) {
-        uint8_t *values = (uint8_t *)malloc(count);
-        if (values == NULL) {
-          LOGE("No memory for byte array");
-          rc = -1;
-        } else {
-          memcpy(values, data, count);
-          p_info_data[numOfEntries].tag_entry.data._bytes = values;
-        }
-      } else {
-        p_info_data[numOfEntries].tag_entry.data._byte = *(uint8_t *)data;
-      }
-    }
-    break;
-    case EXIF_ASCII: {
-      char *str = NULL;
-      str = (char *)malloc(count + 1);
-      if (str == NULL) {
-        LOGE("No memory for ascii string");
-        rc = -1;
-      } else {
-        memset(str, 0, count + 1);
-        memcpy(str, data, count);
-        p_info_data[numOfEntries].tag_entry.data._ascii = str;
-      }
-    }
-    break;
-    case EXIF_SHORT: {
-      if (count > 1) {
-        uint16_t *values = (uint16_t *)malloc(count * sizeof(uint16_t));
-        if (values == NULL) {
-          LOGE("No memory for short array");
-          rc = -1;
-        } else {
-          memcpy(values, data, count * sizeof(uint16_t));
-          p_info_data[numOfEntries].tag_entry.data._shorts = values;
-        }
-      } else {
-        p_info_data[numOfEntries].tag_entry.data._short = *(uint16_t *)data;
-      }
-    }
-    break;
-    case EXIF_LONG: {
-      if (count > 1) {
-        uint32_t *values = (uint32_t *)malloc(count * sizeof(uint32_t));
-        if (values == NULL) {
-          LOGE("No memory for long array");
-          rc = -1;
-        } else {
-          memcpy(values, data, count * sizeof(uint32_t));
-          p_info_data[numOfEntries].tag_entry.data._longs = values;
-        }
-      } else {
-        p_info_data[numOfEntries].tag_entry.data._long = *(uint32_t *)data;
-      }
+    case EXIF_BYTE:
+    case EXIF_ASCII:
+    case EXIF_UNDEFINED:
+      elem_size = 1;
+      break;
+    case EXIF_SHORT:
+      elem_size = sizeof(uint16_t);
+      break;
+    case EXIF_LONG:
+    case EXIF_SLONG:
+      elem_size = sizeof(uint32_t);
+      break;
+    case EXIF_RATIONAL:
+      elem_size = sizeof(rat_t);
+      break;
+    case EXIF_SRATIONAL:
+      elem_size = sizeof(srat_t);
+      break;
+    default:
+      LOGE("Unsupported exif type %d", type);
+      return -1;
     }
-    break;
-    case EXIF_RATIONAL: {
-      if (count > 1) {
-        rat_t *values = (rat_t *)malloc(count * sizeof(rat_t));
-        if (values == NULL) {
-          LOGE("No memory for rational array");
-          rc = -1;
-        } else {
-          memcpy(values, data, count * sizeof(rat_t));
-          p_info_data[numOfEntries].tag_entry.data._rats = values;
-        }
-      } else {
-        p_info_data[numOfEntries].tag_entry.data._rat = *(rat_t *)data;
+
+    /* Single values are stored inline; strings and undefined data
+     * always live out of line. */
+    if (count == 1 && type != EXIF_ASCII && type != EXIF_UNDEFINED) {
+      switch (type) {
+      case EXIF_BYTE:
+        p_entry->data._byte = *(uint8_t *)data;
+        break;
+      case EXIF_SHORT:
+        p_entry->data._short = *(uint16_t *)data;
+        break;
+      case EXIF_LONG:
+        p_entry->data._long = *(uint32_t *)data;
+        break;
+      case EXIF_SLONG:
+        p_entry->data._slong = *(int32_t *)data;
+        break;
+      case EXIF_RATIONAL:
+        p_entry->data._rat = *(rat_t *)data;
+        break;
+      case EXIF_SRATIONAL:
+        p_entry->data._srat = *(srat_t *)data;
+        break;
+      default:
+        break;
       }
-    }
-    break;
-    case EXIF_UNDEFINED: {
-      uint8_t *values = (uint8_t *)malloc(count);
+    } else {
+      size_t size = elem_size * count;
+
+      values = mm_jpeg_exif_arena_alloc(p_arena,
+        (type == EXIF_ASCII) ? size + 1 : size);
       if (values == NULL) {
-        LOGE("No memory for undefined array");
-        rc = -1;
-      } else {
-        memcpy(values, data, count);
-        p_info_data[numOfEntries].tag_entry.data._undefined = values;
-      }
-    }
-    break;
-    case EXIF_SLONG: {
-      if (count > 1) {
-        int32_t *values = (int32_t *)malloc(count * sizeof(int32_t));
-        if (values == NULL) {
-          LOGE("No memory for signed long array");
-          rc = -1;
-        } else {
-          memcpy(values, data, count * sizeof(int32_t));
-          p_info_data[numOfEntries].tag_entry.data._slongs = values;
-        }
-      } else {
-        p_info_data[numOfEntries].tag_entry.data._slong = *(int32_t *)data;
+        return -1;
       }
-    }
-    break;
-    case EXIF_SRATIONAL: {
-      if (count > 1) {
-        srat_t *values = (srat_t *)malloc(count * sizeof(srat_t));
-        if (values == NULL) {
-          LOGE("No memory for signed rational array");
-          rc = -1;
-        } else {
-          memcpy(values, data, count * sizeof(srat_t));
-          p_info_data[numOfEntries].tag_entry.data._srats = values;
-        }
-      } else {
-        p_info_data[numOfEntries].tag_entry.data._srat = *(srat_t *)data;
+      memcpy(values, data, size);
+
+      switch (type) {
+      case EXIF_BYTE:
+        p_entry->data._bytes = (uint8_t *)values;
+        break;
+      case EXIF_ASCII:
+        ((char *)values)[size] = '\0';
+        p_entry->data._ascii = (char *)values;
+        break;
+      case EXIF_UNDEFINED:
+        p_entry->data._undefined = (uint8_t *)values;
+        break;
+      case EXIF_SHORT:
+        p_entry->data._shorts = (uint16_t *)values;
+        break;
+      case EXIF_LONG:
+        p_entry->data._longs = (uint32_t *)values;
+        break;
+      case EXIF_SLONG:
+        p_entry->data._slongs = (int32_t *)values;
+        break;
+      case EXIF_RATIONAL:
+        p_entry->data._rats = (rat_t *)values;
+        break;
+      case EXIF_SRATIONAL:
+        p_entry->data._srats = (srat_t *)values;
+        break;
+      default:
+        break;
       }
     }
-    break;
-    }
 
     // Increase number of entries
     p_exif_info->numOfEntries++;
-    return rc;
-}
-
-/** releaseExifEntry
- *
- *  Arguments:
- *   @p_exif_data : Exif info struct
- *
- *  Retrun     : int32_t type of status
- *               0  -- success
- *              none-zero failure code
- *
- *  Description:
- *       Function to release an entry from exif data
- *
- **/
-int32_t releaseExifEntry(QEXIF_INFO_DATA *p_exif_data)
-{
- switch (p_exif_data->tag_entry.type) {
-  case EXIF_BYTE: {
-    if (p_exif_data->tag_entry.count > 1 &&
-      p_exif_data->tag_entry.data._bytes != NULL) {
-      free(p_exif_data->tag_entry.data._bytes);
-      p_exif_data->tag_entry.data._bytes = NULL;
-    }
-  }
-  break;
-  case EXIF_ASCII: {
-    if (p_exif_data->tag_entry.data._ascii != NULL) {
-      free(p_exif_data->tag_entry.data._ascii);
-      p_exif_data->tag_entry.data._ascii = NULL;
-    }
-  }
-  break;
-  case EXIF_SHORT: {
-    if (p_exif_data->tag_entry.count > 1 &&
-      p_exif_data->tag_entry.data._shorts != NULL) {
-      free(p_exif_data->tag_entry.data._shorts);
-      p_exif_data->tag_entry.data._shorts = NULL;
-    }
-  }
-  break;
-  case EXIF_LONG: {
-    if (p_exif_data->tag_entry.count > 1 &&
-      p_exif_data->tag_entry.data._longs != NULL) {
-      free(p_exif_data->tag_entry.data._longs);
-      p_exif_data->tag_entry.data._longs = NULL;
-    }
-  }
-  break;
-  case EXIF_RATIONAL: {
-    if (p_exif_data->tag_entry.count > 1 &&
-      p_exif_data->tag_entry.data._rats != NULL) {
-      free(p_exif_data->tag_entry.data._rats);
-      p_exif_data->tag_entry.data._rats = NULL;
-    }
-  }
-  break;
-  case EXIF_UNDEFINED: {
-    if (p_exif_data->tag_entry.data._undefined != NULL) {
-      free(p_exif_data->tag_entry.data._undefined);
-      p_exif_data->tag_entry.data._undefined = NULL;
-    }
-  }
-  break;
-  case EXIF_SLONG: {
-    if (p_exif_data->tag_entry.count > 1 &&
-      p_exif_data->tag_entry.data._slongs != NULL) {
-      free(p_exif_data->tag_entry.data._slongs);
-      p_exif_data->tag_entry.data._slongs = NULL;
-    }
-  }
-  break;
-  case EXIF_SRATIONAL: {
-    if (p_exif_data->tag_entry.count > 1 &&
-      p_exif_data->tag_entry.data._srats != NULL) {
-      free(p_exif_data->tag_entry.data._srats);
-      p_exif_data->tag_entry.data._srats = NULL;
-    }
-  }
-  break;
-  } /*end of switch*/
-
-  return 0;
+    return 0;
 }
 
 /** process_sensor_data:
  *
  *  Arguments:
  *   @p_sensor_params : ptr to sensor data
+ *   @exif_info : Exif info struct
+ *   @p_arena : arena for the tag data
  *
  *  Return     : int32_t type of status
  *               NO_ERROR  -- success
@@ -297,7 +239,7 @@ int32_t releaseExifEntry(QEXIF_INFO_DATA *p_exif_data)
  *  Notes: this needs to be filled for the metadata
  **/
 int process_sensor_data(cam_sensor_params_t *p_sensor_params,
-  QOMX_EXIF_INFO *exif_info)
+  QOMX_EXIF_INFO *exif_info, mm_jpeg_exif_arena_t *p_arena)
 {
   int rc = 0;
   rat_t val_rat;
@@ -315,14 +257,14 @@ int process_sensor_data(cam_sensor_params_t *p_sensor_params,
     apex_value = (double)2.0 * log(p_sensor_params->aperture_value) / log(2.0);
     val_rat.num = (uint32_t)(apex_value * 100);
     val_rat.denom = 100;
-    rc = addExifEntry(exif_info, EXIFTAGID_APERTURE, EXIF_RATIONAL, 1, &val_rat);
+    rc = addExifEntry(exif_info, p_arena, EXIFTAGID_APERTURE, EXIF_RATIONAL, 1, &val_rat);
     if (rc) {
       LOGE(": Error adding Exif Entry");
     }
 
     val_rat.num = (uint32_t)(p_sensor_params->aperture_value * 100);
     val_rat.denom = 100;
-    rc = addExifEntry(exif_info, EXIFTAGID_F_NUMBER, EXIF_RATIONAL, 1, &val_rat);
+    rc = addExifEntry(exif_info, p_arena, EXIFTAGID_F_NUMBER, EXIF_RATIONAL, 1, &val_rat);
     if (rc) {
       LOGE(": Error adding Exif Entry");
     }
@@ -355,13 +297,13 @@ int process_sensor_data(cam_sensor_params_t *p_sensor_params,
   }
   val_short = (short)(flash_fired | (flash_mode_exif << 3));
 
-  rc = addExifEntry(exif_info, EXIFTAGID_FLASH, EXIF_SHORT, 1, &val_short);
+  rc = addExifEntry(exif_info, p_arena, EXIFTAGID_FLASH, EXIF_SHORT, 1, &val_short);
   if (rc) {
     LOGE(": Error adding flash exif entry");
   }
   /* Sensing Method */
   val_short = (short) p_sensor_params->sensing_method;
-  rc = addExifEntry(exif_info, EXIFTAGID_SENSING_METHOD, EXIF_SHORT,
+  rc = addExifEntry(exif_info, p_arena, EXIFTAGID_SENSING_METHOD, EXIF_SHORT,
     sizeof(val_short)/2, &val_short);
   if (rc) {
     LOGE(": Error adding flash Exif Entry");
@@ -370,7 +312,7 @@ int process_sensor_data(cam_sensor_params_t *p_sensor_params,
   /* Focal Length in 35 MM Film */
   val_short = (short)
     ((p_sensor_params->focal_length * p_sensor_params->crop_factor) + 0.5f);
-  rc = addExifEntry(exif_info, EXIFTAGID_FOCAL_LENGTH_35MM, EXIF_SHORT,
+  rc = addExifEntry(exif_info, p_arena, EXIFTAGID_FOCAL_LENGTH_35MM, EXIF_SHORT,
     1, &val_short);
   if (rc) {
     LOGE(": Error adding Exif Entry");
@@ -379,7 +321,7 @@ int process_sensor_data(cam_sensor_params_t *p_sensor_params,
   /* F Number */
   val_rat.num = (uint32_t)(p_sensor_params->f_number * 100);
   val_rat.denom = 100;
-  rc = addExifEntry(exif_info, EXIFTAGTYPE_F_NUMBER, EXIF_RATIONAL, 1, &val_rat);
+  rc = addExifEntry(exif_info, p_arena, EXIFTAGTYPE_F_NUMBER, EXIF_RATIONAL, 1, &val_rat);
   if (rc) {
     LOGE(": Error adding Exif Entry");
   }
@@ -392,6 +334,7 @@ int process_sensor_data(cam_sensor_params_t *p_sensor_params,
  *  Arguments:
  *   @p_3a_params : ptr to 3a data
  *   @exif_info : Exif info struct
+ *   @p_arena : arena for the tag data
  *
  *  Return     : int32_t type of status
  *               NO_ERROR  -- success
@@ -402,7 +345,8 @@ int process_sensor_data(cam_sensor_params_t *p_sensor_params,
  *
  *  Notes: this needs to be filled for the metadata
  **/
-int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
+int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info,
+  mm_jpeg_exif_arena_t *p_arena)
 {
   int rc = 0;
   srat_t val_srat;
@@ -431,7 +375,7 @@ int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
   LOGD("numer %d denom %d %zd", val_rat.num, val_rat.denom,
     sizeof(val_rat) / (8));
 
-  rc = addExifEntry(exif_info, EXIFTAGID_EXPOSURE_TIME, EXIF_RATIONAL,
+  rc = addExifEntry(exif_info, p_arena, EXIFTAGID_EXPOSURE_TIME, EXIF_RATIONAL,
     (sizeof(val_rat)/(8)), &val_rat);
   if (rc) {
     LOGE(": Error adding Exif Entry Exposure time");
@@ -446,7 +390,7 @@ int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
     val_srat.num = 0;
     val_srat.denom = 0;
   }
-  rc = addExifEntry(exif_info, EXIFTAGID_SHUTTER_SPEED, EXIF_SRATIONAL,
+  rc = addExifEntry(exif_info, p_arena, EXIFTAGID_SHUTTER_SPEED, EXIF_SRATIONAL,
     (sizeof(val_srat)/(8)), &val_srat);
   if (rc) {
     LOGE(": Error adding Exif Entry");
@@ -455,7 +399,7 @@ int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
   /*ISO*/
   short val_short;
   val_short = (short)p_3a_params->iso_value;
-  rc = addExifEntry(exif_info, EXIFTAGID_ISO_SPEED_RATING, EXIF_SHORT,
+  rc = addExifEntry(exif_info, p_arena, EXIFTAGID_ISO_SPEED_RATING, EXIF_SHORT,
     sizeof(val_short)/2, &val_short);
   if (rc) {
      LOGE(": Error adding Exif Entry");
@@ -466,7 +410,7 @@ int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
     val_short = 0;
   else
     val_short = 1;
-  rc = addExifEntry(exif_info, EXIFTAGID_WHITE_BALANCE, EXIF_SHORT,
+  rc = addExifEntry(exif_info, p_arena, EXIFTAGID_WHITE_BALANCE, EXIF_SHORT,
     sizeof(val_short)/2, &val_short);
   if (rc) {
     LOGE(": Error adding Exif Entry");
@@ -474,7 +418,7 @@ int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
 
   /* Metering Mode   */
   val_short = (short) p_3a_params->metering_mode;
-  rc = addExifEntry(exif_info,EXIFTAGID_METERING_MODE, EXIF_SHORT,
+  rc = addExifEntry(exif_info, p_arena, EXIFTAGID_METERING_MODE, EXIF_SHORT,
      sizeof(val_short)/2, &val_short);
   if (rc) {
      LOGE(": Error adding Exif Entry");
@@ -482,7 +426,7 @@ int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
 
   /*Exposure Program*/
    val_short = (short) p_3a_params->exposure_program;
-   rc = addExifEntry(exif_info,EXIFTAGID_EXPOSURE_PROGRAM, EXIF_SHORT,
+   rc = addExifEntry(exif_info, p_arena, EXIFTAGID_EXPOSURE_PROGRAM, EXIF_SHORT,
       sizeof(val_short)/2, &val_short);
    if (rc) {
       LOGE(": Error adding Exif Entry");
@@ -490,7 +434,7 @@ int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
 
    /*Exposure Mode */
     val_short = (short) p_3a_params->exposure_mode;
-    rc = addExifEntry(exif_info,EXIFTAGID_EXPOSURE_MODE, EXIF_SHORT,
+    rc = addExifEntry(exif_info, p_arena, EXIFTAGID_EXPOSURE_MODE, EXIF_SHORT,
        sizeof(val_short)/2, &val_short);
     if (rc) {
        LOGE(": Error adding Exif Entry");
@@ -499,7 +443,7 @@ int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
     /*Scenetype*/
      uint8_t val_undef;
      val_undef = (uint8_t) p_3a_params->scenetype;
-     rc = addExifEntry(exif_info,EXIFTAGID_SCENE_TYPE, EXIF_UNDEFINED,
+     rc = addExifEntry(exif_info, p_arena, EXIFTAGID_SCENE_TYPE, EXIF_UNDEFINED,
         sizeof(val_undef), &val_undef);
      if (rc) {
         LOGE(": Error adding Exif Entry");
@@ -511,7 +455,7 @@ int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
     /* Brightness Value*/
      val_srat.num = (int32_t) (p_3a_params->brightness * 100.0f);
      val_srat.denom = 100;
-     rc = addExifEntry(exif_info,EXIFTAGID_BRIGHTNESS, EXIF_SRATIONAL,
+     rc = addExifEntry(exif_info, p_arena, EXIFTAGID_BRIGHTNESS, EXIF_SRATIONAL,
                  (sizeof(val_srat)/(8)), &val_srat);
      if (rc) {
         LOGE(": Error adding Exif Entry");
@@ -525,6 +469,7 @@ int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
  *  Arguments:
  *   @p_meta : ptr to metadata
  *   @exif_info: Exif info struct
+ *   @p_arena: arena for the tag data
  *   @mm_jpeg_exif_params: exif params
  *
  *  Return     : int32_t type of status
@@ -535,7 +480,8 @@ int process_3a_data(cam_3a_params_t *p_3a_params, QOMX_EXIF_INFO *exif_info)
  *       Extract exif data from the metadata
  **/
 int process_meta_data(metadata_buffer_t *p_meta, QOMX_EXIF_INFO *exif_info,
-  mm_jpeg_exif_params_t *p_cam_exif_params, cam_hal_version_t hal_version)
+  mm_jpeg_exif_arena_t *p_arena, mm_jpeg_exif_params_t *p_cam_exif_params,
+  cam_hal_version_t hal_version)
 {
   int rc = 0;
   cam_sensor_params_t p_sensor_params;
@@ -619,13 +565,13 @@ int process_meta_data(metadata_buffer_t *p_meta, QOMX_EXIF_INFO *exif_info,
   }
 
   if ((hal_version != CAM_HAL_V1) || (p_sensor_params.sens_type != CAM_SENSOR_YUV)) {
-    rc = process_3a_data(&p_3a_params, exif_info);
+    rc = process_3a_data(&p_3a_params, exif_info, p_arena);
     if (rc) {
       LOGE("Failed to add 3a exif params");
     }
   }
 
-  rc = process_sensor_data(&p_sensor_params, exif_info);
+  rc = process_sensor_data(&p_sensor_params, exif_info, p_arena);
   if (rc) {
     LOGE("Failed to extract sensor params");
   }
@@ -638,7 +584,7 @@ int process_meta_data(metadata_buffer_t *p_meta, QOMX_EXIF_INFO *exif_info,
       val_short = (short) *scene_cap_type;
     }
 
-    rc = addExifEntry(exif_info, EXIFTAGID_SCENE_CAPTURE_TYPE, EXIF_SHORT,
+    rc = addExifEntry(exif_info, p_arena, EXIFTAGID_SCENE_CAPTURE_TYPE, EXIF_SHORT,
       sizeof(val_short)/2, &val_short);
     if (rc) {
       LOGE(": Error adding ASD Exif Entry");
@@ -31,6 +31,7 @@
 
 // System dependencies
 #include <pthread.h>
+#include <string.h>
 
 // JPEG dependencies
 #include "mm_jpeg_dbg.h"
@@ -41,6 +42,10 @@
 #define M_APP2    0xe2
 #define M_EOI     0xd9
 #define M_SOI     0xd8
+#define M_SOS     0xda
+
+#define MP_APP2_MARKER_BYTES 2
+#define MP_FORMAT_IDENTIFIER "MPF\0"
 
 /** READ_LONG:
  *  @b: Buffer start addr
@@ -81,147 +86,218 @@
 /*Mutex to serializa MPO composition*/
 static pthread_mutex_t g_mpo_lock = PTHREAD_MUTEX_INITIALIZER;
 
-/** mm_jpeg_mpo_write_long_little_endian
+/*Layout of the last primary image, guarded by g_mpo_lock*/
+static mm_jpeg_mpo_layout_t g_mpo_layout;
+
+/** mm_jpeg_mpo_put_long
  *
  *  Arguments:
- *    @buffer_addr: image start addr
- *    @buff_offset: offset in the buffer
- *    @buffer_size: Size of the buffer
+ *    @p: address to write to
  *    @value: Value to write
- *    @overflow : Overflow flag
+ *    @little_endian: byte order of the MP header
  *
  *  Return:
  *       None
  *
  *  Description:
- *       Write value at the given offset
+ *       Write a 32 bit value in the byte order of the MP header
  *
  **/
-void mm_jpeg_mpo_write_long_little_endian(uint8_t *buff_addr, uint32_t buff_offset,
-  uint32_t buffer_size, int value, uint8_t *overflow)
+static void mm_jpeg_mpo_put_long(uint8_t *p, uint32_t value,
+  uint8_t little_endian)
 {
-  if (buff_offset + 3 >= buffer_size) {
-    *overflow = TRUE;
-  }
-
-  if (!(*overflow)) {
-    buff_addr[buff_offset + 3] = (uint8_t)((value >> 24) & 0xFF);
-    buff_addr[buff_offset + 2] = (uint8_t)((value >> 16) & 0xFF);
-    buff_addr[buff_offset + 1] = (uint8_t)((value >> 8) & 0xFF);
-    buff_addr[buff_offset] = (uint8_t)(value & 0xFF);
+  if (little_endian) {
+    p[0] = (uint8_t)(value & 0xFF);
+    p[1] = (uint8_t)((value >> 8) & 0xFF);
+    p[2] = (uint8_t)((value >> 16) & 0xFF);
+    p[3] = (uint8_t)((value >> 24) & 0xFF);
+  } else {
+    p[0] = (uint8_t)((value >> 24) & 0xFF);
+    p[1] = (uint8_t)((value >> 16) & 0xFF);
+    p[2] = (uint8_t)((value >> 8) & 0xFF);
+    p[3] = (uint8_t)(value & 0xFF);
   }
 }
 
-/** mm_jpeg_mpo_write_long
+/** mm_jpeg_mpo_parse_app2
  *
  *  Arguments:
- *    @buffer_addr: image start addr
- *    @buff_offset: offset in the buffer
- *    @buffer_size: Size of the buffer
- *    @value: Value to write
- *    @overflow : Overflow flag
+ *    @buff_addr: Jpeg image start addr
+ *    @seg_offset: offset of the 0xFF of the APP2 marker
+ *    @seg_end: offset just past the APP2 segment
+ *    @layout: filled with the resolved offsets
  *
  *  Return:
- *       None
+ *       0 - Success
+ *      -1 - not an MP Format APP2 segment
  *
  *  Description:
- *       Write value at the given offset
+ *       Resolve the MP header and the first MP Entry value
+ *       of an APP2 segment.
  *
  **/
-void mm_jpeg_mpo_write_long(uint8_t *buff_addr, uint32_t buff_offset,
-  uint32_t buffer_size, int value, uint8_t *overflow)
+static int mm_jpeg_mpo_parse_app2(uint8_t *buff_addr, uint32_t seg_offset,
+  uint32_t seg_end, mm_jpeg_mpo_layout_t *layout)
 {
-  if ((buff_offset + 3) >= buffer_size) {
-    *overflow = TRUE;
+  uint32_t mp_header, endianess, ifd_offset, entry_offset;
+  uint16_t ifd_tag_count;
+
+  mp_header = seg_offset + MP_APP2_MARKER_BYTES + MP_APP2_FIELD_LENGTH_BYTES +
+    MP_FORMAT_IDENTIFIER_BYTES;
+  if (mp_header + MP_ENDIAN_BYTES + MP_HEADER_OFFSET_TO_FIRST_IFD_BYTES >
+    seg_end) {
+    return -1;
+  }
+  if (memcmp(buff_addr + mp_header - MP_FORMAT_IDENTIFIER_BYTES,
+    MP_FORMAT_IDENTIFIER, MP_FORMAT_IDENTIFIER_BYTES)) {
+    return -1;
+  }
+
+  endianess = READ_LONG(buff_addr, mp_header);
+  if (endianess == MPO_LITTLE_ENDIAN) {
+    ifd_offset = READ_LONG_LITTLE(buff_addr, mp_header + MP_ENDIAN_BYTES);
+  } else if (endianess == MPO_BIG_ENDIAN) {
+    ifd_offset = READ_LONG(buff_addr, mp_header + MP_ENDIAN_BYTES);
+  } else {
+    LOGE("Invalid MP endian field %x", endianess);
+    return -1;
+  }
+
+  if (mp_header + ifd_offset + MP_INDEX_COUNT_BYTES > seg_end) {
+    LOGE("MP Index IFD offset %d out of bounds", ifd_offset);
+    return -1;
+  }
+  if (endianess == MPO_LITTLE_ENDIAN) {
+    ifd_tag_count = (uint16_t)((buff_addr[mp_header + ifd_offset + 1] << 8) +
+      buff_addr[mp_header + ifd_offset]);
+  } else {
+    ifd_tag_count = READ_SHORT(buff_addr, mp_header + ifd_offset);
   }
 
-  if (!(*overflow)) {
-    buff_addr[buff_offset] = (uint8_t)((value >> 24) & 0xFF);
-    buff_addr[buff_offset+1] = (uint8_t)((value >> 16) & 0xFF);
-    buff_addr[buff_offset+2] = (uint8_t)((value >> 8) & 0xFF);
-    buff_addr[buff_offset+3] = (uint8_t)(value & 0xFF);
+  /* MP Entry values follow the tags (12 bytes each) and the next IFD offset */
+  entry_offset = mp_header + ifd_offset + MP_INDEX_COUNT_BYTES +
+    (uint32_t)ifd_tag_count * MP_TAG_BYTES + MP_INDEX_OFFSET_OF_NEXT_IFD_BYTES;
+  if (entry_offset + MM_JPEG_MAX_MPO_IMAGES * MP_INDEX_ENTRY_VALUE_BYTES >
+    seg_end) {
+    LOGE("MP Entry values out of bounds, tag count %d", ifd_tag_count);
+    return -1;
   }
+
+  layout->app2_offset = seg_offset;
+  layout->mp_header_offset = mp_header;
+  layout->mp_entry_offset = entry_offset;
+  layout->app2_end = seg_end;
+  layout->little_endian = (endianess == MPO_LITTLE_ENDIAN);
+  return 0;
 }
 
-/** mm_jpeg_mpo_get_app_marker
+/** mm_jpeg_mpo_check_layout
  *
  *  Arguments:
- *    @buffer_addr: Jpeg image start addr
- *    @buffer_size: Size of the Buffer
- *    @app_marker: app_marker to find
+ *    @buff_addr: Jpeg image start addr
+ *    @buffer_size: Size of the image
+ *    @layout: layout resolved for a previous image
  *
  *  Return:
- *       Start offset of the specified app marker
+ *       TRUE if the image has the same MP Format APP2 layout
+ *       as the previous one
  *
  *  Description:
- *       Gets the start offset of the given app marker
+ *       The encoder lays out the header segments identically for
+ *       every capture of a session, so the APP2 segment at the
+ *       previous offset is parsed before walking the segments
+ *       again. Any difference in the MP header, byte order or MP
+ *       Entry position rejects the cached layout.
  *
  **/
-uint8_t *mm_jpeg_mpo_get_app_marker(uint8_t *buffer_addr, int buffer_size,
-  int app_marker)
+static int mm_jpeg_mpo_check_layout(uint8_t *buff_addr, uint32_t buffer_size,
+  mm_jpeg_mpo_layout_t *layout)
 {
-  int32_t byte;
-  uint8_t *p_current_addr = NULL, *p_start_offset = NULL;
-  uint16_t app_marker_size = 0;
-
-  p_current_addr = buffer_addr;
-  do {
-    do {
-      byte = *(p_current_addr);
-      p_current_addr++;
-    }
-    while ((byte != 0xFF) &&
-      (p_current_addr < (buffer_addr + (buffer_size - 1))));
+  mm_jpeg_mpo_layout_t current;
+  uint32_t off = layout->app2_offset;
+  uint16_t seg_len;
 
-    //If 0xFF is not found at all, break
-    if (byte != 0xFF) {
-      LOGD("0xFF not found");
-      break;
-    }
-
-    //Read the next byte after 0xFF
-    byte = *(p_current_addr);
-    LOGD("Byte %x", byte);
-    if (byte == app_marker) {
-      LOGD("Byte %x", byte);
-      p_start_offset = ++p_current_addr;
-      break;
-    } else if (byte != M_SOI) {
-      app_marker_size = READ_SHORT(p_current_addr, 1);
-      LOGD("size %d", app_marker_size);
-      p_current_addr += app_marker_size;
-    }
+  if (!layout->app2_end || layout->app2_end > buffer_size) {
+    return FALSE;
   }
-  while ((byte != M_EOI) &&
-    (p_current_addr < (buffer_addr + (buffer_size - 1))));
-
-  return p_start_offset;
+  if ((buff_addr[off] != 0xFF) || (buff_addr[off + 1] != M_APP2)) {
+    return FALSE;
+  }
+  seg_len = READ_SHORT(buff_addr, off + MP_APP2_MARKER_BYTES);
+  if (off + MP_APP2_MARKER_BYTES + seg_len != layout->app2_end) {
+    return FALSE;
+  }
+  if (mm_jpeg_mpo_parse_app2(buff_addr, off, layout->app2_end, &current)) {
+    return FALSE;
+  }
+  return (current.mp_header_offset == layout->mp_header_offset) &&
+    (current.mp_entry_offset == layout->mp_entry_offset) &&
+    (current.little_endian == layout->little_endian);
 }
 
-/** mm_jpeg_mpo_get_mp_header
+/** mm_jpeg_mpo_find_layout
  *
  *  Arguments:
- *    @app2_marker: app2_marker start offset
+ *    @buff_addr: Jpeg image start addr
+ *    @buffer_size: Size of the image
+ *    @layout: filled with the resolved offsets
  *
  *  Return:
- *       Start offset of the MP header
+ *       0 - Success
+ *      -1 - otherwise
  *
  *  Description:
- *       Get the start offset of the MP header (before the MP
- *       Endian field). All offsets in the MP header need to be
- *       specified wrt this start offset.
+ *       Find the MP Format APP2 segment by stepping from one
+ *       marker segment header to the next. Only the headers before
+ *       the scan data are visited.
  *
  **/
-uint8_t *mm_jpeg_mpo_get_mp_header(uint8_t *app2_start_offset)
+static int mm_jpeg_mpo_find_layout(uint8_t *buff_addr, uint32_t buffer_size,
+  mm_jpeg_mpo_layout_t *layout)
 {
-  uint8_t *mp_headr_start_offset = NULL;
+  uint32_t off = MP_APP2_MARKER_BYTES, seg_end;
+  uint16_t seg_len;
+  uint8_t marker;
+
+  if ((buffer_size < MP_APP2_MARKER_BYTES) || (buff_addr[0] != 0xFF) ||
+    (buff_addr[1] != M_SOI)) {
+    LOGE("Primary image does not start with SOI");
+    return -1;
+  }
 
-  if (app2_start_offset != NULL) {
-    mp_headr_start_offset = app2_start_offset + MP_APP2_FIELD_LENGTH_BYTES +
-      MP_FORMAT_IDENTIFIER_BYTES;
+  while (off + MP_APP2_MARKER_BYTES + MP_APP2_FIELD_LENGTH_BYTES <=
+    buffer_size) {
+    if (buff_addr[off] != 0xFF) {
+      LOGE("Marker expected at offset %d", off);
+      return -1;
+    }
+    marker = buff_addr[off + 1];
+    if (marker == 0xFF) {
+      /* fill byte */
+      off++;
+      continue;
+    }
+    if ((marker == M_SOS) || (marker == M_EOI)) {
+      break;
+    }
+
+    seg_len = READ_SHORT(buff_addr, off + MP_APP2_MARKER_BYTES);
+    seg_end = off + MP_APP2_MARKER_BYTES + seg_len;
+    if (seg_end > buffer_size) {
+      LOGE("Segment %x at offset %d out of bounds", marker, off);
+      return -1;
+    }
+    if ((marker == M_APP2) &&
+      !mm_jpeg_mpo_parse_app2(buff_addr, off, seg_end, layout)) {
+      LOGD("MP header at offset %d, MP entry at offset %d",
+        layout->mp_header_offset, layout->mp_entry_offset);
+      return 0;
+    }
+    off = seg_end;
   }
 
-  return mp_headr_start_offset;
+  LOGE("Cannot find MP Format App2 marker");
+  return -1;
 }
 
 /** mm_jpeg_mpo_update_header
@@ -238,123 +314,43 @@ uint8_t *mm_jpeg_mpo_get_mp_header(uint8_t *app2_start_offset)
  *      about about all other images.
  *
  **/
-int mm_jpeg_mpo_update_header(mm_jpeg_mpo_info_t *mpo_info)
+static int mm_jpeg_mpo_update_header(mm_jpeg_mpo_info_t *mpo_info)
 {
-  uint8_t *app2_start_off_addr = NULL, *mp_headr_start_off_addr = NULL;
-  uint32_t mp_index_ifd_offset = 0, current_offset = 0, mp_entry_val_offset = 0;
-  uint8_t *aux_start_addr = NULL;
-  uint8_t overflow_flag;
-  int i = 0, rc = -1;
-  uint32_t endianess = MPO_LITTLE_ENDIAN, offset_to_nxt_ifd = 8;
-  uint16_t ifd_tag_count = 0;
-
-  //Get the addr of the App Marker
-  app2_start_off_addr = mm_jpeg_mpo_get_app_marker(
-    mpo_info->output_buff.buf_vaddr, mpo_info->primary_image.buf_filled_len, M_APP2);
-  if (!app2_start_off_addr) {
-    LOGE("Cannot find App2 marker. MPO composition failed" );
-    return rc;
-  }
-  LOGD("app2_start_off_addr %p = %x",
-    app2_start_off_addr, *app2_start_off_addr);
-
-  //Get the addr of the MP Headr start offset.
-  //All offsets in the MP header are wrt to this addr
-  mp_headr_start_off_addr = mm_jpeg_mpo_get_mp_header(app2_start_off_addr);
-  if (!mp_headr_start_off_addr) {
-    LOGE("mp headr start offset is NULL. MPO composition failed" );
-    return rc;
-  }
-  LOGD("mp_headr_start_off_addr %x",
-    *mp_headr_start_off_addr);
-
-  current_offset = mp_headr_start_off_addr - mpo_info->output_buff.buf_vaddr;
-
-  endianess = READ_LONG(mpo_info->output_buff.buf_vaddr, current_offset);
-  LOGD("Endianess %d", endianess);
-
-  //Add offset to first ifd
-  current_offset += MP_ENDIAN_BYTES;
-
-  //Read the value to get MP Index IFD.
-  if (endianess == MPO_LITTLE_ENDIAN) {
-    offset_to_nxt_ifd = READ_LONG_LITTLE(mpo_info->output_buff.buf_vaddr,
-      current_offset);
-  } else {
-    offset_to_nxt_ifd = READ_LONG(mpo_info->output_buff.buf_vaddr,
-      current_offset);
+  uint8_t *buff_addr = mpo_info->output_buff.buf_vaddr;
+  uint32_t entry_offset, aux_offset;
+  int i;
+
+  if (!mm_jpeg_mpo_check_layout(buff_addr,
+    mpo_info->primary_image.buf_filled_len, &g_mpo_layout) &&
+    mm_jpeg_mpo_find_layout(buff_addr, mpo_info->primary_image.buf_filled_len,
+    &g_mpo_layout)) {
+    memset(&g_mpo_layout, 0, sizeof(g_mpo_layout));
+    LOGE("MPO composition failed");
+    return -1;
   }
-  LOGD("offset_to_nxt_ifd %d", offset_to_nxt_ifd);
-
-  current_offset = ((mp_headr_start_off_addr + offset_to_nxt_ifd) -
-    mpo_info->output_buff.buf_vaddr);
-  mp_index_ifd_offset = current_offset;
-  LOGD("mp_index_ifd_offset %d",
-    mp_index_ifd_offset);
-
-  //Traverse to MP Entry value
-  ifd_tag_count = READ_SHORT(mpo_info->output_buff.buf_vaddr, current_offset);
-  LOGD("Tag count in MP entry %d", ifd_tag_count);
-  current_offset += MP_INDEX_COUNT_BYTES;
-
-  /* Get MP Entry Value offset - Count * 12 (Each tag is 12 bytes)*/
-  current_offset += (ifd_tag_count * 12);
-  /*Add Offset to next IFD*/
-  current_offset += MP_INDEX_OFFSET_OF_NEXT_IFD_BYTES;
-
-  mp_entry_val_offset = current_offset;
-  LOGD("MP Entry value offset %d",
-    mp_entry_val_offset);
 
   //Update image size for primary image
-  current_offset += MP_INDEX_ENTRY_INDIVIDUAL_IMAGE_ATTRIBUTE_BYTES;
-  if (endianess == MPO_LITTLE_ENDIAN) {
-    mm_jpeg_mpo_write_long_little_endian(mpo_info->output_buff.buf_vaddr,
-      current_offset, mpo_info->output_buff_size,
-      mpo_info->primary_image.buf_filled_len, &overflow_flag);
-  } else {
-    mm_jpeg_mpo_write_long(mpo_info->output_buff.buf_vaddr,
-      current_offset, mpo_info->output_buff_size,
-      mpo_info->primary_image.buf_filled_len, &overflow_flag);
-  }
-
-  aux_start_addr = mpo_info->output_buff.buf_vaddr +
-    mpo_info->primary_image.buf_filled_len;
-
+  entry_offset = g_mpo_layout.mp_entry_offset;
+  mm_jpeg_mpo_put_long(buff_addr + entry_offset +
+    MP_INDEX_ENTRY_INDIVIDUAL_IMAGE_ATTRIBUTE_BYTES,
+    mpo_info->primary_image.buf_filled_len, g_mpo_layout.little_endian);
+
+  //Update size and offset (wrt the MP header) of each aux image
+  aux_offset = mpo_info->primary_image.buf_filled_len -
+    g_mpo_layout.mp_header_offset;
   for (i = 0; i < mpo_info->num_of_images - 1; i++) {
-    //Go to MP Entry val for each image
-    mp_entry_val_offset += MP_INDEX_ENTRY_VALUE_BYTES;
-    current_offset = mp_entry_val_offset;
-
-    //Update image size
-    current_offset += MP_INDEX_ENTRY_INDIVIDUAL_IMAGE_ATTRIBUTE_BYTES;
-    if (endianess == MPO_LITTLE_ENDIAN) {
-      mm_jpeg_mpo_write_long_little_endian(mpo_info->output_buff.buf_vaddr,
-        current_offset, mpo_info->output_buff_size,
-        mpo_info->aux_images[i].buf_filled_len, &overflow_flag);
-    } else {
-      mm_jpeg_mpo_write_long(mpo_info->output_buff.buf_vaddr,
-        current_offset, mpo_info->output_buff_size,
-        mpo_info->aux_images[i].buf_filled_len, &overflow_flag);
-    }
-    LOGD("aux[start_addr %x", *aux_start_addr);
-    //Update the offset
-    current_offset += MP_INDEX_ENTRY_INDIVIDUAL_IMAGE_SIZE_BYTES;
-    if (endianess == MPO_LITTLE_ENDIAN) {
-      mm_jpeg_mpo_write_long_little_endian(mpo_info->output_buff.buf_vaddr,
-        current_offset, mpo_info->output_buff_size,
-        aux_start_addr - mp_headr_start_off_addr, &overflow_flag);
-    } else {
-      mm_jpeg_mpo_write_long(mpo_info->output_buff.buf_vaddr,
-        current_offset, mpo_info->output_buff_size,
-        aux_start_addr - mp_headr_start_off_addr, &overflow_flag);
-    }
-    aux_start_addr += mpo_info->aux_images[i].buf_filled_len;
-  }
-  if (!overflow_flag) {
-    rc = 0;
+    entry_offset += MP_INDEX_ENTRY_VALUE_BYTES;
+    mm_jpeg_mpo_put_long(buff_addr + entry_offset +
+      MP_INDEX_ENTRY_INDIVIDUAL_IMAGE_ATTRIBUTE_BYTES,
+      mpo_info->aux_images[i].buf_filled_len, g_mpo_layout.little_endian);
+    mm_jpeg_mpo_put_long(buff_addr + entry_offset +
+      MP_INDEX_ENTRY_INDIVIDUAL_IMAGE_ATTRIBUTE_BYTES +
+      MP_INDEX_ENTRY_INDIVIDUAL_IMAGE_SIZE_BYTES,
+      aux_offset, g_mpo_layout.little_endian);
+    aux_offset += mpo_info->aux_images[i].buf_filled_len;
   }
-  return rc;
+
+  return 0;
 }
 
 /** mm_jpeg_mpo_compose
@@ -170,6 +170,10 @@ uint32_t QCameraBufferMaps::enqueue(cam_mapping_buf_type pType,
         int32_t pFd,
         size_t pSize)
 {
+    if (mBufMapList.length >= CAM_MAX_NUM_BUFS_PER_STREAM) {
+        return BAD_INDEX;
+    }
+
     uint32_t pos = mBufMapList.length++;
     mBufMapList.buf_maps[pos].type = pType;
     mBufMapList.buf_maps[pos].stream_id = pStreamId;
@@ -243,4 +247,37 @@ uint32_t QCameraBufferMaps::makeSingletonBufMapList(cam_mapping_buf_type pType,
     return rc;
 }
 
+/*===========================================================================
+ * FUNCTION   : enqueueUnmap
+ *
+ * DESCRIPTION: Add a buffer unmap to a list sent with a single message
+ *
+ * PARAMETERS :
+ *   @pType   : Type of buffer
+ *   @pFrameIndex : Frame index
+ *   @pPlaneIndex : Plane index
+ *   @pBufUnmapList : [in/out] the list of buffer unmaps
+ *
+ * RETURN     : int32_t type of status
+ *              NO_ERROR  -- success
+ *              none-zero failure code
+ *==========================================================================*/
+uint32_t QCameraBufferMaps::enqueueUnmap(cam_mapping_buf_type pType,
+        uint32_t pFrameIndex,
+        int32_t pPlaneIndex,
+        cam_buf_unmap_type_list& pBufUnmapList)
+{
+    if (pBufUnmapList.length >= CAM_MAX_NUM_BUFS_PER_STREAM) {
+        return BAD_INDEX;
+    }
+
+    uint32_t pos = pBufUnmapList.length++;
+    memset(&pBufUnmapList.buf_unmaps[pos], 0, sizeof(cam_buf_unmap_type));
+    pBufUnmapList.buf_unmaps[pos].type = pType;
+    pBufUnmapList.buf_unmaps[pos].frame_idx = pFrameIndex;
+    pBufUnmapList.buf_unmaps[pos].plane_idx = pPlaneIndex;
+
+    return NO_ERROR;
+}
+
 }; // namespace qcamera
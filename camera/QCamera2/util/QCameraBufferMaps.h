@@ -71,6 +71,11 @@ public:
             size_t pSize,
             cam_buf_map_type_list& pBufMapList);
 
+    static uint32_t enqueueUnmap(cam_mapping_buf_type pType,
+            uint32_t pFrameIndex,
+            int32_t pPlaneIndex,
+            cam_buf_unmap_type_list& pBufUnmapList);
+
 private:
     cam_buf_map_type_list mBufMapList;
 };
@@ -0,0 +1,446 @@
+/* Copyright (c) 2016, The Linux Foundation. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above
+*       copyright notice, this list of conditions and the following
+*       disclaimer in the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of The Linux Foundation nor the names of its
+*       contributors may be used to endorse or promote products derived
+*       from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+* ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+* WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+* OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+* IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#define LOG_TAG "QCameraCapsCache"
+
+// System dependencies
+#include <cutils/properties.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Camera dependencies
+#include "QCameraCapsCache.h"
+
+extern "C" {
+#include "mm_camera_dbg.h"
+#include "mm_camera_interface.h"
+}
+
+namespace qcamera {
+
+// Keeps the metadata payload 8 byte aligned inside the mapping
+static_assert((sizeof(qcamera_caps_cache_header_t) % 8) == 0,
+        "caps cache header must keep the payload aligned");
+
+// Properties read while building the static metadata
+static const char *kStaticMetaProps[] = {
+    "persist.camera.facedetect",
+    "persist.camera.hal3hfr.enable",
+};
+
+/*===========================================================================
+ * FUNCTION   : getInstance
+ *
+ * DESCRIPTION: Get and create the QCameraCapsCache singleton.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : The QCameraCapsCache object
+ *==========================================================================*/
+QCameraCapsCache& QCameraCapsCache::getInstance()
+{
+    static QCameraCapsCache instance;
+    return instance;
+}
+
+/*===========================================================================
+ * FUNCTION   : QCameraCapsCache
+ *
+ * DESCRIPTION: default constructor of QCameraCapsCache. Builds the part of
+ *              the cache key shared by all cameras: the build fingerprint
+ *              and the size and time stamp of the HAL library.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+QCameraCapsCache::QCameraCapsCache() :
+    mEnabled(false)
+{
+    char prop[PROPERTY_VALUE_MAX];
+    char fingerprint[PROPERTY_VALUE_MAX];
+    struct stat st;
+    Dl_info info;
+
+    pthread_mutex_init(&mLock, NULL);
+    memset(mBuildKey, 0, sizeof(mBuildKey));
+
+    property_get("persist.camera.capcache.enable", prop, "1");
+    mEnabled = (atoi(prop) > 0);
+    if (!mEnabled) {
+        return;
+    }
+
+    // A HAL pushed by hand keeps the fingerprint, so stamp the library too
+    memset(&st, 0, sizeof(st));
+    memset(&info, 0, sizeof(info));
+    if (!dladdr(reinterpret_cast<void *>(&QCameraCapsCache::getInstance), &info) ||
+            (info.dli_fname == NULL) || (stat(info.dli_fname, &st) != 0)) {
+        LOGW("Cannot stamp the HAL library, capability cache disabled");
+        mEnabled = false;
+        return;
+    }
+
+    property_get("ro.build.fingerprint", fingerprint, "");
+    snprintf(mBuildKey, sizeof(mBuildKey), "%s|%lld:%lld|%zu",
+            fingerprint, (long long)st.st_size, (long long)st.st_mtime,
+            sizeof(cam_capability_t));
+}
+
+/*===========================================================================
+ * FUNCTION   : ~QCameraCapsCache
+ *
+ * DESCRIPTION: deconstructor of QCameraCapsCache
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+QCameraCapsCache::~QCameraCapsCache()
+{
+    pthread_mutex_destroy(&mLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : checksum
+ *
+ * DESCRIPTION: 32 bit FNV-1a hash of a payload
+ *
+ * PARAMETERS :
+ *   @data    : payload
+ *   @size    : payload size
+ *
+ * RETURN     : hash value
+ *==========================================================================*/
+uint32_t QCameraCapsCache::checksum(const void *data, size_t size)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/*===========================================================================
+ * FUNCTION   : makeKey
+ *
+ * DESCRIPTION: build the cache key of a camera from the build key and the
+ *              sensor identity enumerated by mm-camera-interface, which
+ *              doesn't require powering up the sensor
+ *
+ * PARAMETERS :
+ *   @cameraId: camera Id
+ *   @key     : output buffer
+ *   @len     : size of the output buffer
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraCapsCache::makeKey(uint32_t cameraId, char *key, size_t len)
+{
+    cam_sync_type_t camType = CAM_TYPE_MAIN;
+    struct camera_info *info = get_cam_info(cameraId, &camType);
+    char prop[PROPERTY_VALUE_MAX];
+    size_t off;
+
+    off = (size_t)snprintf(key, len, "%s|%u|%s|%d|%d|%d|%u", mBuildKey,
+            cameraId, get_sensor_name(cameraId), info->facing,
+            info->orientation, (int)camType, is_yuv_sensor(cameraId));
+    for (size_t i = 0; (i < sizeof(kStaticMetaProps) / sizeof(kStaticMetaProps[0])) &&
+            (off < len); i++) {
+        property_get(kStaticMetaProps[i], prop, "");
+        off += (size_t)snprintf(key + off, len - off, "|%s", prop);
+    }
+}
+
+/*===========================================================================
+ * FUNCTION   : makePath
+ *
+ * DESCRIPTION: build the path of a cache file
+ *
+ * PARAMETERS :
+ *   @cameraId: camera Id
+ *   @type    : payload type
+ *   @path    : output buffer
+ *   @len     : size of the output buffer
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraCapsCache::makePath(uint32_t cameraId,
+        qcamera_caps_cache_type_t type, char *path, size_t len)
+{
+    snprintf(path, len, QCAMERA_CAPS_CACHE_DIR "%s%u.bin",
+            (type == QCAMERA_CAPS_CACHE_CAPABILITY) ? "caps" : "meta",
+            cameraId);
+}
+
+/*===========================================================================
+ * FUNCTION   : map
+ *
+ * DESCRIPTION: map a cache file read only and validate its header, key and
+ *              checksum
+ *
+ * PARAMETERS :
+ *   @cameraId: camera Id
+ *   @type    : payload type
+ *   @size    : filled with the payload size
+ *
+ * RETURN     : start of the mapping (the header), NULL if the file is
+ *              missing or stale. The mapping is sizeof(header) + *size long.
+ *==========================================================================*/
+void *QCameraCapsCache::map(uint32_t cameraId,
+        qcamera_caps_cache_type_t type, size_t *size)
+{
+    char path[PATH_MAX];
+    char key[QCAMERA_CAPS_CACHE_KEY_LEN];
+    const qcamera_caps_cache_header_t *header;
+    struct stat st;
+    void *base;
+    int fd;
+
+    if (!mEnabled) {
+        return NULL;
+    }
+
+    makePath(cameraId, type, path, sizeof(path));
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGD("No cache file %s", path);
+        return NULL;
+    }
+    if ((fstat(fd, &st) != 0) ||
+            ((size_t)st.st_size <= sizeof(qcamera_caps_cache_header_t))) {
+        LOGW("Bad cache file %s", path);
+        close(fd);
+        return NULL;
+    }
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOGE("Failed to map %s: %s", path, strerror(errno));
+        return NULL;
+    }
+
+    header = (const qcamera_caps_cache_header_t *)base;
+    *size = (size_t)st.st_size - sizeof(qcamera_caps_cache_header_t);
+    makeKey(cameraId, key, sizeof(key));
+    if ((header->magic != QCAMERA_CAPS_CACHE_MAGIC) ||
+            (header->version != QCAMERA_CAPS_CACHE_VERSION) ||
+            (header->type != (uint32_t)type) ||
+            (header->size != *size) ||
+            (strncmp(header->key, key, sizeof(key)) != 0)) {
+        LOGH("Stale cache file %s", path);
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    if (header->checksum != checksum(header + 1, *size)) {
+        LOGE("Corrupted cache file %s", path);
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+
+    return base;
+}
+
+/*===========================================================================
+ * FUNCTION   : store
+ *
+ * DESCRIPTION: write a cache file. The file is written under a temporary
+ *              name and renamed, so readers never see a partial file.
+ *
+ * PARAMETERS :
+ *   @cameraId: camera Id
+ *   @type    : payload type
+ *   @data    : payload
+ *   @size    : payload size
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraCapsCache::store(uint32_t cameraId,
+        qcamera_caps_cache_type_t type, const void *data, size_t size)
+{
+    char path[PATH_MAX];
+    char tmpPath[PATH_MAX];
+    qcamera_caps_cache_header_t header;
+    bool ok;
+    int fd;
+
+    if (!mEnabled || (data == NULL) || (size == 0)) {
+        return;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = QCAMERA_CAPS_CACHE_MAGIC;
+    header.version = QCAMERA_CAPS_CACHE_VERSION;
+    header.type = (uint32_t)type;
+    header.size = (uint32_t)size;
+    header.checksum = checksum(data, size);
+    makeKey(cameraId, header.key, sizeof(header.key));
+
+    makePath(cameraId, type, path, sizeof(path));
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+
+    pthread_mutex_lock(&mLock);
+    fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0660);
+    if (fd < 0) {
+        LOGW("Failed to create %s: %s", tmpPath, strerror(errno));
+        pthread_mutex_unlock(&mLock);
+        return;
+    }
+    ok = (write(fd, &header, sizeof(header)) == (ssize_t)sizeof(header)) &&
+            (write(fd, data, size) == (ssize_t)size) &&
+            (fsync(fd) == 0);
+    close(fd);
+    if (!ok || (rename(tmpPath, path) != 0)) {
+        LOGE("Failed to write %s: %s", path, strerror(errno));
+        unlink(tmpPath);
+    } else {
+        LOGH("Cached %zu bytes in %s", size, path);
+    }
+    pthread_mutex_unlock(&mLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : loadCapability
+ *
+ * DESCRIPTION: load the cached capability of a camera
+ *
+ * PARAMETERS :
+ *   @cameraId: camera Id
+ *
+ * RETURN     : malloc'ed copy of the capability, owned by the caller.
+ *              NULL if there is no valid cache entry.
+ *==========================================================================*/
+cam_capability_t *QCameraCapsCache::loadCapability(uint32_t cameraId)
+{
+    cam_capability_t *caps = NULL;
+    size_t size = 0;
+    void *base = map(cameraId, QCAMERA_CAPS_CACHE_CAPABILITY, &size);
+
+    if (base == NULL) {
+        return NULL;
+    }
+    if (size == sizeof(cam_capability_t)) {
+        caps = (cam_capability_t *)malloc(sizeof(cam_capability_t));
+        if (caps != NULL) {
+            memcpy(caps, (qcamera_caps_cache_header_t *)base + 1, size);
+        }
+    }
+    munmap(base, sizeof(qcamera_caps_cache_header_t) + size);
+
+    LOGI("Camera %u capability %s", cameraId,
+            (caps != NULL) ? "loaded from cache" : "not usable");
+    return caps;
+}
+
+/*===========================================================================
+ * FUNCTION   : storeCapability
+ *
+ * DESCRIPTION: cache the capability of a camera
+ *
+ * PARAMETERS :
+ *   @cameraId: camera Id
+ *   @caps    : capability queried from the backend
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraCapsCache::storeCapability(uint32_t cameraId,
+        const cam_capability_t *caps)
+{
+    store(cameraId, QCAMERA_CAPS_CACHE_CAPABILITY, caps, sizeof(*caps));
+}
+
+/*===========================================================================
+ * FUNCTION   : loadStaticMetadata
+ *
+ * DESCRIPTION: map the cached static metadata of a camera. The metadata is
+ *              used in place and the mapping is kept for the lifetime of
+ *              the process, like the static metadata built at run time.
+ *
+ * PARAMETERS :
+ *   @cameraId: camera Id
+ *
+ * RETURN     : static metadata, NULL if there is no valid cache entry
+ *==========================================================================*/
+const camera_metadata_t *QCameraCapsCache::loadStaticMetadata(uint32_t cameraId)
+{
+    const camera_metadata_t *meta;
+    size_t size = 0;
+    size_t expected = 0;
+    void *base = map(cameraId, QCAMERA_CAPS_CACHE_STATIC_META, &size);
+
+    if (base == NULL) {
+        return NULL;
+    }
+
+    meta = (const camera_metadata_t *)((qcamera_caps_cache_header_t *)base + 1);
+    expected = size;
+    if ((validate_camera_metadata_structure(meta, &expected) != 0) ||
+            (get_camera_metadata_size(meta) != size)) {
+        LOGE("Invalid cached static metadata for camera %u", cameraId);
+        munmap(base, sizeof(qcamera_caps_cache_header_t) + size);
+        return NULL;
+    }
+
+    LOGI("Camera %u static metadata loaded from cache", cameraId);
+    return meta;
+}
+
+/*===========================================================================
+ * FUNCTION   : storeStaticMetadata
+ *
+ * DESCRIPTION: cache the static metadata of a camera
+ *
+ * PARAMETERS :
+ *   @cameraId: camera Id
+ *   @meta    : static metadata
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraCapsCache::storeStaticMetadata(uint32_t cameraId,
+        const camera_metadata_t *meta)
+{
+    if (meta == NULL) {
+        return;
+    }
+    store(cameraId, QCAMERA_CAPS_CACHE_STATIC_META, meta,
+            get_camera_metadata_size(meta));
+}
+
+}; // namespace qcamera
@@ -0,0 +1,100 @@
+/* Copyright (c) 2016, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __QCAMERA_CAPS_CACHE_H__
+#define __QCAMERA_CAPS_CACHE_H__
+
+// System dependencies
+#include <pthread.h>
+#include "system/camera_metadata.h"
+
+// Camera dependencies
+#include "cam_intf.h"
+
+namespace qcamera {
+
+#define QCAMERA_CAPS_CACHE_DIR      "/data/vendor/camera/cache/"
+#define QCAMERA_CAPS_CACHE_MAGIC    0x43434351  // "QCCC"
+// Bump whenever the file layout or the way the payload is built changes
+#define QCAMERA_CAPS_CACHE_VERSION  1
+#define QCAMERA_CAPS_CACHE_KEY_LEN  256
+
+typedef enum {
+    QCAMERA_CAPS_CACHE_CAPABILITY,      // raw cam_capability_t
+    QCAMERA_CAPS_CACHE_STATIC_META,     // serialized camera_metadata_t
+} qcamera_caps_cache_type_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t type;
+    uint32_t size;                      // payload size following the header
+    uint32_t checksum;                  // FNV-1a of the payload
+    uint32_t reserved;
+    char key[QCAMERA_CAPS_CACHE_KEY_LEN];
+} qcamera_caps_cache_header_t;
+
+/* On-disk copy of the backend capability blob and of the static metadata
+ * built from it, so the first get_camera_info after a boot or a camera
+ * server restart doesn't have to power up every sensor. Each file carries
+ * a key made of the build fingerprint, the HAL library stamp and the
+ * sensor identity reported by the kernel; any mismatch, a bad checksum or
+ * a malformed payload makes the caller fall back to the live query, whose
+ * result then replaces the file. */
+class QCameraCapsCache {
+public:
+    static QCameraCapsCache& getInstance();
+
+    cam_capability_t *loadCapability(uint32_t cameraId);
+    void storeCapability(uint32_t cameraId, const cam_capability_t *caps);
+    const camera_metadata_t *loadStaticMetadata(uint32_t cameraId);
+    void storeStaticMetadata(uint32_t cameraId, const camera_metadata_t *meta);
+
+private:
+    QCameraCapsCache();
+    ~QCameraCapsCache();
+    QCameraCapsCache(const QCameraCapsCache&);
+    QCameraCapsCache& operator=(const QCameraCapsCache&);
+
+    static uint32_t checksum(const void *data, size_t size);
+    void makeKey(uint32_t cameraId, char *key, size_t len);
+    void makePath(uint32_t cameraId, qcamera_caps_cache_type_t type,
+            char *path, size_t len);
+    void *map(uint32_t cameraId, qcamera_caps_cache_type_t type, size_t *size);
+    void store(uint32_t cameraId, qcamera_caps_cache_type_t type,
+            const void *data, size_t size);
+
+    pthread_mutex_t mLock;
+    bool mEnabled;
+    char mBuildKey[QCAMERA_CAPS_CACHE_KEY_LEN];
+};
+
+}; // namespace qcamera
+
+#endif /* __QCAMERA_CAPS_CACHE_H__ */
@@ -0,0 +1,304 @@
+/* Copyright (c) 2016, The Linux Foundation. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above
+*       copyright notice, this list of conditions and the following
+*       disclaimer in the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of The Linux Foundation nor the names of its
+*       contributors may be used to endorse or promote products derived
+*       from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+* ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+* WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+* OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+* IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#define LOG_TAG "QCameraDebugConfig"
+
+// System dependencies
+#include <cutils/properties.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/system_properties.h>
+
+// Camera dependencies
+#include "QCameraDebugConfig.h"
+
+extern "C" {
+#include "mm_camera_dbg.h"
+}
+
+namespace qcamera {
+
+// How often an idle watcher checks whether it is still needed, in ms
+#define DEBUG_CONFIG_WATCH_TIMEOUT_MS 500
+
+// Properties of qcamera_debug_config_t, watched for changes
+static const char *const kDebugProps[QCAMERA_DEBUG_CONFIG_PROPS] = {
+    "persist.camera.dumpimg",
+    "persist.camera.dumpmetadata",
+    "persist.camera.zsl_raw",
+    "persist.camera.zsl_yuv",
+    "persist.camera.zsl_matching",
+    "persist.camera.nonzsl.yuv",
+    "persist.camera.preview_raw",
+    "persist.camera.video_raw",
+    "persist.camera.snapshot_raw",
+};
+
+/*===========================================================================
+ * FUNCTION   : getInstance
+ *
+ * DESCRIPTION: Get and create the QCameraDebugConfig singleton.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : The QCameraDebugConfig object
+ *==========================================================================*/
+QCameraDebugConfig& QCameraDebugConfig::getInstance()
+{
+    static QCameraDebugConfig instance;
+    return instance;
+}
+
+/*===========================================================================
+ * FUNCTION   : QCameraDebugConfig
+ *
+ * DESCRIPTION: default constructor of QCameraDebugConfig. Starts out with
+ *              every debug option off until init() is called.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+QCameraDebugConfig::QCameraDebugConfig() :
+    mCurrent(0),
+    mUsers(0),
+    mWatching(false)
+{
+    memset(mSlots, 0, sizeof(mSlots));
+    memset(mSerials, 0, sizeof(mSerials));
+    for (uint32_t i = 0; i < QCAMERA_DEBUG_CONFIG_SLOTS; i++) {
+        mRefs[i].store(0);
+    }
+    pthread_mutex_init(&mLock, NULL);
+}
+
+/*===========================================================================
+ * FUNCTION   : init
+ *
+ * DESCRIPTION: load the debug properties and make sure the watcher thread
+ *              runs. Called for every camera open.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraDebugConfig::init()
+{
+    pthread_t tid;
+
+    pthread_mutex_lock(&mLock);
+    updateSerials();
+    pthread_mutex_unlock(&mLock);
+    reload();
+
+    pthread_mutex_lock(&mLock);
+    mUsers++;
+    // A watcher that is still winding down after the last close carries on
+    if (!mWatching) {
+        if (pthread_create(&tid, NULL, watchRoutine, this) == 0) {
+            pthread_setname_np(tid, "CAM_dbgConfig");
+            pthread_detach(tid);
+            mWatching = true;
+        } else {
+            LOGE("Failed to start watcher, debug properties are only "
+                    "read on camera open");
+        }
+    }
+    pthread_mutex_unlock(&mLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : deinit
+ *
+ * DESCRIPTION: drop one camera reference. The watcher thread exits on its
+ *              own once no camera is open.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraDebugConfig::deinit()
+{
+    pthread_mutex_lock(&mLock);
+    if (mUsers > 0) {
+        mUsers--;
+    }
+    pthread_mutex_unlock(&mLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : get
+ *
+ * DESCRIPTION: copy the current snapshot. The slot is pinned while it is
+ *              copied, so a reload never rewrites it underneath.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : the current debug configuration
+ *==========================================================================*/
+qcamera_debug_config_t QCameraDebugConfig::get()
+{
+    qcamera_debug_config_t config;
+
+    for (;;) {
+        uint32_t slot = mCurrent.load();
+        mRefs[slot].fetch_add(1);
+        // The slot may have been retired and picked for reuse meanwhile
+        if (mCurrent.load() == slot) {
+            config = mSlots[slot];
+            mRefs[slot].fetch_sub(1);
+            break;
+        }
+        mRefs[slot].fetch_sub(1);
+    }
+
+    return config;
+}
+
+/*===========================================================================
+ * FUNCTION   : updateSerials
+ *
+ * DESCRIPTION: refresh the serials of the debug properties. Caller holds
+ *              mLock.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : true if any of the debug properties changed
+ *==========================================================================*/
+bool QCameraDebugConfig::updateSerials()
+{
+    bool changed = false;
+
+    for (uint32_t i = 0; i < QCAMERA_DEBUG_CONFIG_PROPS; i++) {
+        const prop_info *pi = __system_property_find(kDebugProps[i]);
+        uint32_t serial = (pi != NULL) ? __system_property_serial(pi) : 0;
+        if (serial != mSerials[i]) {
+            mSerials[i] = serial;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+/*===========================================================================
+ * FUNCTION   : reload
+ *
+ * DESCRIPTION: read the debug properties into a slot no reader holds and
+ *              publish it
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraDebugConfig::reload()
+{
+    char value[PROPERTY_VALUE_MAX];
+    int values[QCAMERA_DEBUG_CONFIG_PROPS];
+    qcamera_debug_config_t config;
+    uint32_t slot;
+
+    for (uint32_t i = 0; i < QCAMERA_DEBUG_CONFIG_PROPS; i++) {
+        property_get(kDebugProps[i], value, "0");
+        values[i] = atoi(value);
+    }
+    config.dump_img = (uint32_t) values[0];
+    config.dump_metadata = (uint32_t) values[1];
+    config.zsl_raw = values[2] > 0 ? true : false;
+    config.zsl_yuv = values[3] > 0 ? true : false;
+    config.zsl_matching = values[4] > 0 ? true : false;
+    config.nonzsl_yuv = values[5] > 0 ? true : false;
+    config.preview_raw = values[6] > 0 ? true : false;
+    config.video_raw = values[7] > 0 ? true : false;
+    config.snapshot_raw = values[8] > 0 ? true : false;
+
+    pthread_mutex_lock(&mLock);
+    // Readers only hold a slot for the length of a copy
+    for (;;) {
+        uint32_t current = mCurrent.load();
+        for (slot = 0; slot < QCAMERA_DEBUG_CONFIG_SLOTS; slot++) {
+            if ((slot != current) && (mRefs[slot].load() == 0)) {
+                break;
+            }
+        }
+        if (slot < QCAMERA_DEBUG_CONFIG_SLOTS) {
+            break;
+        }
+        sched_yield();
+    }
+    mSlots[slot] = config;
+    mCurrent.store(slot);
+    pthread_mutex_unlock(&mLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : watchRoutine
+ *
+ * DESCRIPTION: reload the snapshot when one of the debug properties
+ *              changes. Exits once no camera is open.
+ *
+ * PARAMETERS :
+ *   @data    : user data ptr (QCameraDebugConfig)
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void *QCameraDebugConfig::watchRoutine(void *data)
+{
+    QCameraDebugConfig *pme = (QCameraDebugConfig *)data;
+    struct timespec timeout;
+    uint32_t serial = 0;
+    bool changed;
+
+    timeout.tv_sec = 0;
+    timeout.tv_nsec = DEBUG_CONFIG_WATCH_TIMEOUT_MS * 1000000L;
+
+    // The global serial only wakes us up, the property serials decide.
+    __system_property_wait(NULL, 0, &serial, NULL);
+    for (;;) {
+        bool woken = __system_property_wait(NULL, serial, &serial, &timeout);
+
+        pthread_mutex_lock(&pme->mLock);
+        if (pme->mUsers == 0) {
+            pme->mWatching = false;
+            pthread_mutex_unlock(&pme->mLock);
+            break;
+        }
+        changed = woken && pme->updateSerials();
+        pthread_mutex_unlock(&pme->mLock);
+
+        if (changed) {
+            pme->reload();
+        }
+    }
+
+    return NULL;
+}
+
+}; // namespace qcamera
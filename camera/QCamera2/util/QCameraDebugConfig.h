@@ -0,0 +1,89 @@
+/* Copyright (c) 2016, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __QCAMERA_DEBUG_CONFIG_H__
+#define __QCAMERA_DEBUG_CONFIG_H__
+
+// System dependencies
+#include <atomic>
+#include <pthread.h>
+#include <stdint.h>
+
+namespace qcamera {
+
+// Snapshots kept around so a reload always finds one no reader holds
+#define QCAMERA_DEBUG_CONFIG_SLOTS 4
+// Number of properties in qcamera_debug_config_t
+#define QCAMERA_DEBUG_CONFIG_PROPS 9
+
+typedef struct {
+    uint32_t dump_img;          // persist.camera.dumpimg
+    uint32_t dump_metadata;     // persist.camera.dumpmetadata
+    bool zsl_raw;               // persist.camera.zsl_raw
+    bool zsl_yuv;               // persist.camera.zsl_yuv
+    bool zsl_matching;          // persist.camera.zsl_matching
+    bool nonzsl_yuv;            // persist.camera.nonzsl.yuv
+    bool preview_raw;           // persist.camera.preview_raw
+    bool video_raw;             // persist.camera.video_raw
+    bool snapshot_raw;          // persist.camera.snapshot_raw
+} qcamera_debug_config_t;
+
+/* Debug properties read by the frame callbacks. The values are loaded
+ * when a camera is opened and, while any camera is open, reloaded by a
+ * watcher thread whenever one of them changes. The callbacks copy the
+ * current snapshot and never go to the property service. */
+class QCameraDebugConfig {
+public:
+    static QCameraDebugConfig& getInstance();
+
+    void init();
+    void deinit();
+    qcamera_debug_config_t get();
+
+private:
+    QCameraDebugConfig();
+    QCameraDebugConfig(const QCameraDebugConfig&);
+    QCameraDebugConfig& operator=(const QCameraDebugConfig&);
+
+    static void *watchRoutine(void *data);
+    bool updateSerials();
+    void reload();
+
+    qcamera_debug_config_t mSlots[QCAMERA_DEBUG_CONFIG_SLOTS];
+    std::atomic<uint32_t> mRefs[QCAMERA_DEBUG_CONFIG_SLOTS];
+    std::atomic<uint32_t> mCurrent;
+    uint32_t mSerials[QCAMERA_DEBUG_CONFIG_PROPS];
+    pthread_mutex_t mLock;
+    uint32_t mUsers;
+    bool mWatching;
+};
+
+}; // namespace qcamera
+
+#endif /* __QCAMERA_DEBUG_CONFIG_H__ */
@@ -0,0 +1,483 @@
+/* Copyright (c) 2016, The Linux Foundation. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above
+*       copyright notice, this list of conditions and the following
+*       disclaimer in the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of The Linux Foundation nor the names of its
+*       contributors may be used to endorse or promote products derived
+*       from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+* ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+* WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+* OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+* IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#define LOG_TAG "QCameraDumpWriter"
+
+// System dependencies
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utils/Errors.h>
+
+// Camera dependencies
+#include "QCameraDumpWriter.h"
+
+extern "C" {
+#include "mm_camera_dbg.h"
+}
+
+using namespace android;
+
+namespace qcamera {
+
+#define DUMP_ALIGN_UP(x) (((x) + QCAMERA_DUMP_ALIGN - 1) & ~((size_t)QCAMERA_DUMP_ALIGN - 1))
+
+/*===========================================================================
+ * FUNCTION   : getInstance
+ *
+ * DESCRIPTION: Get and create the QCameraDumpWriter singleton.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : The QCameraDumpWriter object
+ *==========================================================================*/
+QCameraDumpWriter& QCameraDumpWriter::getInstance()
+{
+    static QCameraDumpWriter instance;
+    return instance;
+}
+
+/*===========================================================================
+ * FUNCTION   : QCameraDumpWriter
+ *
+ * DESCRIPTION: default constructor of QCameraDumpWriter
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+QCameraDumpWriter::QCameraDumpWriter() :
+    mThreadActive(false),
+    mHead(0),
+    mTail(0),
+    mAllocated(0),
+    mPrefixTime(0),
+    mDumped(0),
+    mSkipped(0),
+    mFailed(0),
+    mBytes(0)
+{
+    pthread_mutex_init(&mLock, NULL);
+    pthread_cond_init(&mCond, NULL);
+    pthread_mutex_init(&mTimeLock, NULL);
+    memset(mSlots, 0, sizeof(mSlots));
+    memset(mPrefix, 0, sizeof(mPrefix));
+}
+
+/*===========================================================================
+ * FUNCTION   : ~QCameraDumpWriter
+ *
+ * DESCRIPTION: deconstructor of QCameraDumpWriter. The writer thread is
+ *              detached and only goes away with the process.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+QCameraDumpWriter::~QCameraDumpWriter()
+{
+}
+
+/*===========================================================================
+ * FUNCTION   : makePath
+ *
+ * DESCRIPTION: build a dump file path from the dump location, the current
+ *              local time and a file name
+ *
+ * PARAMETERS :
+ *   @path    : output buffer
+ *   @len     : size of the output buffer
+ *   @name    : file name appended to the time prefix
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraDumpWriter::makePath(char *path, size_t len, const char *name)
+{
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&mTimeLock);
+    if (now != mPrefixTime) {
+        struct tm timeinfo;
+
+        mPrefixTime = now;
+        if (localtime_r(&now, &timeinfo) == NULL ||
+                strftime(mPrefix, sizeof(mPrefix),
+                QCAMERA_DUMP_FRM_LOCATION "%Y%m%d%H%M%S", &timeinfo) == 0) {
+            strlcpy(mPrefix, QCAMERA_DUMP_FRM_LOCATION, sizeof(mPrefix));
+        }
+    }
+    snprintf(path, len, "%s%s", mPrefix, name);
+    pthread_mutex_unlock(&mTimeLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : reserve
+ *
+ * DESCRIPTION: take the next slot of the ring for filling
+ *
+ * PARAMETERS :
+ *   @size    : number of bytes that will be copied in
+ *
+ * RETURN     : slot to fill, NULL if the dump has to be skipped
+ *==========================================================================*/
+qcamera_dump_slot_t *QCameraDumpWriter::reserve(size_t size)
+{
+    qcamera_dump_slot_t *slot = NULL;
+    size_t capacity = DUMP_ALIGN_UP(size);
+
+    pthread_mutex_lock(&mLock);
+    if (!mThreadActive) {
+        if (pthread_create(&mThread, NULL, writerRoutine, this) == 0) {
+            pthread_detach(mThread);
+            mThreadActive = true;
+        } else {
+            LOGE("Failed to start dump writer");
+            mSkipped++;
+            pthread_mutex_unlock(&mLock);
+            return NULL;
+        }
+    }
+
+    slot = &mSlots[mHead];
+    if (slot->state != QCAMERA_DUMP_SLOT_FREE) {
+        // the writer is behind, drop this one rather than wait
+        mSkipped++;
+        pthread_mutex_unlock(&mLock);
+        return NULL;
+    }
+
+    if (slot->capacity < capacity) {
+        if (mAllocated - slot->capacity + capacity > QCAMERA_DUMP_MAX_BYTES) {
+            LOGW("Dump of %zu bytes exceeds the buffer budget", size);
+            mSkipped++;
+            pthread_mutex_unlock(&mLock);
+            return NULL;
+        }
+        free(slot->data);
+        mAllocated -= slot->capacity;
+        slot->data = NULL;
+        slot->capacity = 0;
+        if (posix_memalign((void **)&slot->data, QCAMERA_DUMP_ALIGN, capacity) != 0) {
+            LOGE("Failed to allocate %zu bytes for dump", capacity);
+            slot->data = NULL;
+            mSkipped++;
+            pthread_mutex_unlock(&mLock);
+            return NULL;
+        }
+        slot->capacity = capacity;
+        mAllocated += capacity;
+    }
+
+    slot->state = QCAMERA_DUMP_SLOT_FILLING;
+    slot->size = size;
+    mHead = (mHead + 1) % QCAMERA_DUMP_SLOTS;
+    pthread_mutex_unlock(&mLock);
+
+    return slot;
+}
+
+/*===========================================================================
+ * FUNCTION   : commit
+ *
+ * DESCRIPTION: hand a filled slot over to the writer thread
+ *
+ * PARAMETERS :
+ *   @slot    : slot returned by reserve()
+ *   @path    : file to write to
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraDumpWriter::commit(qcamera_dump_slot_t *slot, const char *path)
+{
+    // Zero the padding so O_DIRECT never writes stale data past the end.
+    memset(slot->data + slot->size, 0, slot->capacity - slot->size);
+    strlcpy(slot->path, path, sizeof(slot->path));
+
+    pthread_mutex_lock(&mLock);
+    slot->state = QCAMERA_DUMP_SLOT_PENDING;
+    pthread_cond_signal(&mCond);
+    pthread_mutex_unlock(&mLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : dumpFrame
+ *
+ * DESCRIPTION: queue the visible area of every plane of a frame for
+ *              dumping, dropping the stride padding
+ *
+ * PARAMETERS :
+ *   @path    : file to write to
+ *   @base    : start of the frame
+ *   @offset  : plane layout of the frame
+ *
+ * RETURN     : int32_t type of status
+ *              NO_ERROR  -- queued
+ *              -EBUSY    -- skipped, the ring is full
+ *==========================================================================*/
+int32_t QCameraDumpWriter::dumpFrame(const char *path, const uint8_t *base,
+        const cam_frame_len_offset_t &offset)
+{
+    size_t size = 0;
+
+    for (uint32_t i = 0; i < offset.num_planes; i++) {
+        size += (size_t)offset.mp[i].width * (size_t)offset.mp[i].height;
+    }
+
+    qcamera_dump_slot_t *slot = reserve(size);
+    if (slot == NULL) {
+        return -EBUSY;
+    }
+
+    uint8_t *dst = slot->data;
+    for (uint32_t i = 0; i < offset.num_planes; i++) {
+        uint32_t index = offset.mp[i].offset;
+        if (i > 0) {
+            index += offset.mp[i-1].len;
+        }
+        for (int j = 0; j < offset.mp[i].height; j++) {
+            memcpy(dst, base + index, (size_t)offset.mp[i].width);
+            dst += offset.mp[i].width;
+            index += (uint32_t)offset.mp[i].stride;
+        }
+    }
+
+    commit(slot, path);
+    return NO_ERROR;
+}
+
+/*===========================================================================
+ * FUNCTION   : dumpData
+ *
+ * DESCRIPTION: queue a list of memory blocks for dumping into one file
+ *
+ * PARAMETERS :
+ *   @path    : file to write to
+ *   @iov     : blocks to write, in order
+ *   @iovcnt  : number of blocks
+ *
+ * RETURN     : int32_t type of status
+ *              NO_ERROR  -- queued
+ *              -EBUSY    -- skipped, the ring is full
+ *==========================================================================*/
+int32_t QCameraDumpWriter::dumpData(const char *path, const struct iovec *iov,
+        int iovcnt)
+{
+    size_t size = 0;
+
+    for (int i = 0; i < iovcnt; i++) {
+        size += iov[i].iov_len;
+    }
+
+    qcamera_dump_slot_t *slot = reserve(size);
+    if (slot == NULL) {
+        return -EBUSY;
+    }
+
+    uint8_t *dst = slot->data;
+    for (int i = 0; i < iovcnt; i++) {
+        memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+        dst += iov[i].iov_len;
+    }
+
+    commit(slot, path);
+    return NO_ERROR;
+}
+
+/*===========================================================================
+ * FUNCTION   : writeSlot
+ *
+ * DESCRIPTION: write one slot to its file. O_DIRECT is tried first so the
+ *              dump doesn't evict the page cache; the padded tail is cut
+ *              off again with ftruncate. File systems without O_DIRECT
+ *              support get a regular write.
+ *
+ * PARAMETERS :
+ *   @slot    : slot to write
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraDumpWriter::writeSlot(qcamera_dump_slot_t *slot)
+{
+    bool direct = true;
+    ssize_t written_len = -1;
+    int file_fd = open(slot->path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+
+    if (file_fd < 0 && errno == EINVAL) {
+        direct = false;
+        file_fd = open(slot->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (file_fd < 0) {
+        LOGE("fail to open %s for dumping: %s", slot->path, strerror(errno));
+        pthread_mutex_lock(&mLock);
+        mFailed++;
+        pthread_mutex_unlock(&mLock);
+        return;
+    }
+
+    fchmod(file_fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (direct) {
+        written_len = write(file_fd, slot->data, DUMP_ALIGN_UP(slot->size));
+        if (written_len >= 0) {
+            if (ftruncate(file_fd, (off_t)slot->size) == 0) {
+                written_len = (ssize_t)slot->size;
+            } else {
+                written_len = -1;
+            }
+        } else if (errno == EINVAL) {
+            fcntl(file_fd, F_SETFL, fcntl(file_fd, F_GETFL) & ~O_DIRECT);
+            direct = false;
+        }
+    }
+    if (!direct) {
+        written_len = write(file_fd, slot->data, slot->size);
+    }
+    close(file_fd);
+
+    LOGD("written %zd bytes to %s", written_len, slot->path);
+
+    pthread_mutex_lock(&mLock);
+    if (written_len == (ssize_t)slot->size) {
+        mDumped++;
+        mBytes += slot->size;
+    } else {
+        mFailed++;
+    }
+    pthread_mutex_unlock(&mLock);
+}
+
+/*===========================================================================
+ * FUNCTION   : releaseIdleBuffers
+ *
+ * DESCRIPTION: free the buffers of all free slots. Called with mLock held.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraDumpWriter::releaseIdleBuffers()
+{
+    for (uint32_t i = 0; i < QCAMERA_DUMP_SLOTS; i++) {
+        qcamera_dump_slot_t *slot = &mSlots[i];
+        if (slot->state == QCAMERA_DUMP_SLOT_FREE && slot->data != NULL) {
+            free(slot->data);
+            mAllocated -= slot->capacity;
+            slot->data = NULL;
+            slot->capacity = 0;
+        }
+    }
+}
+
+/*===========================================================================
+ * FUNCTION   : writerRoutine
+ *
+ * DESCRIPTION: writer thread. Takes every slot pending at wake up as one
+ *              batch, so a burst costs a single wake up.
+ *
+ * PARAMETERS :
+ *   @data    : user data ptr (QCameraDumpWriter)
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void *QCameraDumpWriter::writerRoutine(void *data)
+{
+    QCameraDumpWriter *pme = (QCameraDumpWriter *)data;
+    qcamera_dump_slot_t *batch[QCAMERA_DUMP_SLOTS];
+
+    pthread_mutex_lock(&pme->mLock);
+    for (;;) {
+        while (pme->mSlots[pme->mTail].state != QCAMERA_DUMP_SLOT_PENDING) {
+            // Only wake up on the idle timeout while there are buffers to
+            // give back, then sleep until the next dump.
+            if (pme->mAllocated == 0) {
+                pthread_cond_wait(&pme->mCond, &pme->mLock);
+                continue;
+            }
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += QCAMERA_DUMP_IDLE_TIMEOUT_S;
+            if (pthread_cond_timedwait(&pme->mCond, &pme->mLock, &ts) == ETIMEDOUT) {
+                pme->releaseIdleBuffers();
+            }
+        }
+
+        // Slots are written in ring order; a slot still being filled
+        // ends the batch.
+        uint32_t count = 0;
+        while (count < QCAMERA_DUMP_SLOTS &&
+                pme->mSlots[pme->mTail].state == QCAMERA_DUMP_SLOT_PENDING) {
+            batch[count++] = &pme->mSlots[pme->mTail];
+            pme->mTail = (pme->mTail + 1) % QCAMERA_DUMP_SLOTS;
+        }
+        pthread_mutex_unlock(&pme->mLock);
+
+        for (uint32_t i = 0; i < count; i++) {
+            pme->writeSlot(batch[i]);
+            pthread_mutex_lock(&pme->mLock);
+            batch[i]->state = QCAMERA_DUMP_SLOT_FREE;
+            pthread_mutex_unlock(&pme->mLock);
+        }
+
+        pthread_mutex_lock(&pme->mLock);
+    }
+
+    return NULL;
+}
+
+/*===========================================================================
+ * FUNCTION   : dump
+ *
+ * DESCRIPTION: print the dump counters
+ *
+ * PARAMETERS :
+ *   @fd      : file descriptor to print to
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraDumpWriter::dump(int fd)
+{
+    uint32_t pending = 0;
+
+    pthread_mutex_lock(&mLock);
+    for (uint32_t i = 0; i < QCAMERA_DUMP_SLOTS; i++) {
+        if (mSlots[i].state != QCAMERA_DUMP_SLOT_FREE) {
+            pending++;
+        }
+    }
+    dprintf(fd, "\n Frame dumps: %u written (%llu bytes), %u skipped, "
+            "%u failed, %u pending, %zu bytes buffered\n",
+            mDumped, (unsigned long long)mBytes, mSkipped, mFailed,
+            pending, mAllocated);
+    pthread_mutex_unlock(&mLock);
+}
+
+}; // namespace qcamera
@@ -0,0 +1,115 @@
+/* Copyright (c) 2016, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __QCAMERA_DUMP_WRITER_H__
+#define __QCAMERA_DUMP_WRITER_H__
+
+// System dependencies
+#include <pthread.h>
+#include <sys/uio.h>
+#include <time.h>
+
+// Camera dependencies
+#include "cam_types.h"
+
+namespace qcamera {
+
+#define QCAMERA_DUMP_SLOTS          8
+#define QCAMERA_DUMP_PATH_MAX       192
+// O_DIRECT needs block aligned buffers and lengths
+#define QCAMERA_DUMP_ALIGN          4096
+// Upper bound for the memory held by all slots
+#define QCAMERA_DUMP_MAX_BYTES      (96 * 1024 * 1024)
+// Slot buffers are freed after the writer was idle this long
+#define QCAMERA_DUMP_IDLE_TIMEOUT_S 2
+
+typedef enum {
+    QCAMERA_DUMP_SLOT_FREE,
+    QCAMERA_DUMP_SLOT_FILLING,
+    QCAMERA_DUMP_SLOT_PENDING,
+} qcamera_dump_slot_state_t;
+
+typedef struct {
+    qcamera_dump_slot_state_t state;
+    char path[QCAMERA_DUMP_PATH_MAX];
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+} qcamera_dump_slot_t;
+
+/* Debug dumps of frames and metadata. The caller copies the data into a
+ * slot of a fixed ring and returns right away; a writer thread drains the
+ * ring in batches. When the ring is full the dump is skipped instead of
+ * stalling the stream callback. */
+class QCameraDumpWriter {
+public:
+    static QCameraDumpWriter& getInstance();
+
+    void makePath(char *path, size_t len, const char *name);
+    int32_t dumpFrame(const char *path, const uint8_t *base,
+            const cam_frame_len_offset_t &offset);
+    int32_t dumpData(const char *path, const struct iovec *iov, int iovcnt);
+    void dump(int fd);
+
+private:
+    QCameraDumpWriter();
+    ~QCameraDumpWriter();
+    QCameraDumpWriter(const QCameraDumpWriter&);
+    QCameraDumpWriter& operator=(const QCameraDumpWriter&);
+
+    qcamera_dump_slot_t *reserve(size_t size);
+    void commit(qcamera_dump_slot_t *slot, const char *path);
+    static void *writerRoutine(void *data);
+    void writeSlot(qcamera_dump_slot_t *slot);
+    void releaseIdleBuffers();
+
+    pthread_mutex_t mLock;
+    pthread_cond_t mCond;
+    pthread_t mThread;
+    bool mThreadActive;
+
+    qcamera_dump_slot_t mSlots[QCAMERA_DUMP_SLOTS];
+    uint32_t mHead;             // next slot to reserve
+    uint32_t mTail;             // next slot to write
+    size_t mAllocated;
+
+    // time prefix of the file names, refreshed once per second
+    pthread_mutex_t mTimeLock;
+    time_t mPrefixTime;
+    char mPrefix[QCAMERA_DUMP_PATH_MAX];
+
+    uint32_t mDumped;
+    uint32_t mSkipped;
+    uint32_t mFailed;
+    uint64_t mBytes;
+};
+
+}; // namespace qcamera
+
+#endif /* __QCAMERA_DUMP_WRITER_H__ */
@@ -0,0 +1,292 @@
+/* Copyright (c) 2016, The Linux Foundation. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met:
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above
+*       copyright notice, this list of conditions and the following
+*       disclaimer in the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of The Linux Foundation nor the names of its
+*       contributors may be used to endorse or promote products derived
+*       from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+* ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+* WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+* OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+* IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#define LOG_TAG "QCameraKpiRing"
+
+// System dependencies
+#include <algorithm>
+#include <inttypes.h>
+#include <stdio.h>
+#include <vector>
+
+// Camera dependencies
+#include "QCameraKpiRing.h"
+
+extern "C" {
+#include "mm_camera_dbg.h"
+}
+
+namespace qcamera {
+
+#define KPI_RING_MASK (QCAMERA_KPI_RING_SIZE - 1)
+#define KPI_BUF_MASK  (QCAMERA_KPI_MAX_BUFS - 1)
+
+typedef struct {
+    qcamera_kpi_event_t from;
+    qcamera_kpi_event_t to;
+    const char *name;
+} qcamera_kpi_stage_t;
+
+static const qcamera_kpi_stage_t gKpiStages[] = {
+    {QCAMERA_KPI_SOF,        QCAMERA_KPI_BUF_DONE,  "sof -> buf done"},
+    {QCAMERA_KPI_BUF_DONE,   QCAMERA_KPI_HAL_CB,    "buf done -> hal cb"},
+    {QCAMERA_KPI_HAL_CB,     QCAMERA_KPI_FW_RETURN, "hal cb -> fw return"},
+    {QCAMERA_KPI_SOF,        QCAMERA_KPI_JPEG_START, "sof -> jpeg start"},
+    {QCAMERA_KPI_JPEG_START, QCAMERA_KPI_JPEG_END,  "jpeg start -> jpeg end"},
+};
+
+/*===========================================================================
+ * FUNCTION   : QCameraKpiRing
+ *
+ * DESCRIPTION: constructor of QCameraKpiRing
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+QCameraKpiRing::QCameraKpiRing()
+{
+    reset();
+}
+
+/*===========================================================================
+ * FUNCTION   : now
+ *
+ * DESCRIPTION: Current time on the clock of the frame time stamps
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : time in ns
+ *==========================================================================*/
+int64_t QCameraKpiRing::now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/*===========================================================================
+ * FUNCTION   : reset
+ *
+ * DESCRIPTION: Drops all recorded events. Not safe against concurrent
+ *              recording, call it when the session starts.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraKpiRing::reset()
+{
+    mHead.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < QCAMERA_KPI_RING_SIZE; i++) {
+        mEntries[i].seq.store(0, std::memory_order_relaxed);
+    }
+    for (uint32_t i = 0; i < QCAMERA_KPI_MAX_BUFS; i++) {
+        mBufFrameId[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/*===========================================================================
+ * FUNCTION   : record
+ *
+ * DESCRIPTION: Records an event of a frame.
+ *
+ * PARAMETERS :
+ *   @event   : event type
+ *   @frameId : frame id the event belongs to
+ *   @aux     : event specific value, job id for jpeg events
+ *   @ts      : event time, 0 to use the current time
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraKpiRing::record(qcamera_kpi_event_t event, uint32_t frameId,
+        uint32_t aux, int64_t ts)
+{
+    uint32_t pos = mHead.fetch_add(1, std::memory_order_relaxed);
+    qcamera_kpi_entry_t &entry = mEntries[pos & KPI_RING_MASK];
+
+    entry.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.frame_id = frameId;
+    entry.aux = aux;
+    entry.event = (uint16_t)event;
+    entry.ts = ts ? ts : now();
+    entry.seq.store(pos + 1, std::memory_order_release);
+}
+
+/*===========================================================================
+ * FUNCTION   : mapBuffer
+ *
+ * DESCRIPTION: Remembers the frame handed out in a stream buffer, so that
+ *              recordBuffer() can attribute the return of the buffer.
+ *
+ * PARAMETERS :
+ *   @bufIdx  : stream buffer index
+ *   @frameId : frame id held by the buffer
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraKpiRing::mapBuffer(uint32_t bufIdx, uint32_t frameId)
+{
+    mBufFrameId[bufIdx & KPI_BUF_MASK].store(frameId, std::memory_order_relaxed);
+}
+
+/*===========================================================================
+ * FUNCTION   : recordBuffer
+ *
+ * DESCRIPTION: Records an event for the frame last handed out in a stream
+ *              buffer.
+ *
+ * PARAMETERS :
+ *   @event   : event type
+ *   @bufIdx  : stream buffer index
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraKpiRing::recordBuffer(qcamera_kpi_event_t event, uint32_t bufIdx)
+{
+    record(event, mBufFrameId[bufIdx & KPI_BUF_MASK].load(std::memory_order_relaxed),
+            bufIdx);
+}
+
+/*===========================================================================
+ * FUNCTION   : recordJob
+ *
+ * DESCRIPTION: Records an event for the frame of a jpeg job. The frame id
+ *              is taken from the QCAMERA_KPI_JPEG_START event of the job.
+ *
+ * PARAMETERS :
+ *   @event   : event type
+ *   @jobId   : jpeg job id
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraKpiRing::recordJob(qcamera_kpi_event_t event, uint32_t jobId)
+{
+    uint32_t head = mHead.load(std::memory_order_acquire);
+    uint32_t frameId = 0;
+
+    for (uint32_t i = 1; i <= QCAMERA_KPI_RING_SIZE && i <= head; i++) {
+        const qcamera_kpi_entry_t &entry = mEntries[(head - i) & KPI_RING_MASK];
+        if (entry.seq.load(std::memory_order_acquire) == head - i + 1 &&
+                entry.event == QCAMERA_KPI_JPEG_START && entry.aux == jobId) {
+            frameId = entry.frame_id;
+            break;
+        }
+    }
+    record(event, frameId, jobId);
+}
+
+/*===========================================================================
+ * FUNCTION   : dump
+ *
+ * DESCRIPTION: Prints latency percentiles of each stage over the events
+ *              currently in the ring.
+ *
+ * PARAMETERS :
+ *   @fd      : file descriptor to print to
+ *
+ * RETURN     : None
+ *==========================================================================*/
+void QCameraKpiRing::dump(int fd)
+{
+    typedef struct {
+        uint32_t frame_id;
+        uint16_t event;
+        int64_t ts;
+    } kpi_sample_t;
+    std::vector<kpi_sample_t> samples;
+    uint32_t head = mHead.load(std::memory_order_acquire);
+    uint32_t count = std::min(head, (uint32_t)QCAMERA_KPI_RING_SIZE);
+
+    samples.reserve(count);
+    for (uint32_t pos = head - count; pos != head; pos++) {
+        const qcamera_kpi_entry_t &entry = mEntries[pos & KPI_RING_MASK];
+        kpi_sample_t sample;
+
+        if (entry.seq.load(std::memory_order_acquire) != pos + 1) {
+            continue;
+        }
+        sample.frame_id = entry.frame_id;
+        sample.event = entry.event;
+        sample.ts = entry.ts;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Skip entries overwritten while they were copied
+        if (entry.seq.load(std::memory_order_relaxed) == pos + 1 &&
+                sample.event < QCAMERA_KPI_EVENT_MAX) {
+            samples.push_back(sample);
+        }
+    }
+
+    // Group the events of each frame, keeping the record order within it
+    std::stable_sort(samples.begin(), samples.end(),
+            [](const kpi_sample_t &a, const kpi_sample_t &b) {
+                return a.frame_id < b.frame_id;
+            });
+
+    const size_t numStages = sizeof(gKpiStages) / sizeof(gKpiStages[0]);
+    std::vector<int64_t> latency[numStages];
+    for (size_t i = 0; i < samples.size();) {
+        int64_t ts[QCAMERA_KPI_EVENT_MAX] = {0};
+        size_t j = i;
+
+        // First occurrence of each event of the frame
+        for (; j < samples.size() && samples[j].frame_id == samples[i].frame_id; j++) {
+            if (ts[samples[j].event] == 0) {
+                ts[samples[j].event] = samples[j].ts;
+            }
+        }
+        for (size_t s = 0; s < numStages; s++) {
+            if (ts[gKpiStages[s].from] && ts[gKpiStages[s].to] >= ts[gKpiStages[s].from]) {
+                latency[s].push_back(ts[gKpiStages[s].to] - ts[gKpiStages[s].from]);
+            }
+        }
+        i = j;
+    }
+
+    dprintf(fd, "\n KPI events: %u recorded, %zu in ring\n", head, samples.size());
+    dprintf(fd, " %-24s %8s %10s %10s %10s %10s\n", "stage (us)", "count",
+            "p50", "p90", "p99", "max");
+    for (size_t s = 0; s < numStages; s++) {
+        std::vector<int64_t> &l = latency[s];
+        if (l.empty()) {
+            continue;
+        }
+        std::sort(l.begin(), l.end());
+        dprintf(fd, " %-24s %8zu %10" PRId64 " %10" PRId64 " %10" PRId64 " %10" PRId64 "\n",
+                gKpiStages[s].name, l.size(),
+                l[(l.size() - 1) * 50 / 100] / 1000,
+                l[(l.size() - 1) * 90 / 100] / 1000,
+                l[(l.size() - 1) * 99 / 100] / 1000,
+                l.back() / 1000);
+    }
+}
+
+}; // namespace qcamera
@@ -0,0 +1,92 @@
+/* Copyright (c) 2016, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __QCAMERA_KPI_RING_H__
+#define __QCAMERA_KPI_RING_H__
+
+// System dependencies
+#include <atomic>
+#include <stdint.h>
+#include <time.h>
+
+namespace qcamera {
+
+// Number of events kept per session, must be a power of 2
+#define QCAMERA_KPI_RING_SIZE       2048
+// Number of stream buffers whose frame id is tracked, must be a power of 2
+#define QCAMERA_KPI_MAX_BUFS        64
+
+typedef enum {
+    QCAMERA_KPI_SOF,          // sensor start of frame (frame time stamp)
+    QCAMERA_KPI_BUF_DONE,     // frame received by the HAL stream callback
+    QCAMERA_KPI_HAL_CB,       // frame picked up by the HAL callback thread
+    QCAMERA_KPI_FW_RETURN,    // buffer returned by the framework / display
+    QCAMERA_KPI_JPEG_START,   // jpeg job started
+    QCAMERA_KPI_JPEG_END,     // jpeg job done
+    QCAMERA_KPI_EVENT_MAX
+} qcamera_kpi_event_t;
+
+typedef struct {
+    // Ring position + 1 once the entry is complete, 0 while it is written
+    std::atomic<uint32_t> seq;
+    uint32_t frame_id;
+    uint32_t aux;
+    uint16_t event;
+    int64_t ts;
+} qcamera_kpi_entry_t;
+
+/* Always-on per session ring of frame events, keyed by frame id. Recording
+ * is lock free and costs a clock read and an atomic increment, so it is
+ * safe from any stream callback. dump() turns the events currently in the
+ * ring into per-stage latency percentiles. */
+class QCameraKpiRing {
+public:
+    QCameraKpiRing();
+
+    static int64_t now();
+    void record(qcamera_kpi_event_t event, uint32_t frameId,
+            uint32_t aux = 0, int64_t ts = 0);
+    void mapBuffer(uint32_t bufIdx, uint32_t frameId);
+    void recordBuffer(qcamera_kpi_event_t event, uint32_t bufIdx);
+    void recordJob(qcamera_kpi_event_t event, uint32_t jobId);
+    void reset();
+    void dump(int fd);
+
+private:
+    QCameraKpiRing(const QCameraKpiRing&);
+    QCameraKpiRing& operator=(const QCameraKpiRing&);
+
+    std::atomic<uint32_t> mHead;
+    qcamera_kpi_entry_t mEntries[QCAMERA_KPI_RING_SIZE];
+    std::atomic<uint32_t> mBufFrameId[QCAMERA_KPI_MAX_BUFS];
+};
+
+}; // namespace qcamera
+
+#endif /* __QCAMERA_KPI_RING_H__ */
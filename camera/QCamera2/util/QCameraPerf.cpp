@@ -66,7 +66,20 @@ QCameraPerfLock::QCameraPerfLock() :
         mPerfLockHandleTimed(-1),
         mTimerSet(0),
         mPerfLockTimeout(0),
-        mStartTimeofLock(0)
+        mStartTimeofLock(0),
+        mGovEnable(false),
+        mGovRunning(false),
+        mGovLevel(0),
+        mGovHandle(-1),
+        mGovInterval(0),
+        mGovLastFrameTime(0),
+        mGovWindowStart(0),
+        mGovFrames(0),
+        mGovDrops(0),
+        mGovLongGaps(0),
+        mGovGapDrops(0),
+        mGovMaxDuration(0),
+        mGovSumDuration(0)
 {
 }
 
@@ -113,6 +126,8 @@ void QCameraPerfLock::lock_init()
 
     property_get("persist.camera.perflock.enable", value, "1");
     mPerfLockEnable = atoi(value);
+    property_get("persist.camera.perflock.governor", value, "1");
+    mGovEnable = (atoi(value) > 0);
 #ifdef HAS_MULTIMEDIA_HINTS
     if (hw_get_module(POWER_HARDWARE_MODULE_ID, (const hw_module_t **)&m_pPowerModule)) {
         LOGE("%s module not found", POWER_HARDWARE_MODULE_ID);
@@ -193,6 +208,12 @@ void QCameraPerfLock::lock_deinit()
             (*perf_lock_rel)(mPerfLockHandle);
         }
 
+        if ((NULL != perf_lock_rel) && (mGovHandle >= 0)) {
+            (*perf_lock_rel)(mGovHandle);
+        }
+        mGovHandle = -1;
+        mGovLevel = 0;
+
         if (mDlHandle) {
             perf_lock_acq  = NULL;
             perf_lock_rel  = NULL;
@@ -455,6 +476,203 @@ int32_t QCameraPerfLock::lock_rel()
     return ret;
 }
 
+/*===========================================================================
+ * FUNCTION   : governorStart
+ *
+ * DESCRIPTION: Starts the closed loop perf lock for a streaming use case.
+ *              No resources are held until the reported frames ask for it.
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : void
+ *
+ *==========================================================================*/
+void QCameraPerfLock::governorStart()
+{
+    Mutex::Autolock lock(mGovLock);
+
+    if (!mGovEnable || mGovRunning) {
+        return;
+    }
+    mGovRunning       = true;
+    mGovInterval      = 0;
+    mGovLastFrameTime = 0;
+    mGovWindowStart   = 0;
+    mGovFrames        = 0;
+    mGovDrops         = 0;
+    mGovLongGaps      = 0;
+    mGovGapDrops      = 0;
+    mGovMaxDuration   = 0;
+    mGovSumDuration   = 0;
+    LOGH("perf governor started");
+}
+
+/*===========================================================================
+ * FUNCTION   : governorStop
+ *
+ * DESCRIPTION: Stops the closed loop perf lock and releases its resources
+ *
+ * PARAMETERS : None
+ *
+ * RETURN     : void
+ *
+ *==========================================================================*/
+void QCameraPerfLock::governorStop()
+{
+    Mutex::Autolock lock(mGovLock);
+
+    if (!mGovRunning) {
+        return;
+    }
+    mGovRunning = false;
+    governorApply(0, 0);
+    LOGH("perf governor stopped");
+}
+
+/*===========================================================================
+ * FUNCTION   : governorReport
+ *
+ * DESCRIPTION: Accounts a frame delivered by a stream thread. Frame drops
+ *              are detected from gaps in the frame time stamps, the
+ *              deadline slack is the frame interval minus the time the
+ *              callback took. Once per window the resource level moves one
+ *              step: up when frames were dropped or the slack fell below a
+ *              quarter of the interval, down as soon as it is back above
+ *              half of it. A run of long gaps is a lower frame rate, not
+ *              drops, so the interval is learnt again from it.
+ *
+ * PARAMETERS :
+ *  @frameTime : sensor time stamp of the frame
+ *  @cbDuration: time spent in the stream callback
+ *
+ * RETURN     : void
+ *
+ *==========================================================================*/
+void QCameraPerfLock::governorReport(nsecs_t frameTime, nsecs_t cbDuration)
+{
+    Mutex::Autolock lock(mGovLock);
+
+    if (!mGovRunning) {
+        return;
+    }
+
+    if (mGovLastFrameTime != 0 && frameTime > mGovLastFrameTime) {
+        nsecs_t delta = frameTime - mGovLastFrameTime;
+        if (mGovInterval == 0) {
+            mGovInterval = delta;
+        } else if (delta > mGovInterval + (mGovInterval >> 1)) {
+            uint32_t drops =
+                    (uint32_t)((delta + (mGovInterval >> 1)) / mGovInterval) - 1;
+            mGovDrops += drops;
+            mGovGapDrops += drops;
+            if (++mGovLongGaps >= PERF_GOV_RELEARN_GAPS) {
+                LOGH("perf governor: frame interval %lldus -> %lldus",
+                        (long long)ns2us(mGovInterval), (long long)ns2us(delta));
+                mGovInterval = delta;
+                mGovDrops -= (mGovGapDrops < mGovDrops) ? mGovGapDrops : mGovDrops;
+                mGovLongGaps = 0;
+                mGovGapDrops = 0;
+            }
+        } else {
+            mGovInterval += (delta - mGovInterval) >> 3;
+            mGovLongGaps = 0;
+            mGovGapDrops = 0;
+        }
+    }
+    mGovLastFrameTime = frameTime;
+
+    if (mGovFrames == 0) {
+        mGovWindowStart = systemTime();
+    }
+    mGovFrames++;
+    mGovSumDuration += cbDuration;
+    if (cbDuration > mGovMaxDuration) {
+        mGovMaxDuration = cbDuration;
+    }
+
+    if (mGovFrames < PERF_GOV_WINDOW_FRAMES || mGovInterval == 0) {
+        return;
+    }
+
+    nsecs_t window = systemTime() - mGovWindowStart;
+    nsecs_t slack = mGovInterval - mGovMaxDuration;
+    uint32_t level = mGovLevel;
+
+    if (mGovDrops > 0 || slack < (mGovInterval >> 2)) {
+        if (level < PERF_GOV_LEVEL_MAX) {
+            level++;
+        }
+    } else if (slack > (mGovInterval >> 1)) {
+        if (level > 0) {
+            level--;
+        }
+    }
+
+    LOGH("perf governor: frames %u drops %u interval %lldus cb avg %lldus "
+            "max %lldus level %u -> %u", mGovFrames, mGovDrops,
+            (long long)ns2us(mGovInterval),
+            (long long)ns2us(mGovSumDuration / mGovFrames),
+            (long long)ns2us(mGovMaxDuration), mGovLevel, level);
+
+    governorApply(level, window);
+
+    mGovFrames      = 0;
+    mGovDrops       = 0;
+    mGovMaxDuration = 0;
+    mGovSumDuration = 0;
+}
+
+/*===========================================================================
+ * FUNCTION   : governorApply
+ *
+ * DESCRIPTION: Acquires the resources of a governor level. Levels are held
+ *              for two windows only, so they lapse on their own if the
+ *              stream stops reporting. Caller holds mGovLock.
+ *
+ * PARAMETERS :
+ *  @level    : resource level, 0 releases everything
+ *  @window   : duration of the last window
+ *
+ * RETURN     : void
+ *
+ *==========================================================================*/
+void QCameraPerfLock::governorApply(uint32_t level, nsecs_t window)
+{
+    // Each level adds one resource on top of the previous one
+    static int32_t perf_lock_params[PERF_GOV_LEVEL_MAX] = {
+            ALL_CPUS_PWR_CLPS_DIS,
+            CPU0_MIN_FREQ_TURBO_MAX,
+            CPU4_MIN_FREQ_TURBO_MAX
+    };
+    Mutex::Autolock lock(mLock);
+
+    if (!mPerfLockEnable || (NULL == perf_lock_acq) || (NULL == perf_lock_rel)) {
+        mGovLevel = level;
+        return;
+    }
+
+    if (mGovHandle >= 0) {
+        (*perf_lock_rel)(mGovHandle);
+        mGovHandle = -1;
+    }
+
+    if (level > 0) {
+        int32_t duration = (int32_t)ns2ms(2 * window);
+        if (duration < ONE_SEC / 2) {
+            duration = ONE_SEC / 2;
+        }
+        int32_t ret = (*perf_lock_acq)(mGovHandle, duration, perf_lock_params,
+                (int)level);
+        if (ret < 0) {
+            LOGE("failed to acquire governor level %u", level);
+            level = 0;
+        } else {
+            mGovHandle = ret;
+        }
+    }
+    mGovLevel = level;
+}
+
 /*===========================================================================
  * FUNCTION   : powerHintInternal
  *
@@ -46,6 +46,11 @@ typedef enum {
 
 /* Time related macros */
 #define ONE_SEC 1000
+
+/* Perf lock governor */
+#define PERF_GOV_LEVEL_MAX      3  // number of resource steps
+#define PERF_GOV_WINDOW_FRAMES  30 // frames per decision
+#define PERF_GOV_RELEARN_GAPS   4  // long gaps in a row taken as a new frame rate
 typedef int64_t nsecs_t;
 #define NSEC_PER_SEC 1000000000LLU
 
@@ -68,12 +73,16 @@ public:
     void    powerHintInternal(power_hint_t hint, bool enable);
     void    powerHint(power_hint_t hint, bool enable);
     bool    isPerfLockTimedAcquired() { return (0 <= mPerfLockHandleTimed); }
+    void    governorStart();
+    void    governorStop();
+    void    governorReport(nsecs_t frameTime, nsecs_t cbDuration);
 
 private:
     int32_t        (*perf_lock_acq)(int, int, int[], int);
     int32_t        (*perf_lock_rel)(int);
     void            startTimer(uint32_t timer_val);
     void            resetTimer();
+    void            governorApply(uint32_t level, nsecs_t window);
     void           *mDlHandle;
     uint32_t        mPerfLockEnable;
     Mutex           mLock;
@@ -86,6 +95,24 @@ private:
     uint32_t        mPerfLockTimeout;
     nsecs_t         mStartTimeofLock;
     List<power_hint_t> mActivePowerHints;   // Active/enabled power hints list
+
+    // Closed loop perf lock. Stream threads report frame time stamps and
+    // callback durations; once per window the resource level is stepped
+    // up on frame drops or low deadline slack and down when slack recovers.
+    Mutex           mGovLock;
+    bool            mGovEnable;
+    bool            mGovRunning;
+    uint32_t        mGovLevel;
+    int32_t         mGovHandle;
+    nsecs_t         mGovInterval;           // estimated frame interval
+    nsecs_t         mGovLastFrameTime;
+    nsecs_t         mGovWindowStart;
+    uint32_t        mGovFrames;
+    uint32_t        mGovDrops;
+    uint32_t        mGovLongGaps;           // consecutive long frame gaps
+    uint32_t        mGovGapDrops;           // drops counted for those gaps
+    nsecs_t         mGovMaxDuration;
+    nsecs_t         mGovSumDuration;
 };
 
 }; // namespace qcamera
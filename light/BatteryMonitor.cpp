@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2018 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "LightService"
+
+#include <log/log.h>
+
+#include <android-base/file.h>
+#include <android-base/strings.h>
+#include <cutils/uevent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "BatteryMonitor.h"
+#include "Light.h"
+
+#define UEVENT_MSG_LEN 2048
+#define UEVENT_SOCKET_BUF_SIZE (64 * 1024)
+
+#define UEVENT_SUBSYSTEM    "SUBSYSTEM=power_supply"
+#define UEVENT_NAME         "POWER_SUPPLY_NAME=battery"
+#define UEVENT_STATUS       "POWER_SUPPLY_STATUS="
+
+using ::android::base::ReadFileToString;
+using ::android::base::StartsWith;
+using ::android::base::Trim;
+
+BatteryMonitor::BatteryMonitor() : mCharging(false) {}
+
+void BatteryMonitor::start(ChangeHandler onChange) {
+    mOnChange = onChange;
+    readInitialStatus();
+    mThread = std::thread(&BatteryMonitor::run, this);
+    mThread.detach();
+}
+
+void BatteryMonitor::readInitialStatus() {
+    std::string status;
+
+    if (!ReadFileToString(BATTERY_STATUS_FILE, &status)) {
+        ALOGW("failed to read %s", BATTERY_STATUS_FILE);
+        return;
+    }
+
+    mCharging = Trim(status) == BATTERY_STATUS_CHARGING;
+}
+
+void BatteryMonitor::handleUevent(const char* msg, ssize_t len) {
+    const char* end = msg + len;
+    const char* status = nullptr;
+    bool powerSupply = false, battery = false;
+
+    /* The message is a sequence of NUL terminated KEY=value strings. */
+    while (msg < end && *msg) {
+        if (!strcmp(msg, UEVENT_SUBSYSTEM)) {
+            powerSupply = true;
+        } else if (!strcmp(msg, UEVENT_NAME)) {
+            battery = true;
+        } else if (StartsWith(msg, UEVENT_STATUS)) {
+            status = msg + strlen(UEVENT_STATUS);
+        }
+        msg += strlen(msg) + 1;
+    }
+
+    if (powerSupply && battery && status) {
+        bool charging = !strcmp(status, BATTERY_STATUS_CHARGING);
+
+        if (mCharging.exchange(charging) != charging) {
+            ALOGV("battery %s", charging ? "charging" : "not charging");
+            if (mOnChange) {
+                mOnChange();
+            }
+        }
+    }
+}
+
+void BatteryMonitor::run() {
+    char msg[UEVENT_MSG_LEN + 2];
+    struct epoll_event ev = {};
+    int sock, epfd;
+
+    sock = uevent_open_socket(UEVENT_SOCKET_BUF_SIZE, true);
+    if (sock < 0) {
+        ALOGE("failed to open uevent socket, battery status won't update");
+        return;
+    }
+
+    fcntl(sock, F_SETFL, O_NONBLOCK);
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        ALOGE("epoll_create1 failed: %s", strerror(errno));
+        close(sock);
+        return;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.fd = sock;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, sock, &ev) < 0) {
+        ALOGE("epoll_ctl failed: %s", strerror(errno));
+        close(epfd);
+        close(sock);
+        return;
+    }
+
+    for (;;) {
+        struct epoll_event event;
+        int n = TEMP_FAILURE_RETRY(epoll_wait(epfd, &event, 1, -1));
+
+        if (n < 0) {
+            ALOGE("epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        ssize_t len;
+        while ((len = uevent_kernel_multicast_recv(sock, msg, UEVENT_MSG_LEN)) > 0) {
+            msg[len] = '\0';
+            msg[len + 1] = '\0';
+            handleUevent(msg, len);
+        }
+    }
+
+    close(epfd);
+    close(sock);
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2018 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HARDWARE_LIGHT_V2_0_BATTERYMONITOR_H
+#define ANDROID_HARDWARE_LIGHT_V2_0_BATTERYMONITOR_H
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+/*
+ * Tracks whether the battery is charging from power_supply uevents, so
+ * battery light updates don't have to read sysfs. The framework may set
+ * the battery light before the uevent arrives, so changes are reported
+ * back to let the light be applied again.
+ */
+class BatteryMonitor {
+  public:
+    using ChangeHandler = std::function<void()>;
+
+    BatteryMonitor();
+
+    void start(ChangeHandler onChange);
+    bool isCharging() const { return mCharging.load(std::memory_order_relaxed); }
+
+  private:
+    void readInitialStatus();
+    void run();
+    void handleUevent(const char* msg, ssize_t len);
+
+    std::atomic<bool> mCharging;
+    ChangeHandler mOnChange;
+    std::thread mThread;
+};
+
+#endif  // ANDROID_HARDWARE_LIGHT_V2_0_BATTERYMONITOR_H
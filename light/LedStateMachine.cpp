@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2018 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "LightService"
+
+#include <log/log.h>
+
+#include <android-base/stringprintf.h>
+#include <unistd.h>
+
+#include "Light.h"
+#include "LedStateMachine.h"
+
+using ::android::base::StringPrintf;
+
+LedStateMachine::LedStateMachine(Sink sink)
+    : mSink(sink), mOngoing(ONGOING_NONE), mSelectedChannel(-1), mSequence(0) {}
+
+void LedStateMachine::update(const LedEvent& event) {
+    LedChannelState side, middle;
+    int buttons;
+
+    if (event.brightness > 0) {
+        mOngoing |= event.source;
+    } else {
+        mOngoing &= ~event.source;
+    }
+    ALOGV("led %d: brightness %u, ongoing %d", event.source, event.brightness, mOngoing);
+
+    buttons = event.brightness / 20;
+
+    /* side buttons */
+
+    if (mOngoing & ONGOING_BUTTONS) {
+        side.mode = RGB_LED_MODE_CONSTANT_ON;
+        side.grade = std::to_string(buttons);
+    } else {
+        side.mode = RGB_LED_MODE_OFF;
+    }
+
+    /* middle ring */
+
+    if (mOngoing & (ONGOING_NOTIFICATION | ONGOING_ATTENTION)) {
+        middle.mode = RGB_LED_MODE_AUTO_BLINK;
+        middle.grade = StringPrintf("%d %d\n", buttons, buttons + event.brightness / 20);
+    } else if (event.battery == BATTERY_CHARGING) {
+        middle.mode = RGB_LED_MODE_AUTO_BLINK;
+        middle.grade = StringPrintf("%d %d\n",
+            buttons + BRIGHTNESS_BATTERY_FULL / 20,
+            buttons + BRIGHTNESS_BATTERY_CHARGING / 20);
+    } else if (event.battery == BATTERY_FULL) {
+        middle.mode = RGB_LED_MODE_CONSTANT_ON;
+        middle.grade = StringPrintf("%d\n", buttons + BRIGHTNESS_BATTERY_FULL / 20);
+    } else if (event.battery == BATTERY_LOW) {
+        middle.mode = RGB_LED_MODE_AUTO_BLINK;
+        middle.grade = StringPrintf("%d %d\n", buttons, buttons + BRIGHTNESS_BATTERY_LOW / 20);
+    } else if (mOngoing & ONGOING_BUTTONS) {
+        middle.mode = RGB_LED_MODE_CONSTANT_ON;
+        middle.grade = StringPrintf("%d\n", buttons);
+    } else {
+        middle.mode = RGB_LED_MODE_OFF;
+    }
+
+    /* The driver blinks in steps of 400ms. */
+    if (event.timed) {
+        middle.fade = StringPrintf("%d %d %d\n", 1, event.flashOnMs / 400, event.flashOffMs / 400);
+    }
+
+    apply(SILDE_CHANNEL, mSide, side);
+    apply(MIDDLE_CHANNEL, mMiddle, middle);
+}
+
+void LedStateMachine::apply(int channel, LedChannelState& current, const LedChannelState& next) {
+    bool gradeChanged = !next.grade.empty() && next.grade != current.grade;
+    bool fadeChanged = !next.fade.empty() && next.fade != current.fade;
+
+    if (!gradeChanged && !fadeChanged && next.mode == current.mode) {
+        return;
+    }
+
+    if (!next.grade.empty()) {
+        current.grade = next.grade;
+    }
+
+    if (!next.fade.empty()) {
+        current.fade = next.fade;
+    }
+
+    /*
+     * There is a single grade and fade node; outn only picks the channel
+     * they apply to. After switching channels they still hold the other
+     * channel's values, so reprogram both.
+     */
+    if (mSelectedChannel != channel) {
+        mSink(NUBIA_CHANNEL_FILE, std::to_string(channel));
+        mSelectedChannel = channel;
+        gradeChanged = fadeChanged = true;
+    }
+
+    if (gradeChanged && !current.grade.empty()) {
+        mSink(NUBIA_GRADE_FILE, current.grade);
+    }
+
+    if (fadeChanged && !current.fade.empty()) {
+        mSink(NUBIA_FADE_FILE, current.fade);
+    }
+
+    /* The mode write is what makes the driver pick up grade and fade. */
+    mSink(NUBIA_MODE_FILE, std::to_string(next.mode));
+    current.mode = next.mode;
+
+    record(channel, current);
+}
+
+void LedStateMachine::record(int channel, const LedChannelState& state) {
+    auto trim = [](const std::string& s) {
+        return s.empty() || s.back() != '\n' ? s : s.substr(0, s.size() - 1);
+    };
+
+    mTrace.push_back(StringPrintf("#%llu ch=0x%02x mode=%d grade=\"%s\" fade=\"%s\"",
+        static_cast<unsigned long long>(mSequence++), channel, state.mode,
+        trim(state.grade).c_str(), trim(state.fade).c_str()));
+
+    if (mTrace.size() > LED_TRACE_SIZE) {
+        mTrace.pop_front();
+    }
+}
+
+void LedStateMachine::dumpTrace(int fd) const {
+    dprintf(fd, "nubia_led transitions (last %zu):\n", mTrace.size());
+    for (const std::string& entry : mTrace) {
+        dprintf(fd, "  %s\n", entry.c_str());
+    }
+}
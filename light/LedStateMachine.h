@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2018 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HARDWARE_LIGHT_V2_0_LEDSTATEMACHINE_H
+#define ANDROID_HARDWARE_LIGHT_V2_0_LEDSTATEMACHINE_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+
+#define LED_TRACE_SIZE 64
+
+/*
+ * What the nubia_led driver is programmed with for one channel. Empty
+ * grade/fade strings mean "leave whatever the driver holds".
+ */
+struct LedChannelState {
+    int mode = -1;
+    std::string grade;
+    std::string fade;
+};
+
+/*
+ * Input to the state machine for one light update: the brightness and
+ * flash timing of the light that changed, the ongoing bit it owns and the
+ * current battery state.
+ */
+struct LedEvent {
+    uint32_t brightness;
+    bool timed;
+    int flashOnMs;
+    int flashOffMs;
+    int source;
+    int battery;
+};
+
+/*
+ * Drives the side buttons and middle ring of the nubia_led device. The last
+ * state programmed into each channel is cached and only the fields that
+ * differ are written, except that grade and fade are rewritten whenever
+ * the selected channel changes since the driver shares them. All writes go
+ * through the sink and every applied transition is appended to a bounded
+ * trace, so the machine runs the same against sysfs or a recording sink on
+ * the host.
+ */
+class LedStateMachine {
+  public:
+    using Sink = std::function<void(const char* path, const std::string& value)>;
+
+    explicit LedStateMachine(Sink sink);
+
+    void update(const LedEvent& event);
+    void dumpTrace(int fd) const;
+
+  private:
+    void apply(int channel, LedChannelState& current, const LedChannelState& next);
+    void record(int channel, const LedChannelState& state);
+
+    Sink mSink;
+    int mOngoing;
+    int mSelectedChannel;
+    LedChannelState mSide;
+    LedChannelState mMiddle;
+
+    uint64_t mSequence;
+    std::deque<std::string> mTrace;
+};
+
+#endif  // ANDROID_HARDWARE_LIGHT_V2_0_LEDSTATEMACHINE_H
@@ -19,6 +19,8 @@
 #include <log/log.h>
 
 #include "Light.h"
+#include "BatteryMonitor.h"
+#include "LedStateMachine.h"
 
 #include <fstream>
 
@@ -56,36 +58,6 @@ static void set(std::string path, std::string value) {
     file << value;
 }
 
-static int readStr(std::string path, char *buffer, size_t size)
-{
-
-    std::ifstream file(path);
-
-    if (!file.is_open()) {
-        ALOGW("failed to read %s", path.c_str());
-        return -1;
-    }
-
-    file.read(buffer, size);
-    file.close();
-    return 1;
-}
-
-static int set(std::string path, char *buffer, size_t size)
-{
-
-    std::ofstream file(path);
-
-    if (!file.is_open()) {
-        ALOGW("failed to write %s", path.c_str());
-        return -1;
-    }
-
-    file.write(buffer, size);
-    file.close();
-    return 1;
-}
-
 static void set(std::string path, int value) {
     set(path, std::to_string(value));
 }
@@ -122,29 +94,23 @@ static inline bool isLit(const LightState& state) {
     return state.color & 0x00ffffff;
 }
 
-int getBatteryStatus(const LightState& state)
-{
-    int err;
+static int g_battery = BATTERY_UNKNOWN;
 
-    char status_str[16];
-    int capacity;
+static BatteryMonitor batteryMonitor;
 
-    err = readStr(BATTERY_STATUS_FILE, status_str, sizeof(status_str));
-    if (err <= 0) {
-        ALOGI("failed to read battery status: %d", err);
-        return BATTERY_UNKNOWN;
-    }
+static LedStateMachine ledStateMachine(
+    [](const char* path, const std::string& value) { set(path, value); });
 
-    ALOGI("battery status: %d, %s", err, status_str);
+static int getBatteryStatus(const LightState& state)
+{
+    int capacity;
 
     capacity = (state.color >> 24) & 0xff;
     if (capacity > 100) {
         capacity = 100;
     }
 
-    ALOGI("battery capacity: %d", capacity);
-
-    if (0 == strncmp(status_str, BATTERY_STATUS_CHARGING, 8)) {
+    if (batteryMonitor.isCharging()) {
         if (capacity < 90) {
             return BATTERY_CHARGING;
         } else {
@@ -161,94 +127,16 @@ int getBatteryStatus(const LightState& state)
 
 static void handleNubiaLed(const LightState& state, int source)
 {
-
-    int buttons;
-    int mode;
-
-    char grade[16];
-    size_t grade_len = 0;
-
-    char fade[16];
-    size_t fade_len = 0;
-
-    ALOGI("setting led %d: %08x, %d, %d", source,
-        state.color, state.flashOnMs, state.flashOffMs);
-
-    if (getBrightness(state) > 0) {
-        g_ongoing |= source;
-        ALOGI("ongoing +: %d = %d", source, g_ongoing);
-    } else {
-        g_ongoing &= ~source;
-        ALOGI("ongoing -: %d = %d", source, g_ongoing);
-    }
-
-    buttons = getBrightness(state) / 20;
-
-    /* set side buttons */
-
-    set(NUBIA_CHANNEL_FILE, SILDE_CHANNEL);
-    if (g_ongoing & ONGOING_BUTTONS) {
-        set(NUBIA_GRADE_FILE, buttons);
-        set(NUBIA_MODE_FILE, RGB_LED_MODE_CONSTANT_ON);
-    } else {
-        set(NUBIA_MODE_FILE, RGB_LED_MODE_OFF);
-    }
-
-    /* set middle ring */
-
-    if (g_ongoing & ONGOING_NOTIFICATION) {
-        mode = RGB_LED_MODE_AUTO_BLINK;
-        grade_len = sprintf(grade, "%d %d\n",
-            buttons,
-            buttons + getBrightness(state) / 20);
-    }
-    else if (g_ongoing & ONGOING_ATTENTION) {
-        mode = RGB_LED_MODE_AUTO_BLINK;
-        grade_len = sprintf(grade, "%d %d\n",
-            buttons,
-            buttons + getBrightness(state) / 20);
-    }
-    else if (g_battery == BATTERY_CHARGING) {
-        mode = RGB_LED_MODE_AUTO_BLINK;
-        grade_len = sprintf(grade, "%d %d\n",
-            buttons + BRIGHTNESS_BATTERY_FULL / 20,
-            buttons + BRIGHTNESS_BATTERY_CHARGING / 20);
-    }
-    else if (g_battery == BATTERY_FULL) {
-        mode = RGB_LED_MODE_CONSTANT_ON;
-        grade_len = sprintf(grade, "%d\n",
-            buttons + BRIGHTNESS_BATTERY_FULL / 20);
-    }
-    else if (g_battery == BATTERY_LOW) {
-        mode = RGB_LED_MODE_AUTO_BLINK;
-        grade_len = sprintf(grade, "%d %d\n",
-            buttons, buttons + BRIGHTNESS_BATTERY_LOW / 20);
-    }
-    else if (g_ongoing & ONGOING_BUTTONS) {
-        mode = RGB_LED_MODE_CONSTANT_ON;
-        grade_len = sprintf(grade, "%d\n", buttons);
-    }
-    else {
-        mode = RGB_LED_MODE_OFF;
-    }
-
-    if (state.flashMode == Flash::TIMED) {
-        fade_len = sprintf(fade, "%d %d %d\n",
-            1, state.flashOnMs / 400, state.flashOffMs / 400);
-    }
-
-    set(NUBIA_CHANNEL_FILE, MIDDLE_CHANNEL);
-
-    if (grade_len > 0) {
-        set(NUBIA_GRADE_FILE, grade, grade_len);
-    }
-
-    if (fade_len > 0) {
-        set(NUBIA_FADE_FILE, fade, fade_len);
-    }
-
-    set(NUBIA_MODE_FILE, mode);
-
+    LedEvent event = {
+        .brightness = getBrightness(state),
+        .timed = state.flashMode == Flash::TIMED,
+        .flashOnMs = state.flashOnMs,
+        .flashOffMs = state.flashOffMs,
+        .source = source,
+        .battery = g_battery,
+    };
+
+    ledStateMachine.update(event);
 }
 
 static void handleButtons(const LightState& state) {
@@ -285,9 +173,12 @@ namespace light {
 namespace V2_0 {
 namespace implementation {
 
+Light::Light() {
+    batteryMonitor.start([this] { onChargingChanged(); });
+}
+
 Return<Status> Light::setLight(Type type, const LightState& state) {
-    LightStateHandler handler;
-    bool handled = false;
+    LightStateHandler handler = nullptr;
 
     /* Lock global mutex until light state is updated. */
     std::lock_guard<std::mutex> lock(globalLock);
@@ -305,6 +196,14 @@ Return<Status> Light::setLight(Type type, const LightState& state) {
         return Status::LIGHT_NOT_SUPPORTED;
     }
 
+    applyLocked(handler, state);
+
+    return Status::SUCCESS;
+}
+
+void Light::applyLocked(LightStateHandler handler, const LightState& state) {
+    bool handled = false;
+
     /* Light up the type with the highest priority that matches the current handler. */
     for (LightBackend& backend : backends) {
         if (handler == backend.handler && isLit(backend.state)) {
@@ -318,8 +217,22 @@ Return<Status> Light::setLight(Type type, const LightState& state) {
     if (!handled) {
         handler(state);
     }
+}
 
-    return Status::SUCCESS;
+void Light::onChargingChanged() {
+    std::lock_guard<std::mutex> lock(globalLock);
+
+    /* Nothing to redo until the framework has set the battery light. */
+    if (g_battery == BATTERY_UNKNOWN) {
+        return;
+    }
+
+    for (const LightBackend& backend : backends) {
+        if (backend.type == Type::BATTERY) {
+            applyLocked(backend.handler, backend.state);
+            break;
+        }
+    }
 }
 
 Return<void> Light::getSupportedTypes(getSupportedTypes_cb _hidl_cb) {
@@ -334,6 +247,19 @@ Return<void> Light::getSupportedTypes(getSupportedTypes_cb _hidl_cb) {
     return Void();
 }
 
+Return<void> Light::debug(const hidl_handle& handle, const hidl_vec<hidl_string>& /* options */) {
+    if (handle == nullptr || handle->numFds < 1) {
+        return Void();
+    }
+
+    std::lock_guard<std::mutex> lock(globalLock);
+
+    dprintf(handle->data[0], "battery: %s\n", batteryMonitor.isCharging() ? "charging" : "not charging");
+    ledStateMachine.dumpTrace(handle->data[0]);
+
+    return Void();
+}
+
 }  // namespace implementation
 }  // namespace V2_0
 }  // namespace light
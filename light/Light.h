@@ -89,9 +89,9 @@ enum battery_status {
 #define BATTERY_STATUS_CHARGING     "Charging"
 
 
-static int g_ongoing = ONGOING_NONE;
-static int g_battery = BATTERY_UNKNOWN;
-
+using ::android::hardware::hidl_handle;
+using ::android::hardware::hidl_string;
+using ::android::hardware::hidl_vec;
 using ::android::hardware::Return;
 using ::android::hardware::Void;
 using ::android::hardware::light::V2_0::Flash;
@@ -121,10 +121,17 @@ namespace implementation {
 
 class Light : public ILight {
   public:
+    Light();
+
     Return<Status> setLight(Type type, const LightState& state) override;
     Return<void> getSupportedTypes(getSupportedTypes_cb _hidl_cb) override;
 
+    Return<void> debug(const hidl_handle& handle, const hidl_vec<hidl_string>& options) override;
+
   private:
+    void applyLocked(LightStateHandler handler, const LightState& state);
+    void onChargingChanged();
+
     std::mutex globalLock;
 };
 
@@ -48,6 +48,7 @@
 #include "hint-data.h"
 #include "performance.h"
 #include "power-common.h"
+#include "power-profiles.h"
 
 static int display_hint_sent;
 int launch_handle = -1;
@@ -81,41 +82,17 @@ static int process_cam_preview_hint(void *metadata)
     }
 
     if (cam_preview_metadata.state == 1) {
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            /* sched and cpufreq params
-             * above_hispeed_delay for LVT - 40ms
-             * go hispeed load for LVT - 95
-             * hispeed freq for LVT - 556 MHz
-             * target load for LVT - 90
-             * above hispeed delay for sLVT - 40ms
-             * go hispeed load for sLVT - 95
-             * hispeed freq for sLVT - 556 MHz
-             * target load for sLVT - 90
-             * bus DCVS set to V2 config:
-             *  low power ceil mpbs - 2500
-             *  low power io percent - 50
-             */
-            int resource_values[] = {0x41400000, 0x4, 0x41410000, 0x5F, 0x41414000, 0x22C,
-                0x41420000, 0x5A, 0x41400100, 0x4, 0x41410100, 0x5F, 0x41414100, 0x22C,
-                0x41420100, 0x5A, 0x41810000, 0x9C4, 0x41814000, 0x32};
+        if (((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
+                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) ||
+            ((strncmp(governor, SCHED_GOVERNOR, strlen(SCHED_GOVERNOR)) == 0) &&
+                (strlen(governor) == strlen(SCHED_GOVERNOR)))) {
+            struct power_profile *profile = power_profile_get("cam_preview", governor);
 
-            perform_hint_action(cam_preview_metadata.hint_id,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-            ALOGI("Cam Preview hint start");
-            return HINT_HANDLED;
-        } else if ((strncmp(governor, SCHED_GOVERNOR, strlen(SCHED_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(SCHED_GOVERNOR))) {
-            /*
-             * lower bus BW to save power
-             *   0x41810000: low power ceil mpbs = 2500
-             *   0x41814000: low power io percent = 50
-             */
-            int resource_values[] = {0x41810000, 0x9C4, 0x41814000, 0x32};
+            if (!profile)
+                return HINT_NONE;
 
-            perform_hint_action(
-                cam_preview_metadata.hint_id, resource_values,
-                sizeof(resource_values) / sizeof(resource_values[0]));
+            perform_hint_action(cam_preview_metadata.hint_id,
+                    profile->resources, profile->num_resources);
             ALOGI("Cam Preview hint start");
             return HINT_HANDLED;
         }
@@ -136,33 +113,24 @@ static int process_cam_preview_hint(void *metadata)
 static int process_boost(int boost_handle, int duration)
 {
     char governor[80];
-    int eas_launch_resources[] = {0x40804000, 0xFFF, 0x40804100, 0xFFF,
-                                         0x40800000, 0xFFF, 0x40800100, 0xFFF,
-                                         0x41800000, 140,   0x40400000, 0x1};
-    int hmp_launch_resources[] = {0x40C00000, 0x1,   0x40804000, 0xFFF,
-                                         0x40804100, 0xFFF, 0x40800000, 0xFFF,
-                                         0x40800100, 0xFFF, 0x41800000, 140,
-                                         0x40400000, 0x1};
-    int* launch_resources;
-    size_t launch_resources_size;
+    struct power_profile *profile;
 
     if (get_scaling_governor(governor, sizeof(governor)) == -1) {
         ALOGE("Can't obtain scaling governor.");
         return -1;
     }
-    if (strncmp(governor, SCHED_GOVERNOR, strlen(SCHED_GOVERNOR)) == 0) {
-        launch_resources = eas_launch_resources;
-        launch_resources_size = sizeof(eas_launch_resources) / sizeof(eas_launch_resources[0]);
-    } else if (strncmp(governor, INTERACTIVE_GOVERNOR,
-                       strlen(INTERACTIVE_GOVERNOR)) == 0) { /*HMP boost*/
-        launch_resources = hmp_launch_resources;
-        launch_resources_size = sizeof(hmp_launch_resources) / sizeof(hmp_launch_resources[0]);
-    } else {
+    if ((strncmp(governor, SCHED_GOVERNOR, strlen(SCHED_GOVERNOR)) != 0) &&
+        (strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) != 0)) {
         ALOGE("Unsupported governor.");
         return -1;
     }
+
+    profile = power_profile_get("launch", governor);
+    if (!profile)
+        return -1;
+
     boost_handle = interaction_with_handle(
-        boost_handle, duration, launch_resources_size, launch_resources);
+        boost_handle, duration, profile->num_resources, profile->resources);
     return boost_handle;
 }
 
@@ -181,49 +149,17 @@ static int process_video_encode_hint(void *metadata)
         int duration = 2000; // boosts 2s for starting encoding
         boost_handle = process_boost(boost_handle, duration);
         ALOGD("LAUNCH ENCODER-ON: %d MS", duration);
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            /* 1. cpufreq params
-             *    -above_hispeed_delay for LVT - 40ms
-             *    -go hispeed load for LVT - 95
-             *    -hispeed freq for LVT - 556 MHz
-             *    -target load for LVT - 90
-             *    -above hispeed delay for sLVT - 40ms
-             *    -go hispeed load for sLVT - 95
-             *    -hispeed freq for sLVT - 806 MHz
-             *    -target load for sLVT - 90
-             * 2. bus DCVS set to V2 config:
-             *    -low power ceil mpbs - 2500
-             *    -low power io percent - 50
-             * 3. hysteresis optimization
-             *    -bus dcvs hysteresis tuning
-             *    -sample_ms of 10 ms
-             *    -disable ignore_hispeed_notif
-             *    -sLVT hispeed freq to 806MHz
-             */
-            int resource_values[] = {
-                0x41810000, 0x9C4, 0x41814000, 0x32, 0x4180C000, 0x0, 0x41820000, 0xA,
-                0x41438100, 0x1,  0x41438000, 0x1 };
-
-            perform_hint_action(DEFAULT_VIDEO_ENCODE_HINT_ID,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-            ALOGD("Video Encode hint start");
-            return HINT_HANDLED;
-        } else if ((strncmp(governor, SCHED_GOVERNOR, strlen(SCHED_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(SCHED_GOVERNOR))) {
+        if (((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
+                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) ||
+            ((strncmp(governor, SCHED_GOVERNOR, strlen(SCHED_GOVERNOR)) == 0) &&
+                (strlen(governor) == strlen(SCHED_GOVERNOR)))) {
+            struct power_profile *profile = power_profile_get("video_encode", governor);
 
-            /* 1. bus DCVS set to V2 config:
-             *    0x41810000: low power ceil mpbs - 2500
-             *    0x41814000: low power io percent - 50
-             * 2. hysteresis optimization
-             *    0x4180C000: bus dcvs hysteresis tuning
-             *    0x41820000: sample_ms of 10 ms
-             */
-            int resource_values[] = {0x41810000, 0x9C4, 0x41814000, 0x32,
-                                     0x4180C000, 0x0,   0x41820000, 0xA};
+            if (!profile)
+                return HINT_NONE;
 
             perform_hint_action(DEFAULT_VIDEO_ENCODE_HINT_ID,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
+                    profile->resources, profile->num_resources);
             ALOGD("Video Encode hint start");
             return HINT_HANDLED;
         }
@@ -51,6 +51,8 @@
 #include "performance.h"
 #include "power-common.h"
 #include "power-helper.h"
+#include "power-profiles.h"
+#include "stats-reader.h"
 
 #define USINSEC 1000000L
 #define NSINUS 1000L
@@ -59,12 +61,18 @@
 #define RPM_SYSTEM_STAT "/d/system_stats"
 #endif
 
+#ifndef WLAN_POWER_STAT
+#define WLAN_POWER_STAT "/d/wlan0/power_stats"
+#endif
+
+/* How long parsed low power stats may be served without re-reading them */
+#define STATS_STALE_MS_PROP "ro.vendor.power.stats_stale_ms"
+#define STATS_STALE_MS_DEFAULT 1000
+
 #ifndef TAP_TO_WAKE_NODE
 #define TAP_TO_WAKE_NODE "/data/tp/easy_wakeup_gesture"
 #endif
 
-#define LINE_SIZE 128
-
 const char *rpm_stat_params[MAX_RPM_PARAMS] = {
     "count",
     "actual last sleep(msec)",
@@ -88,6 +96,20 @@ struct stat_pair rpm_stat_map[] = {
     { VOTER_SPSS,    "SPSS",    master_stat_params, ARRAY_SIZE(master_stat_params) },
 };
 
+const char *wlan_power_stat_params[WLAN_POWER_PARAMS_COUNT] = {
+    "cumulative_sleep_time_ms",
+    "cumulative_total_on_time_ms",
+    "deep_sleep_enter_counter",
+    "last_deep_sleep_enter_tstamp_ms"
+};
+
+struct stat_pair wlan_stat_map[] = {
+    { SUBSYSTEM_WLAN, "POWER DEBUG STATS", wlan_power_stat_params, ARRAY_SIZE(wlan_power_stat_params) },
+};
+
+static struct stats_reader rpm_stats_reader;
+static struct stats_reader wlan_stats_reader;
+
 static int saved_dcvs_cpu0_slack_max = -1;
 static int saved_dcvs_cpu0_slack_min = -1;
 static int saved_mpdecision_slack_max = -1;
@@ -110,6 +132,7 @@ void power_init(void)
     ALOGV("QCOM power HAL initing.");
 
     int fd;
+    int32_t stale_ms;
     char buf[10] = {0};
 
     fd = open("/sys/devices/soc0/soc_id", O_RDONLY);
@@ -124,6 +147,18 @@ void power_init(void)
         }
         close(fd);
     }
+
+    stale_ms = property_get_int32(STATS_STALE_MS_PROP, STATS_STALE_MS_DEFAULT);
+    if (stale_ms < 0)
+        stale_ms = 0;
+
+    if (power_profiles_init(POWER_PROFILES_FILE))
+        ALOGE("No power profiles loaded, boost hints are disabled");
+
+    stats_reader_init(&rpm_stats_reader, RPM_SYSTEM_STAT, rpm_stat_map,
+            ARRAY_SIZE(rpm_stat_map), MAX_PLATFORM_STATS, MAX_RPM_PARAMS, stale_ms);
+    stats_reader_init(&wlan_stats_reader, WLAN_POWER_STAT, wlan_stat_map,
+            ARRAY_SIZE(wlan_stat_map), SUBSYSTEM_COUNT, WLAN_POWER_PARAMS_COUNT, stale_ms);
 }
 
 static void process_video_decode_hint(void *metadata)
@@ -242,6 +277,17 @@ int __attribute__ ((weak)) power_hint_override(power_hint_t UNUSED(hint),
 void interaction(int duration, int num_args, int opt_list[]);
 void release_request(int lock_handle);
 
+static int acquire_profile(int lock_handle, int duration, const char *name)
+{
+    struct power_profile *profile = power_profile_get(name, NULL);
+
+    if (!profile)
+        return lock_handle;
+
+    return interaction_with_handle(lock_handle, duration,
+            profile->num_resources, profile->resources);
+}
+
 static long long calc_timespan_us(struct timespec start, struct timespec end) {
     long long diff_in_us = 0;
     diff_in_us += (end.tv_sec - start.tv_sec) * USINSEC;
@@ -273,59 +319,24 @@ void power_hint(power_hint_t hint, void *data)
         {
             int duration = 0;
             if (data && sustained_performance_mode == 0) {
-                int* resources;
                 if (vr_mode == 0) { // Sustained mode only.
                     // Ensure that POWER_HINT_LAUNCH is not in progress.
                     if (launch_mode == 1) {
                         release_request(launch_handle);
                         launch_mode = 0;
                     }
-                    // 0x40804000: cpu0 max freq
-                    // 0x40804100: cpu2 max freq
-                    // 0x42C20000: gpu max freq
-                    // 0x42C24000: gpu min freq
-                    // 0x42C28000: gpu bus min freq
-                    int resources[] = {0x40804000, 1209, 0x40804100, 1209,
-                                       0x42C24000, 133,  0x42C20000, 315,
-                                       0x42C28000, 7759};
-                    sustained_mode_handle = interaction_with_handle(
-                        sustained_mode_handle, duration,
-                        sizeof(resources) / sizeof(resources[0]), resources);
+                    sustained_mode_handle = acquire_profile(
+                        sustained_mode_handle, duration, "sustained");
                 } else if (vr_mode == 1) { // Sustained + VR mode.
                     release_request(vr_mode_handle);
-                    // 0x40804000: cpu0 max freq
-                    // 0x40804100: cpu2 max freq
-                    // 0x40800000: cpu0 min freq
-                    // 0x40800100: cpu2 min freq
-                    // 0x42C20000: gpu max freq
-                    // 0x42C24000: gpu min freq
-                    // 0x42C28000: gpu bus min freq
-                    int resources[] = {0x40800000, 1209, 0x40800100, 1209,
-                                       0x40804000, 1209, 0x40804100, 1209,
-                                       0x42C24000, 315,  0x42C20000, 315,
-                                       0x42C28000, 7759};
-                    sustained_mode_handle = interaction_with_handle(
-                        sustained_mode_handle, duration,
-                        sizeof(resources) / sizeof(resources[0]), resources);
+                    sustained_mode_handle = acquire_profile(
+                        sustained_mode_handle, duration, "vr_sustained");
                 }
                 sustained_performance_mode = 1;
             } else if (sustained_performance_mode == 1) {
                 release_request(sustained_mode_handle);
                 if (vr_mode == 1) { // Switch back to VR Mode.
-                    // 0x40804000: cpu0 max freq
-                    // 0x40804100: cpu2 max freq
-                    // 0x40800000: cpu0 min freq
-                    // 0x40800100: cpu2 min freq
-                    // 0x42C20000: gpu max freq
-                    // 0x42C24000: gpu min freq
-                    // 0x42C28000: gpu bus min freq
-                    int resources[] = {0x40804000, 1440, 0x40804100, 1440,
-                                       0x40800000, 1440, 0x40800100, 1440,
-                                       0x42C20000, 510,  0x42C24000, 510,
-                                       0x42C28000, 7759};
-                    vr_mode_handle = interaction_with_handle(
-                        vr_mode_handle, duration,
-                        sizeof(resources) / sizeof(resources[0]), resources);
+                    vr_mode_handle = acquire_profile(vr_mode_handle, duration, "vr");
                 }
                 sustained_performance_mode = 0;
             }
@@ -346,56 +357,18 @@ void power_hint(power_hint_t hint, void *data)
                         release_request(launch_handle);
                         launch_mode = 0;
                     }
-                    // 0x40804000: cpu0 max freq
-                    // 0x40804100: cpu2 max freq
-                    // 0x40800000: cpu0 min freq
-                    // 0x40800100: cpu2 min freq
-                    // 0x42C20000: gpu max freq
-                    // 0x42C24000: gpu min freq
-                    // 0x42C28000: gpu bus min freq
-                    int resources[] = {0x40800000, 1440, 0x40800100, 1440,
-                                       0x40804000, 1440, 0x40804100, 1440,
-                                       0x42C20000, 510,  0x42C24000, 510,
-                                       0x42C28000, 7759};
-                    vr_mode_handle = interaction_with_handle(
-                        vr_mode_handle, duration,
-                        sizeof(resources) / sizeof(resources[0]), resources);
+                    vr_mode_handle = acquire_profile(vr_mode_handle, duration, "vr");
                 } else if (sustained_performance_mode == 1) { // Sustained + VR mode.
                     release_request(sustained_mode_handle);
-                    // 0x40804000: cpu0 max freq
-                    // 0x40804100: cpu2 max freq
-                    // 0x40800000: cpu0 min freq
-                    // 0x40800100: cpu2 min freq
-                    // 0x42C20000: gpu max freq
-                    // 0x42C24000: gpu min freq
-                    // 0x42C28000: gpu bus min freq
-                    int resources[] = {0x40800000, 1209, 0x40800100, 1209,
-                                       0x40804000, 1209, 0x40804100, 1209,
-                                       0x42C24000, 315,  0x42C20000, 315,
-                                       0x42C28000, 7759};
-
-                    vr_mode_handle = interaction_with_handle(
-                        vr_mode_handle, duration,
-                        sizeof(resources) / sizeof(resources[0]), resources);
+                    vr_mode_handle = acquire_profile(
+                        vr_mode_handle, duration, "vr_sustained");
                 }
                 vr_mode = 1;
             } else if (vr_mode == 1) {
                 release_request(vr_mode_handle);
                 if (sustained_performance_mode == 1) { // Switch back to sustained Mode.
-                    // 0x40804000: cpu0 max freq
-                    // 0x40804100: cpu2 max freq
-                    // 0x40800000: cpu0 min freq
-                    // 0x40800100: cpu2 min freq
-                    // 0x42C20000: gpu max freq
-                    // 0x42C24000: gpu min freq
-                    // 0x42C28000: gpu bus min freq
-                    int resources[] = {0x40800000, 0,    0x40800100, 0,
-                                       0x40804000, 1209, 0x40804100, 1209,
-                                       0x42C24000, 133,  0x42C20000, 315,
-                                       0x42C28000, 0};
-                    sustained_mode_handle = interaction_with_handle(
-                        sustained_mode_handle, duration,
-                        sizeof(resources) / sizeof(resources[0]), resources);
+                    sustained_mode_handle = acquire_profile(
+                        sustained_mode_handle, duration, "sustained_after_vr");
                 }
                 vr_mode = 0;
             }
@@ -433,15 +406,10 @@ void power_hint(power_hint_t hint, void *data)
             s_previous_boost_timespec = cur_boost_timespec;
             s_previous_duration = duration;
 
-            // Scheduler is EAS.
-            if (true || strncmp(governor, SCHED_GOVERNOR, strlen(SCHED_GOVERNOR)) == 0) {
-                // Setting the value of foreground schedtune boost to 50 and
-                // scaling_min_freq to 1100MHz.
-                int resources[] = {0x40800000, 1100, 0x40800100, 1100, 0x42C0C000, 0x32, 0x41800000, 0x33};
-                interaction(duration, sizeof(resources)/sizeof(resources[0]), resources);
-            } else { // Scheduler is HMP.
-                int resources[] = {0x41800000, 0x33, 0x40800000, 1000, 0x40800100, 1000, 0x40C00000, 0x1};
-                interaction(duration, sizeof(resources)/sizeof(resources[0]), resources);
+            // Interaction boost is tuned for EAS; HMP may add a governor override.
+            struct power_profile *profile = power_profile_get("interaction", governor);
+            if (profile) {
+                interaction(duration, profile->num_resources, profile->resources);
             }
         }
         break;
@@ -676,87 +644,10 @@ void set_feature(feature_t feature, int state) {
     }
 }
 
-static int parse_stats(const char **params, size_t params_size,
-                       uint64_t *list, FILE *fp) {
-    ssize_t nread;
-    size_t len = LINE_SIZE;
-    char *line;
-    size_t params_read = 0;
-    size_t i;
-
-    line = malloc(len);
-    if (!line) {
-        ALOGE("%s: no memory to hold line", __func__);
-        return -ENOMEM;
-    }
-
-    while ((params_read < params_size) &&
-        (nread = getline(&line, &len, fp) > 0)) {
-        char *key = line + strspn(line, " \t");
-        char *value = strchr(key, ':');
-        if (!value || (value > (line + len)))
-            continue;
-        *value++ = '\0';
-
-        for (i = 0; i < params_size; i++) {
-            if (!strcmp(key, params[i])) {
-                list[i] = strtoull(value, NULL, 0);
-                params_read++;
-                break;
-            }
-        }
-    }
-    free(line);
-
-    return 0;
-}
-
-static int extract_stats(uint64_t *list, char *file,
-                         struct stat_pair *map, size_t map_size) {
-    FILE *fp;
-    ssize_t read;
-    size_t len = LINE_SIZE;
-    char *line;
-    size_t i, stats_read = 0;
-    int ret = 0;
-
-    fp = fopen(file, "re");
-    if (fp == NULL) {
-        ALOGE("%s: failed to open: %s Error = %s", __func__, file, strerror(errno));
-        return -errno;
-    }
-
-    line = malloc(len);
-    if (!line) {
-        ALOGE("%s: no memory to hold line", __func__);
-        fclose(fp);
-        return -ENOMEM;
-    }
-
-    while ((stats_read < map_size) && (read = getline(&line, &len, fp) != -1)) {
-        size_t begin = strspn(line, " \t");
-
-        for (i = 0; i < map_size; i++) {
-            if (!strncmp(line + begin, map[i].label, strlen(map[i].label))) {
-                stats_read++;
-                break;
-            }
-        }
-
-        if (i == map_size)
-            continue;
-
-        ret = parse_stats(map[i].parameters, map[i].num_parameters,
-                          &list[map[i].stat * MAX_RPM_PARAMS], fp);
-        if (ret < 0)
-            break;
-    }
-    free(line);
-    fclose(fp);
-
-    return ret;
+int extract_platform_stats(uint64_t *list) {
+    return stats_reader_get(&rpm_stats_reader, list);
 }
 
-int extract_platform_stats(uint64_t *list) {
-    return extract_stats(list, RPM_SYSTEM_STAT, rpm_stat_map, ARRAY_SIZE(rpm_stat_map));
+int extract_wlan_stats(uint64_t *list) {
+    return stats_reader_get(&wlan_stats_reader, list);
 }
@@ -53,10 +53,30 @@ enum stats_type {
 };
 
 enum subsystem_type {
+    SUBSYSTEM_WLAN = 0,
+
     //Don't add any lines after this line
     SUBSYSTEM_COUNT
 };
 
+enum wlan_sleep_states {
+    WLAN_STATE_ACTIVE = 0,
+    WLAN_STATE_DEEP_SLEEP,
+
+    //Don't add any lines after this line
+    WLAN_STATES_COUNT
+};
+
+enum wlan_power_params {
+    CUMULATIVE_SLEEP_TIME_MS = 0,
+    CUMULATIVE_TOTAL_ON_TIME_MS,
+    DEEP_SLEEP_ENTER_COUNTER,
+    LAST_DEEP_SLEEP_ENTER_TSTAMP_MS,
+
+    //Don't add any lines after this line
+    WLAN_POWER_PARAMS_COUNT
+};
+
 #define PLATFORM_SLEEP_MODES_COUNT RPM_MODE_MAX
 
 #define MAX_RPM_PARAMS 2
@@ -64,7 +84,7 @@ enum subsystem_type {
 #define VMIN_VOTERS 0
 
 struct stat_pair {
-    enum stats_type stat;
+    int stat;
     const char *label;
     const char **parameters;
     size_t num_parameters;
@@ -75,6 +95,7 @@ void power_init(void);
 void power_hint(power_hint_t hint, void *data);
 void power_set_interactive(int on);
 int extract_platform_stats(uint64_t *list);
+int extract_wlan_stats(uint64_t *list);
 void set_feature(feature_t feature, int state);
 
 #ifdef __cplusplus
@@ -0,0 +1,508 @@
+/*
+ * Copyright (C) 2018 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_NDEBUG 1
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <expat.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <log/log.h>
+
+#include "power-profiles.h"
+
+#define MAX_PROFILE_DEFS 32
+#define MAX_PROFILE_GOVERNORS 4
+#define MAX_INHERIT_DEPTH 8
+
+#define PROFILES_TAG "HalProfiles"
+#define PROFILE_TAG "Profile"
+#define OVERRIDE_TAG "Override"
+
+/*
+ * One <Profile> or <Override> element as written in the XML. Overrides
+ * carry the governor they apply to; base profiles have an empty one.
+ */
+struct profile_def {
+    char name[PROFILE_NAME_MAX];
+    char parent[PROFILE_NAME_MAX];
+    char governor[PROFILE_NAME_MAX];
+    int resources[PROFILE_MAX_RESOURCES];
+    int num_resources;
+};
+
+struct profile_parser {
+    int in_profiles;
+    int errors;
+};
+
+static struct profile_def defs[MAX_PROFILE_DEFS];
+static int num_defs;
+
+static char governors[MAX_PROFILE_GOVERNORS][PROFILE_NAME_MAX];
+static int num_governors;
+
+static struct power_profile profiles[MAX_PROFILE_DEFS * (MAX_PROFILE_GOVERNORS + 1)];
+static int num_profiles;
+
+static const char *get_attr(const XML_Char **attr, const char *key)
+{
+    int i;
+
+    for (i = 0; attr[i]; i += 2) {
+        if (!strcmp(attr[i], key))
+            return attr[i + 1];
+    }
+
+    return NULL;
+}
+
+static struct profile_def *find_def(const char *name, const char *governor)
+{
+    int i;
+
+    for (i = 0; i < num_defs; i++) {
+        if (!strcmp(defs[i].name, name) && !strcmp(defs[i].governor, governor))
+            return &defs[i];
+    }
+
+    return NULL;
+}
+
+/*
+ * Parses a comma separated list of opcode/value pairs. An opcode repeated
+ * with a different value within one element is a conflict.
+ */
+static int parse_resources(const char *str, struct profile_def *def)
+{
+    const char *p = str;
+    char *end;
+    int i;
+
+    def->num_resources = 0;
+
+    while (*p) {
+        long val;
+
+        p += strspn(p, " \t\r\n,");
+        if (!*p)
+            break;
+
+        if (def->num_resources >= PROFILE_MAX_RESOURCES) {
+            ALOGE("%s: profile %s has too many resources", __func__, def->name);
+            return -ENOSPC;
+        }
+
+        errno = 0;
+        val = strtol(p, &end, 0);
+        if (end == p || errno) {
+            ALOGE("%s: profile %s has a malformed resource near \"%.16s\"",
+                  __func__, def->name, p);
+            return -EINVAL;
+        }
+        def->resources[def->num_resources++] = (int)val;
+        p = end;
+    }
+
+    if (def->num_resources % 2) {
+        ALOGE("%s: profile %s has an opcode without a value", __func__, def->name);
+        return -EINVAL;
+    }
+
+    for (i = 0; i < def->num_resources; i += 2) {
+        int j;
+
+        for (j = i + 2; j < def->num_resources; j += 2) {
+            if (def->resources[i] != def->resources[j])
+                continue;
+
+            if (def->resources[i + 1] != def->resources[j + 1]) {
+                ALOGE("%s: profile %s sets opcode 0x%08X to both %d and %d",
+                      __func__, def->name, def->resources[i],
+                      def->resources[i + 1], def->resources[j + 1]);
+                return -EINVAL;
+            }
+            ALOGW("%s: profile %s repeats opcode 0x%08X", __func__, def->name,
+                  def->resources[i]);
+        }
+    }
+
+    return 0;
+}
+
+static int add_governor(const char *governor)
+{
+    int i;
+
+    for (i = 0; i < num_governors; i++) {
+        if (!strcmp(governors[i], governor))
+            return 0;
+    }
+
+    if (num_governors >= MAX_PROFILE_GOVERNORS)
+        return -ENOSPC;
+
+    strlcpy(governors[num_governors++], governor, PROFILE_NAME_MAX);
+
+    return 0;
+}
+
+static void start_tag(void *data, const XML_Char *tag, const XML_Char **attr)
+{
+    struct profile_parser *parser = data;
+    struct profile_def *def;
+    const char *name, *parent, *governor, *resources;
+    int is_override;
+
+    if (!strcmp(tag, PROFILES_TAG)) {
+        parser->in_profiles = 1;
+        return;
+    }
+
+    if (!parser->in_profiles)
+        return;
+
+    is_override = !strcmp(tag, OVERRIDE_TAG);
+    if (!is_override && strcmp(tag, PROFILE_TAG))
+        return;
+
+    name = get_attr(attr, is_override ? PROFILE_TAG : "Name");
+    parent = get_attr(attr, "Parent");
+    governor = get_attr(attr, "Governor");
+    resources = get_attr(attr, "Resources");
+
+    if (!name || (is_override && !governor) || (!is_override && governor)) {
+        ALOGE("%s: malformed <%s> element", __func__, tag);
+        parser->errors++;
+        return;
+    }
+
+    if (is_override && parent) {
+        ALOGE("%s: override of %s for %s can't have a parent", __func__, name,
+              governor);
+        parser->errors++;
+        return;
+    }
+
+    if (find_def(name, governor ? governor : "")) {
+        ALOGE("%s: %s %s%s%s defined twice", __func__, tag, name,
+              governor ? "/" : "", governor ? governor : "");
+        parser->errors++;
+        return;
+    }
+
+    if (num_defs >= MAX_PROFILE_DEFS) {
+        ALOGE("%s: too many profiles, ignoring %s", __func__, name);
+        parser->errors++;
+        return;
+    }
+
+    def = &defs[num_defs];
+    memset(def, 0, sizeof(*def));
+    strlcpy(def->name, name, sizeof(def->name));
+    if (parent)
+        strlcpy(def->parent, parent, sizeof(def->parent));
+    if (governor) {
+        strlcpy(def->governor, governor, sizeof(def->governor));
+        if (add_governor(governor)) {
+            ALOGE("%s: too many governors, ignoring %s", __func__, governor);
+            parser->errors++;
+            return;
+        }
+    }
+
+    if (resources && parse_resources(resources, def)) {
+        parser->errors++;
+        return;
+    }
+
+    num_defs++;
+}
+
+static void end_tag(void *data, const XML_Char *tag)
+{
+    struct profile_parser *parser = data;
+
+    if (!strcmp(tag, PROFILES_TAG))
+        parser->in_profiles = 0;
+}
+
+/*
+ * Applies src on top of dst: opcodes already in dst take the new value,
+ * the others are appended.
+ */
+static int merge_resources(struct power_profile *dst, const int *src, int num)
+{
+    int i, j;
+
+    for (i = 0; i < num; i += 2) {
+        for (j = 0; j < dst->num_resources; j += 2) {
+            if (dst->resources[j] == src[i]) {
+                dst->resources[j + 1] = src[i + 1];
+                break;
+            }
+        }
+
+        if (j < dst->num_resources)
+            continue;
+
+        if (dst->num_resources + 2 > PROFILE_MAX_RESOURCES)
+            return -ENOSPC;
+
+        dst->resources[dst->num_resources++] = src[i];
+        dst->resources[dst->num_resources++] = src[i + 1];
+    }
+
+    return 0;
+}
+
+static int compile_profile(struct power_profile *out, const char *name,
+                           const char *governor, int depth)
+{
+    struct profile_def *base, *override;
+    int ret;
+
+    if (depth > MAX_INHERIT_DEPTH) {
+        ALOGE("%s: inheritance loop through %s", __func__, name);
+        return -ELOOP;
+    }
+
+    base = find_def(name, "");
+    if (!base) {
+        ALOGE("%s: unknown profile %s", __func__, name);
+        return -ENOENT;
+    }
+
+    if (base->parent[0]) {
+        ret = compile_profile(out, base->parent, governor, depth + 1);
+        if (ret)
+            return ret;
+    }
+
+    ret = merge_resources(out, base->resources, base->num_resources);
+    if (ret)
+        goto overflow;
+
+    override = governor[0] ? find_def(name, governor) : NULL;
+    if (override) {
+        ret = merge_resources(out, override->resources, override->num_resources);
+        if (ret)
+            goto overflow;
+    }
+
+    return 0;
+
+overflow:
+    ALOGE("%s: profile %s has too many resources", __func__, name);
+    return ret;
+}
+
+static void compile_profiles(void)
+{
+    int i, j;
+
+    num_profiles = 0;
+
+    for (i = 0; i < num_defs; i++) {
+        if (defs[i].governor[0])
+            continue;
+
+        for (j = -1; j < num_governors; j++) {
+            struct power_profile *profile = &profiles[num_profiles];
+            const char *governor = j < 0 ? "" : governors[j];
+
+            memset(profile, 0, sizeof(*profile));
+            strlcpy(profile->name, defs[i].name, sizeof(profile->name));
+            strlcpy(profile->governor, governor, sizeof(profile->governor));
+
+            if (compile_profile(profile, defs[i].name, governor, 0))
+                break;
+
+            ALOGV("%s: %s/%s has %d resources", __func__, profile->name,
+                  governor[0] ? governor : "*", profile->num_resources);
+            num_profiles++;
+        }
+    }
+
+    for (i = 0; i < num_defs; i++) {
+        if (defs[i].governor[0] && !find_def(defs[i].name, ""))
+            ALOGE("%s: override of unknown profile %s", __func__, defs[i].name);
+    }
+}
+
+/*
+ * Built-in copy of the <HalProfiles> section of powerhint.xml, used when
+ * the file can't be loaded so the hints never silently lose their boosts.
+ * Keep in sync with configs/powerhint.xml.
+ */
+static const char default_profiles[] =
+    "<HalProfiles>"
+    "<Profile Name=\"launch\" Resources=\"0x40804000, 0xFFF, 0x40804100, 0xFFF,"
+    " 0x40800000, 0xFFF, 0x40800100, 0xFFF, 0x41800000, 140, 0x40400000, 0x1\"/>"
+    "<Override Profile=\"launch\" Governor=\"interactive\""
+    " Resources=\"0x40C00000, 0x1\"/>"
+    "<Profile Name=\"interaction\" Resources=\"0x40800000, 1100, 0x40800100, 1100,"
+    " 0x42C0C000, 0x32, 0x41800000, 0x33\"/>"
+    "<Profile Name=\"sustained\" Resources=\"0x40804000, 1209, 0x40804100, 1209,"
+    " 0x42C24000, 133, 0x42C20000, 315, 0x42C28000, 7759\"/>"
+    "<Profile Name=\"sustained_after_vr\" Parent=\"sustained\""
+    " Resources=\"0x40800000, 0, 0x40800100, 0, 0x42C28000, 0\"/>"
+    "<Profile Name=\"vr_sustained\" Parent=\"sustained\""
+    " Resources=\"0x40800000, 1209, 0x40800100, 1209, 0x42C24000, 315\"/>"
+    "<Profile Name=\"vr\" Resources=\"0x40800000, 1440, 0x40800100, 1440,"
+    " 0x40804000, 1440, 0x40804100, 1440, 0x42C20000, 510, 0x42C24000, 510,"
+    " 0x42C28000, 7759\"/>"
+    "<Profile Name=\"video_encode\" Resources=\"0x41810000, 0x9C4, 0x41814000, 0x32,"
+    " 0x4180C000, 0x0, 0x41820000, 0xA\"/>"
+    "<Override Profile=\"video_encode\" Governor=\"interactive\""
+    " Resources=\"0x41438100, 0x1, 0x41438000, 0x1\"/>"
+    "<Profile Name=\"cam_preview\" Resources=\"0x41810000, 0x9C4, 0x41814000, 0x32\"/>"
+    "<Override Profile=\"cam_preview\" Governor=\"interactive\""
+    " Resources=\"0x41400000, 0x4, 0x41410000, 0x5F, 0x41414000, 0x22C,"
+    " 0x41420000, 0x5A, 0x41400100, 0x4, 0x41410100, 0x5F, 0x41414100, 0x22C,"
+    " 0x41420100, 0x5A\"/>"
+    "</HalProfiles>";
+
+/* Names already reported missing by power_profile_get */
+static char missing[MAX_PROFILE_DEFS][PROFILE_NAME_MAX];
+static int num_missing;
+
+static char *read_file(const char *path, ssize_t *len)
+{
+    struct stat st;
+    char *buf = NULL;
+    int fd;
+
+    *len = 0;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        ALOGE("%s: failed to open: %s Error = %s", __func__, path, strerror(errno));
+        return NULL;
+    }
+
+    if (fstat(fd, &st) < 0 || !(buf = malloc(st.st_size))) {
+        ALOGE("%s: can't load %s", __func__, path);
+        close(fd);
+        return NULL;
+    }
+
+    while (*len < st.st_size) {
+        ssize_t n = TEMP_FAILURE_RETRY(read(fd, buf + *len, st.st_size - *len));
+        if (n <= 0)
+            break;
+        *len += n;
+    }
+    close(fd);
+
+    return buf;
+}
+
+static int parse_profiles(const char *buf, ssize_t len, const char *source)
+{
+    struct profile_parser state = { 0, 0 };
+    XML_Parser parser;
+    int ret = 0;
+
+    num_defs = 0;
+    num_governors = 0;
+    num_profiles = 0;
+
+    parser = XML_ParserCreate(NULL);
+    if (!parser)
+        return -ENOMEM;
+
+    XML_SetUserData(parser, &state);
+    XML_SetElementHandler(parser, start_tag, end_tag);
+
+    if (XML_Parse(parser, buf, len, 1) == XML_STATUS_ERROR) {
+        ALOGE("%s: %s at line %lu of %s", __func__,
+              XML_ErrorString(XML_GetErrorCode(parser)),
+              (unsigned long)XML_GetCurrentLineNumber(parser), source);
+        ret = -EINVAL;
+    }
+
+    XML_ParserFree(parser);
+
+    if (state.errors)
+        ALOGE("%s: %d invalid profiles in %s were dropped", __func__,
+              state.errors, source);
+
+    compile_profiles();
+    ALOGI("Loaded %d power profiles from %s", num_profiles, source);
+
+    return ret;
+}
+
+int power_profiles_init(const char *path)
+{
+    ssize_t len;
+    char *buf;
+    int ret;
+
+    num_missing = 0;
+
+    buf = read_file(path, &len);
+    ret = buf ? parse_profiles(buf, len, path) : -ENOENT;
+    free(buf);
+
+    if (!ret && num_profiles > 0)
+        return 0;
+
+    ALOGE("%s: no usable power profiles in %s, using the built-in ones",
+          __func__, path);
+
+    return parse_profiles(default_profiles, sizeof(default_profiles) - 1,
+                          "built-in profiles");
+}
+
+struct power_profile *power_profile_get(const char *name, const char *governor)
+{
+    struct power_profile *base = NULL;
+    int i;
+
+    for (i = 0; i < num_profiles; i++) {
+        if (strcmp(profiles[i].name, name))
+            continue;
+
+        if (!profiles[i].governor[0]) {
+            base = &profiles[i];
+            if (!governor)
+                break;
+        } else if (governor && !strcmp(profiles[i].governor, governor)) {
+            return &profiles[i];
+        }
+    }
+
+    if (!base) {
+        /* Hints come in continuously, only report each missing name once. */
+        for (i = 0; i < num_missing; i++) {
+            if (!strcmp(missing[i], name))
+                return NULL;
+        }
+        ALOGE("%s: no power profile named %s", __func__, name);
+        if (num_missing < MAX_PROFILE_DEFS)
+            strlcpy(missing[num_missing++], name, PROFILE_NAME_MAX);
+    }
+
+    return base;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2018 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __POWER_PROFILES_H__
+#define __POWER_PROFILES_H__
+
+#ifndef POWER_PROFILES_FILE
+#define POWER_PROFILES_FILE "/vendor/etc/powerhint.xml"
+#endif
+
+#define PROFILE_NAME_MAX 32
+/* Opcode/value pairs, so this holds PROFILE_MAX_RESOURCES / 2 opcodes */
+#define PROFILE_MAX_RESOURCES 64
+
+/*
+ * A profile compiled for one governor, with its parents and governor
+ * override already merged in. resources can be handed to perf_lock_acq
+ * as is.
+ */
+struct power_profile {
+    char name[PROFILE_NAME_MAX];
+    char governor[PROFILE_NAME_MAX];
+    int resources[PROFILE_MAX_RESOURCES];
+    int num_resources;
+};
+
+int power_profiles_init(const char *path);
+/*
+ * Returns the profile compiled for governor, or its governor independent
+ * base if governor is NULL or has no override. NULL if name is unknown.
+ */
+struct power_profile *power_profile_get(const char *name, const char *governor);
+
+#endif //__POWER_PROFILES_H__
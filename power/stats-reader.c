@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2018 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_NDEBUG 1
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <log/log.h>
+
+#include "stats-reader.h"
+
+#define STATS_BUF_SIZE 4096
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int trie_insert(struct stats_reader *reader, const char *label,
+                       int16_t entry)
+{
+    int16_t node = 0;
+    const char *p;
+
+    for (p = label; *p; p++) {
+        int16_t child = reader->trie[node].child;
+
+        while (child >= 0 && reader->trie[child].c != *p)
+            child = reader->trie[child].sibling;
+
+        if (child < 0) {
+            if (reader->trie_nodes >= STATS_TRIE_MAX_NODES)
+                return -ENOMEM;
+
+            child = reader->trie_nodes++;
+            reader->trie[child].c = *p;
+            reader->trie[child].child = -1;
+            reader->trie[child].sibling = reader->trie[node].child;
+            reader->trie[child].entry = -1;
+            reader->trie[node].child = child;
+        }
+        node = child;
+    }
+
+    /* Keep the first label in map order, as the linear scan did. */
+    if (reader->trie[node].entry < 0)
+        reader->trie[node].entry = entry;
+
+    return 0;
+}
+
+/*
+ * Returns the map entry whose label is a prefix of line, or -1.
+ */
+static int trie_match(const struct stats_reader *reader, const char *line)
+{
+    int16_t node = 0;
+    const char *p;
+
+    for (p = line; *p; p++) {
+        int16_t child = reader->trie[node].child;
+
+        while (child >= 0 && reader->trie[child].c != *p)
+            child = reader->trie[child].sibling;
+
+        if (child < 0)
+            return -1;
+
+        node = child;
+        if (reader->trie[node].entry >= 0)
+            return reader->trie[node].entry;
+    }
+
+    return -1;
+}
+
+int stats_reader_init(struct stats_reader *reader, const char *path,
+                      const struct stat_pair *map, size_t map_size,
+                      size_t num_stats, size_t stride, uint64_t stale_ms)
+{
+    size_t i;
+    int ret;
+
+    memset(reader, 0, sizeof(*reader));
+    reader->path = path;
+    reader->map = map;
+    reader->map_size = map_size;
+    reader->num_stats = num_stats;
+    reader->stride = stride;
+    reader->stale_ms = stale_ms;
+    reader->fd = -1;
+    pthread_mutex_init(&reader->lock, NULL);
+
+    reader->cache = calloc(num_stats * stride, sizeof(uint64_t));
+    if (!reader->cache) {
+        ALOGE("%s: no memory for %s cache", __func__, path);
+        return -ENOMEM;
+    }
+
+    reader->trie[0].child = -1;
+    reader->trie[0].sibling = -1;
+    reader->trie[0].entry = -1;
+    reader->trie_nodes = 1;
+
+    for (i = 0; i < map_size; i++) {
+        ret = trie_insert(reader, map[i].label, i);
+        if (ret < 0) {
+            ALOGE("%s: too many labels for %s", __func__, path);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+static int stats_reader_open(struct stats_reader *reader)
+{
+    if (reader->fd >= 0)
+        return 0;
+
+    reader->fd = open(reader->path, O_RDONLY | O_CLOEXEC);
+    if (reader->fd < 0) {
+        ALOGE("%s: failed to open: %s Error = %s", __func__, reader->path,
+              strerror(errno));
+        return -errno;
+    }
+
+    return 0;
+}
+
+/*
+ * Reads the whole node from offset 0 into the reusable buffer. The buffer
+ * only grows, so after the first poll no further allocation happens.
+ */
+static ssize_t stats_reader_fill(struct stats_reader *reader)
+{
+    size_t total = 0;
+    ssize_t n;
+
+    for (;;) {
+        if (total + 1 >= reader->buf_size) {
+            size_t size = reader->buf_size ? reader->buf_size * 2 : STATS_BUF_SIZE;
+            char *buf = realloc(reader->buf, size);
+
+            if (!buf) {
+                ALOGE("%s: no memory to hold %s", __func__, reader->path);
+                return -ENOMEM;
+            }
+            reader->buf = buf;
+            reader->buf_size = size;
+        }
+
+        n = TEMP_FAILURE_RETRY(pread(reader->fd, reader->buf + total,
+                                     reader->buf_size - total - 1, total));
+        if (n < 0)
+            return -errno;
+        if (n == 0)
+            break;
+        total += n;
+    }
+    reader->buf[total] = '\0';
+
+    return total;
+}
+
+static void stats_reader_parse(struct stats_reader *reader, size_t len)
+{
+    const struct stat_pair *section = NULL;
+    uint64_t *values = NULL;
+    size_t params_read = 0;
+    char *line = reader->buf;
+    char *end = reader->buf + len;
+    size_t i;
+
+    memset(reader->cache, 0,
+           reader->num_stats * reader->stride * sizeof(uint64_t));
+
+    while (line < end) {
+        char *eol = memchr(line, '\n', end - line);
+        char *key;
+
+        if (!eol)
+            eol = end;
+        *eol = '\0';
+        key = line + strspn(line, " \t");
+
+        if (section && params_read < section->num_parameters) {
+            char *value = strchr(key, ':');
+
+            if (value) {
+                *value++ = '\0';
+                for (i = 0; i < section->num_parameters; i++) {
+                    if (!strcmp(key, section->parameters[i])) {
+                        values[i] = strtoull(value, NULL, 0);
+                        params_read++;
+                        break;
+                    }
+                }
+            }
+        } else {
+            int entry = trie_match(reader, key);
+
+            if (entry >= 0) {
+                section = &reader->map[entry];
+                values = &reader->cache[section->stat * reader->stride];
+                params_read = 0;
+            }
+        }
+
+        line = eol + 1;
+    }
+}
+
+static int stats_reader_refresh(struct stats_reader *reader)
+{
+    ssize_t len;
+    int ret;
+
+    ret = stats_reader_open(reader);
+    if (ret < 0)
+        return ret;
+
+    len = stats_reader_fill(reader);
+    if (len < 0 && len != -ENOMEM) {
+        /* The node may have been recreated underneath us; retry once. */
+        close(reader->fd);
+        reader->fd = -1;
+
+        ret = stats_reader_open(reader);
+        if (ret < 0)
+            return ret;
+        len = stats_reader_fill(reader);
+    }
+
+    if (len < 0) {
+        ALOGE("%s: failed to read: %s Error = %s", __func__, reader->path,
+              strerror(-len));
+        return len;
+    }
+
+    stats_reader_parse(reader, len);
+
+    return 0;
+}
+
+int stats_reader_get(struct stats_reader *reader, uint64_t *list)
+{
+    uint64_t now = now_ms();
+    int ret = 0;
+
+    if (!reader->cache)
+        return -ENODEV;
+
+    pthread_mutex_lock(&reader->lock);
+
+    if (!reader->cache_valid || now - reader->last_update_ms >= reader->stale_ms) {
+        ret = stats_reader_refresh(reader);
+        reader->cache_valid = (ret == 0);
+        reader->last_update_ms = now;
+    }
+
+    if (ret == 0)
+        memcpy(list, reader->cache,
+               reader->num_stats * reader->stride * sizeof(uint64_t));
+
+    pthread_mutex_unlock(&reader->lock);
+
+    return ret;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2018 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __STATS_READER_H__
+#define __STATS_READER_H__
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "power-helper.h"
+
+#define STATS_TRIE_MAX_NODES 256
+
+struct stats_trie_node {
+    char c;
+    int16_t child;
+    int16_t sibling;
+    /* Index into the stat_pair map of the label ending here, or -1. */
+    int16_t entry;
+};
+
+/*
+ * Keeps a debugfs stats node open and parses it in a single pass. Section
+ * labels are matched through a trie built once from the stat_pair map, and
+ * parsed values are served from a cache while younger than stale_ms.
+ */
+struct stats_reader {
+    const char *path;
+    const struct stat_pair *map;
+    size_t map_size;
+    size_t num_stats;
+    size_t stride;
+
+    int fd;
+    char *buf;
+    size_t buf_size;
+
+    struct stats_trie_node trie[STATS_TRIE_MAX_NODES];
+    int trie_nodes;
+
+    uint64_t *cache;
+    uint64_t last_update_ms;
+    uint64_t stale_ms;
+    int cache_valid;
+
+    pthread_mutex_t lock;
+};
+
+int stats_reader_init(struct stats_reader *reader, const char *path,
+                      const struct stat_pair *map, size_t map_size,
+                      size_t num_stats, size_t stride, uint64_t stale_ms);
+int stats_reader_get(struct stats_reader *reader, uint64_t *list);
+
+#endif //__STATS_READER_H__
@@ -14,10 +14,6 @@
  * limitations under the License.
  */
 
-#include <android-base/file.h>
-#include <android-base/logging.h>
-#include <android-base/strings.h>
-
 #include "KeyDisabler.h"
 
 namespace vendor {
@@ -26,35 +22,27 @@ namespace touch {
 namespace V1_0 {
 namespace implementation {
 
-constexpr const char kControlPath[] = "/data/tp/keypad_enable";
-
-KeyDisabler::KeyDisabler() {
-    mHasKeyDisabler = !access(kControlPath, F_OK);
+KeyDisabler::KeyDisabler() : mControls(TouchControls::getInstance()) {
+    mHasKeyDisabler = mControls.has(TouchControl::KEYPAD_ENABLE);
 }
 
 // Methods from ::vendor::mokee::touch::V1_0::IKeyDisabler follow.
 Return<bool> KeyDisabler::isEnabled() {
-    std::string buf;
+    int value;
 
     if (!mHasKeyDisabler) return false;
 
-    if (!android::base::ReadFileToString(kControlPath, &buf, true)) {
-        LOG(ERROR) << "Failed to read " << kControlPath;
+    if (!mControls.get(TouchControl::KEYPAD_ENABLE, &value)) {
         return false;
     }
 
-    return std::stoi(android::base::Trim(buf)) == 0;
+    return value == 0;
 }
 
 Return<bool> KeyDisabler::setEnabled(bool enabled) {
     if (!mHasKeyDisabler) return false;
 
-    if (!android::base::WriteStringToFile((enabled ? "0" : "1"), kControlPath, true)) {
-        LOG(ERROR) << "Failed to write " << kControlPath;
-        return false;
-    }
-
-    return true;
+    return mControls.set(TouchControl::KEYPAD_ENABLE, enabled ? 0 : 1);
 }
 
 }  // namespace implementation
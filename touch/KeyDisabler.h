@@ -19,6 +19,8 @@
 
 #include <vendor/mokee/touch/1.0/IKeyDisabler.h>
 
+#include "TouchControls.h"
+
 namespace vendor {
 namespace mokee {
 namespace touch {
@@ -36,6 +38,7 @@ class KeyDisabler : public IKeyDisabler {
     Return<bool> setEnabled(bool enabled) override;
 
   private:
+    TouchControls& mControls;
     bool mHasKeyDisabler;
 };
 
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2019 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/strings.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "TouchControls.h"
+
+namespace vendor {
+namespace mokee {
+namespace touch {
+namespace V1_0 {
+namespace implementation {
+
+TouchControls& TouchControls::getInstance() {
+    static TouchControls instance;
+    return instance;
+}
+
+TouchControls::TouchControls()
+    : mEntries{
+          {"/data/tp/keypad_enable", false, -1, -1},
+      } {
+    mInotifyFd = inotify_init1(IN_CLOEXEC);
+    if (mInotifyFd < 0) {
+        PLOG(ERROR) << "Failed to init inotify, touch controls won't follow external writes";
+    }
+
+    for (Entry& entry : mEntries) {
+        entry.present = !access(entry.path, F_OK);
+        if (!entry.present) continue;
+
+        read(entry);
+
+        if (mInotifyFd >= 0) {
+            // The nodes are symlinks into sysfs; the watch follows them.
+            entry.wd = inotify_add_watch(mInotifyFd, entry.path, IN_CLOSE_WRITE | IN_MODIFY);
+            if (entry.wd < 0) {
+                PLOG(ERROR) << "Failed to watch " << entry.path;
+            }
+        }
+    }
+
+    if (mInotifyFd >= 0) {
+        mWatcher = std::thread(&TouchControls::watch, this);
+        mWatcher.detach();
+    }
+}
+
+bool TouchControls::read(Entry& entry) {
+    std::string buf;
+    int value;
+
+    if (!android::base::ReadFileToString(entry.path, &buf, true)) {
+        LOG(ERROR) << "Failed to read " << entry.path;
+        return false;
+    }
+
+    if (!android::base::ParseInt(android::base::Trim(buf), &value)) {
+        LOG(ERROR) << "Unexpected value in " << entry.path << ": " << buf;
+        return false;
+    }
+
+    entry.value = value;
+    return true;
+}
+
+void TouchControls::watch() {
+    char buf[sizeof(struct inotify_event) * 16] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    for (;;) {
+        ssize_t len = TEMP_FAILURE_RETRY(::read(mInotifyFd, buf, sizeof(buf)));
+        if (len <= 0) {
+            PLOG(ERROR) << "Failed to read inotify events";
+            return;
+        }
+
+        for (char* p = buf; p < buf + len;) {
+            struct inotify_event* event = reinterpret_cast<struct inotify_event*>(p);
+            std::lock_guard<std::mutex> lock(mLock);
+
+            for (Entry& entry : mEntries) {
+                if (entry.present && entry.wd == event->wd) {
+                    read(entry);
+                    break;
+                }
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+bool TouchControls::has(TouchControl control) {
+    return mEntries[static_cast<int>(control)].present;
+}
+
+bool TouchControls::get(TouchControl control, int* value) {
+    std::lock_guard<std::mutex> lock(mLock);
+    const Entry& entry = mEntries[static_cast<int>(control)];
+
+    if (!entry.present || entry.value < 0) return false;
+
+    *value = entry.value;
+    return true;
+}
+
+bool TouchControls::set(TouchControl control, int value) {
+    std::lock_guard<std::mutex> lock(mLock);
+    Entry& entry = mEntries[static_cast<int>(control)];
+
+    if (!entry.present) return false;
+
+    if (!android::base::WriteStringToFile(std::to_string(value), entry.path, true)) {
+        LOG(ERROR) << "Failed to write " << entry.path;
+        return false;
+    }
+
+    entry.value = value;
+    return true;
+}
+
+}  // namespace implementation
+}  // namespace V1_0
+}  // namespace touch
+}  // namespace mokee
+}  // namespace vendor
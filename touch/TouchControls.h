@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2019 The LineageOS Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VENDOR_MOKEE_TOUCH_V1_0_TOUCHCONTROLS_H
+#define VENDOR_MOKEE_TOUCH_V1_0_TOUCHCONTROLS_H
+
+#include <mutex>
+#include <thread>
+
+namespace vendor {
+namespace mokee {
+namespace touch {
+namespace V1_0 {
+namespace implementation {
+
+enum class TouchControl {
+    KEYPAD_ENABLE = 0,
+    COUNT,
+};
+
+/*
+ * In-memory copy of the touchscreen controls under /data/tp. Values are
+ * loaded once, kept in sync with writes from other processes through
+ * inotify and written through on set, so queries never touch the nodes.
+ */
+class TouchControls {
+  public:
+    static TouchControls& getInstance();
+
+    bool has(TouchControl control);
+    bool get(TouchControl control, int* value);
+    bool set(TouchControl control, int value);
+
+  private:
+    struct Entry {
+        const char* path;
+        bool present;
+        int value;
+        int wd;
+    };
+
+    TouchControls();
+
+    bool read(Entry& entry);
+    void watch();
+
+    std::mutex mLock;
+    Entry mEntries[static_cast<int>(TouchControl::COUNT)];
+    int mInotifyFd;
+    std::thread mWatcher;
+};
+
+}  // namespace implementation
+}  // namespace V1_0
+}  // namespace touch
+}  // namespace mokee
+}  // namespace vendor
+
+#endif  // VENDOR_MOKEE_TOUCH_V1_0_TOUCHCONTROLS_H